@@ -84,6 +84,11 @@
  * #include "sgui.h"
  * #include <stdio.h>
  *
+ * void set_window_visible( void* wnd, int visible )
+ * {
+ *     sgui_window_set_visible( wnd, visible );
+ * }
+ *
  * int main( )
  * {
  *     sgui_window* wnd;
@@ -106,9 +111,8 @@
  *     sgui_window_add_widget( wnd, text );
  *     sgui_window_add_widget( wnd, button );
  *
- *     sgui_event_connect( button, SGUI_BUTTON_OUT_EVENT,
- *                         sgui_window_set_visible, wnd,
- *                         SGUI_INT, SGUI_INVISIBLE );
+ *     sgui_event_connect_int( button, SGUI_BUTTON_OUT_EVENT,
+ *                             set_window_visible, wnd, SGUI_INVISIBLE );
  *
  *     sgui_main_loop( );
  *
@@ -144,21 +148,25 @@
 
 
 
+#include "sgui_alloc.h"
 #include "sgui_canvas.h"
 #include "sgui_context.h"
 #include "sgui_event.h"
 #include "sgui_font.h"
 #include "sgui_icon_cache.h"
 #include "sgui_keycodes.h"
+#include "sgui_loop.h"
 #include "sgui_model.h"
 #include "sgui_pixmap.h"
 #include "sgui_predef.h"
 #include "sgui_rect.h"
 #include "sgui_skin.h"
+#include "sgui_task.h"
 #include "sgui_utf8.h"
 #include "sgui_window.h"
 
 #include "sgui_widget.h"
+#include "sgui_box.h"
 #include "sgui_button.h"
 #include "sgui_color_picker.h"
 #include "sgui_edit_box.h"
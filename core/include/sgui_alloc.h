@@ -0,0 +1,238 @@
+/*
+ * sgui_alloc.h
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file sgui_alloc.h
+ *
+ * \brief Contains the allocator interface and memory statistics.
+ */
+#ifndef SGUI_ALLOC_H
+#define SGUI_ALLOC_H
+
+
+
+#include "sgui_predef.h"
+
+
+
+/**
+ * \enum SGUI_ALLOC_HINT
+ *
+ * \brief Tells an allocator what a block of memory is used for
+ */
+typedef enum
+{
+    /** \brief A small object with a fixed size, e.g. a widget */
+    SGUI_ALLOC_OBJECT = 0,
+
+    /** \brief A string, array or queue that may grow */
+    SGUI_ALLOC_BUFFER = 1,
+
+    /**
+     * \brief A large pixel buffer, e.g. of a pixmap, an image or a canvas,
+     *        that could go to huge pages or be mapped directly
+     *
+     * sgui uses the pointer returned by the allocator as is, so the
+     * alignment of the block is kept.
+     */
+    SGUI_ALLOC_PIXELS = 2
+}
+SGUI_ALLOC_HINT;
+
+/**
+ * \enum SGUI_MEMORY_CATEGORY
+ *
+ * \brief Categories that sgui_get_memory_stats reports memory usage for
+ */
+typedef enum
+{
+    /** \brief Memory that doesn't fall into any other category */
+    SGUI_MEMORY_OTHER = 0,
+
+    /** \brief Widgets, including their texts, child lists and images */
+    SGUI_MEMORY_WIDGETS,
+
+    /** \brief Pixmaps of memory canvases */
+    SGUI_MEMORY_MEM_PIXMAPS,
+
+    /** \brief Client side memory of Xlib and Xrender pixmaps */
+    SGUI_MEMORY_X11_PIXMAPS,
+
+    /**
+     * \brief Memory held by the X server for pixmaps, estimated from their
+     *        sizes and depths
+     */
+    SGUI_MEMORY_X11_SERVER,
+
+    /** \brief Pixel buffers of OpenGL texture canvases */
+    SGUI_MEMORY_GL_PIXMAPS,
+
+    /**
+     * \brief Memory held by the OpenGL implementation for the textures of
+     *        texture canvases, estimated from their sizes
+     */
+    SGUI_MEMORY_GL_TEXTURES,
+
+    /** \brief Pixel buffers of Direct3D texture canvases */
+    SGUI_MEMORY_D3D_PIXMAPS,
+
+    /**
+     * \brief Memory held by Direct3D for the textures of texture canvases,
+     *        estimated from their sizes
+     */
+    SGUI_MEMORY_D3D_TEXTURES,
+
+    /** \brief Font caches, their glyphs and glyph atlases */
+    SGUI_MEMORY_GLYPHS,
+
+    /** \brief Icon caches, their icons and pixmaps */
+    SGUI_MEMORY_ICONS,
+
+    /** \brief Models, model items and their strings */
+    SGUI_MEMORY_MODEL,
+
+    /** \brief The event queue, event listeners and the listener table */
+    SGUI_MEMORY_EVENTS,
+
+    /** \brief The clipboard buffer */
+    SGUI_MEMORY_CLIPBOARD,
+
+    SGUI_NUM_MEMORY_CATEGORIES
+}
+SGUI_MEMORY_CATEGORY;
+
+
+
+/**
+ * \struct sgui_allocator
+ *
+ * \brief A set of functions that sgui allocates all of its memory with
+ *
+ * Every function gets the user pointer of the allocator and an
+ * \ref SGUI_ALLOC_HINT value. A block is always resized and freed with the
+ * same hint it was allocated with.
+ */
+typedef struct
+{
+    /**
+     * \brief Allocate a block of memory
+     *
+     * \param user A pointer to user data
+     * \param size The number of bytes to allocate
+     * \param hint An \ref SGUI_ALLOC_HINT value
+     *
+     * \return A pointer to the block on success, NULL on failure
+     */
+    void* (* alloc )( void* user, size_t size, int hint );
+
+    /**
+     * \brief Resize a block of memory, or allocate one if ptr is NULL
+     *
+     * \param user A pointer to user data
+     * \param ptr  A pointer to the block, or NULL
+     * \param size The new size of the block in bytes
+     * \param hint An \ref SGUI_ALLOC_HINT value
+     *
+     * \return A pointer to the resized block on success, NULL on failure,
+     *         in which case the original block is left untouched
+     */
+    void* (* resize )( void* user, void* ptr, size_t size, int hint );
+
+    /**
+     * \brief Free a block of memory
+     *
+     * \param user A pointer to user data
+     * \param ptr  A pointer to the block, never NULL
+     * \param hint An \ref SGUI_ALLOC_HINT value
+     */
+    void (* release )( void* user, void* ptr, int hint );
+
+    /** \brief A user pointer passed to the functions */
+    void* user;
+}
+sgui_allocator;
+
+/**
+ * \struct sgui_memory_stats
+ *
+ * \brief Memory usage of a \ref SGUI_MEMORY_CATEGORY
+ */
+typedef struct
+{
+    /** \brief The number of bytes currently in use */
+    unsigned long bytes;
+
+    /** \brief The number of objects currently in use */
+    unsigned long objects;
+
+    /** \brief The highest number of bytes in use so far */
+    unsigned long peak_bytes;
+
+    /** \brief The highest number of objects in use so far */
+    unsigned long peak_objects;
+}
+sgui_memory_stats;
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Route all memory allocations of sgui through custom functions
+ *
+ * \note This function must be called before sgui_init or after sgui_deinit,
+ *       since memory allocated with one allocator has to be freed with the
+ *       same allocator.
+ *
+ * \param allocator A pointer to a structure holding the functions, which
+ *                  is copied, or NULL to go back to the standard library
+ *                  functions
+ */
+SGUI_DLL void sgui_set_allocator( const sgui_allocator* allocator );
+
+/**
+ * \brief Get the memory usage of sgui, broken down into categories
+ *
+ * Every block of memory allocated by sgui is accounted to exactly one
+ * category, except for the pixmaps of glyph atlases and icon caches, which
+ * are included both in their own category and in the pixmap category of
+ * the backend. Objects are e.g. widgets, pixmaps or event listeners, as
+ * opposed to strings and arrays, which only add to the number of bytes.
+ *
+ * \note Peak values are updated without locking and may be slightly off
+ *       while multiple threads allocate memory.
+ *
+ * \param stats A pointer to an array of SGUI_NUM_MEMORY_CATEGORIES
+ *              structures, indexed by \ref SGUI_MEMORY_CATEGORY
+ */
+SGUI_DLL void sgui_get_memory_stats( sgui_memory_stats* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGUI_ALLOC_H */
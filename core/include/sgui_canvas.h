@@ -42,7 +42,8 @@
 typedef enum
 {
     SGUI_CANVAS_BEGAN = 0x01,   /**< \brief Set inside a begin...end block */
-    SGUI_CANVAS_DRAW_FOCUS = 0x02   /**< \brief Set to draw the focus box */
+    SGUI_CANVAS_DRAW_FOCUS = 0x02,  /**< \brief Set to draw the focus box */
+    SGUI_CANVAS_LAYER = 0x04    /**< \brief Set while drawing into a layer */
 }
 SGUI_CANVAS_FLAGS;
 
@@ -68,10 +69,24 @@ struct sgui_canvas
 
     sgui_widget* mouse_over;  /**< \brief The widget under the mouse cursor */
     sgui_widget* focus;       /**< \brief The widget with keyboad focus */
+    sgui_widget* capture;     /**< \brief The widget receiving all mouse input */
 
     sgui_rect* dirty;       /**< \brief Array of dirty rectangles */
     unsigned int num_dirty; /**< \brief Number of dirty rectangles in array */
 
+    sgui_rect scroll_area;  /**< \brief Area with a pending pixel move */
+    int scroll_dx;          /**< \brief Pending horizontal pixel move */
+    int scroll_dy;          /**< \brief Pending vertical pixel move */
+
+    sgui_layer* layers;         /**< \brief Cached widget layers */
+    unsigned long layer_bytes;  /**< \brief Memory used by layer pixmaps */
+    unsigned long layer_limit;  /**< \brief Maximum for layer_bytes */
+    unsigned long layer_clock;  /**< \brief Counter for layer LRU eviction */
+
+    /** \brief Released pixmaps, reused by sgui_canvas_create_pixmap */
+    sgui_pixmap* pixmap_pool[ SGUI_CANVAS_PIXMAP_POOL ];
+    unsigned int num_pooled;    /**< \brief Number of pixmaps in the pool */
+
     /** \copydoc sgui_canvas_destroy */
     void(* destroy )( sgui_canvas* canvas );
 
@@ -98,6 +113,19 @@ struct sgui_canvas
     sgui_pixmap* (* create_pixmap )( sgui_canvas* canvas, unsigned int width,
                                      unsigned int height, int format );
 
+    /**
+     * \brief Gets called by sgui_canvas_adopt_pixmap
+     *
+     * Can be set to NULL if the canvas cannot draw pixmaps created by other
+     * canvases.
+     *
+     * \param canvas A pointer to the canvas
+     * \param pixmap A pixmap created by an arbitrary canvas
+     *
+     * \return Non-zero if the canvas can draw the pixmap from now on
+     */
+    int (* adopt_pixmap )( sgui_canvas* canvas, sgui_pixmap* pixmap );
+
     /**
      * \brief Gets called by sgui_canvas_begin
      *
@@ -119,6 +147,38 @@ struct sgui_canvas
      */
     void(* end )( sgui_canvas* canvas );
 
+    /**
+     * \brief Redirect drawing operations to a pixmap
+     *
+     * Can be set to NULL if not supported by the implementation, in which
+     * case cached widgets are drawn directly onto the canvas.
+     *
+     * \param canvas A pointer to the canvas.
+     * \param pixmap An RGB8 pixmap created by the canvas that all drawing
+     *               operations should go to, or NULL to draw to the canvas
+     *               again.
+     *
+     * \return Non-zero on success, zero on failure
+     */
+    int(* set_target )( sgui_canvas* canvas, sgui_pixmap* pixmap );
+
+    /**
+     * \brief Move the pixels inside an area of the canvas
+     *
+     * Can be set to NULL if not supported by the implementation, in which
+     * case scrolled areas are redrawn entirely. Gets called once before the
+     * dirty areas are redrawn, with the distance of all scroll steps since
+     * the last redraw.
+     *
+     * \param canvas A pointer to the canvas.
+     * \param r      The area to move pixels in (clamped to the canvas)
+     * \param dx     The horizontal distance to move the pixels
+     * \param dy     The vertical distance to move the pixels
+     *
+     * \return Non-zero on success, zero if the area has to be redrawn
+     */
+    int(* scroll )( sgui_canvas* canvas, const sgui_rect* r, int dx, int dy );
+
     /**
      * \brief If not NULL, gets called by sgui_canvas_add_dirty_rect
      *
@@ -286,11 +346,33 @@ SGUI_DLL void sgui_canvas_destroy( sgui_canvas* canvas );
 SGUI_DLL void sgui_canvas_set_focus( sgui_canvas* canvas,
                                      sgui_widget* widget );
 
+/**
+ * \brief Send all mouse input to a widget, regardless of the mouse position
+ *
+ * \memberof sgui_canvas
+ *
+ * While the pointer is captured, mouse events are not used to determine the
+ * widget under the mouse cursor. Widgets typically capture the pointer when
+ * a button is pressed on them and release it when the button is released,
+ * e.g. to drag something.
+ *
+ * \param canvas A pointer to a canvas object
+ * \param widget A pointer to a widget that should receive all mouse events,
+ *               or NULL to release the pointer
+ */
+SGUI_DLL void sgui_canvas_capture_pointer( sgui_canvas* canvas,
+                                           sgui_widget* widget );
+
 /**
  * \brief Add a dirty rect (area that needs redraw) to a canvas
  *
  * \memberof sgui_canvas
  *
+ * Since it is not known what changed in the area, the cached layers of all
+ * widgets touching it are rendered again entirely. Widgets should use
+ * sgui_widget_add_dirty_rect instead, which only renders the area again in
+ * the layers that actually contain the widget.
+ *
  * \param canvas The canvas
  * \param r      The dirty rectangle
  */
@@ -332,6 +414,43 @@ SGUI_DLL void sgui_canvas_get_dirty_rect( const sgui_canvas* canvas,
  */
 SGUI_DLL void sgui_canvas_clear_dirty_rects( sgui_canvas* canvas );
 
+/**
+ * \brief Move the pixels inside an area and mark the uncovered part dirty
+ *
+ * \memberof sgui_canvas
+ *
+ * Pixels moved outside the area are discarded. Dirty rects inside the area
+ * are moved along. If the canvas cannot move pixels, the entire area is
+ * marked dirty.
+ *
+ * The pixels are moved when the dirty areas are redrawn. Scrolling the same
+ * area several times before that moves the pixels only once.
+ *
+ * \param canvas The canvas
+ * \param r      The area to move pixels in
+ * \param dx     The horizontal distance to move the pixels
+ * \param dy     The vertical distance to move the pixels
+ */
+SGUI_DLL void sgui_canvas_scroll_area( sgui_canvas* canvas,
+                                       const sgui_rect* r, int dx, int dy );
+
+/**
+ * \brief Set the maximum amount of memory used for cached widget layers
+ *
+ * \memberof sgui_canvas
+ *
+ * Released pixmaps that the canvas keeps for reuse count against the limit
+ * as well. If creating a layer would exceed the limit, the released pixmaps
+ * and then the layers that have not been drawn for the longest time are
+ * discarded first. If that is not enough, the widget is drawn without a
+ * layer. The default is SGUI_CANVAS_LAYER_LIMIT.
+ *
+ * \param canvas The canvas
+ * \param limit  The number of bytes that layer pixmaps may use
+ */
+SGUI_DLL void sgui_canvas_set_layer_limit( sgui_canvas* canvas,
+                                           unsigned long limit );
+
 /**
  * \brief Redraw all visible widgets of a canvas that are within areas flaged
  *        as dirty.
@@ -415,7 +534,11 @@ SGUI_DLL void sgui_canvas_resize( sgui_canvas* canvas, unsigned int width,
  * This function creates a pixmap. A pixmap is a server side memory area that
  * can hold a picture wich can be displayed on a canvas.
  * A pixmap can only be createad by a canvas and is only valid for the canvas
- * it was created for.
+ * it was created for, unless it is handed to sgui_canvas_adopt_pixmap.
+ *
+ * Pixmaps of the same size and format that have been handed back to the
+ * canvas with sgui_canvas_release_pixmap are reused, their contents are
+ * undefined.
  *
  * \param canvas  The canvas for which to create the pixmap
  * \param width   The width of the pixmap in pixels
@@ -430,6 +553,40 @@ SGUI_DLL sgui_pixmap* sgui_canvas_create_pixmap( sgui_canvas* canvas,
                                                  unsigned int height,
                                                  int format );
 
+/**
+ * \brief Hand a pixmap that is no longer needed back to a canvas
+ *
+ * \memberof sgui_canvas
+ *
+ * The canvas keeps up to SGUI_CANVAS_PIXMAP_POOL released pixmaps around and
+ * returns them from sgui_canvas_create_pixmap instead of creating new ones.
+ * If the pool is full, the oldest pixmap in it is destroyed. The pool is
+ * emptied when the canvas is destroyed.
+ *
+ * \param canvas The canvas that created or adopted the pixmap
+ * \param pixmap The pixmap to release
+ */
+SGUI_DLL void sgui_canvas_release_pixmap( sgui_canvas* canvas,
+                                          sgui_pixmap* pixmap );
+
+/**
+ * \brief Try to use a pixmap created by a different canvas on a canvas
+ *
+ * \memberof sgui_canvas
+ *
+ * Canvases of the same backend can usually share their pixmaps, so a widget
+ * that is moved to a different canvas can keep its uploaded pixmap instead of
+ * creating and uploading a new one.
+ *
+ * \param canvas The canvas that should draw the pixmap
+ * \param pixmap The pixmap
+ *
+ * \return Non-zero if the pixmap can be drawn onto the canvas, zero if a new
+ *         pixmap has to be created for it
+ */
+SGUI_DLL int sgui_canvas_adopt_pixmap( sgui_canvas* canvas,
+                                       sgui_pixmap* pixmap );
+
 /**
  * \brief Get a pointer to the currently used drawing scissor rectangle
  *
@@ -89,7 +89,8 @@ typedef enum
 
     /**
      * \brief Generated by sgui_window. int argument is positive for
-     *        up and negative for down
+     *        up and negative for down, the number of steps if several
+     *        wheel events were merged.
      */
     SGUI_MOUSE_WHEEL_EVENT          = 0x0007,
 
@@ -251,6 +252,15 @@ typedef enum
      */
     SGUI_HSVA_CHANGED_EVENT         = 0x0071,
 
+    /**
+     * \brief Generated by a worker thread when a task is done
+     *
+     * The source of the event is the sgui_task. sgui listens to the event
+     * itself to call the completion callback of the task on the main loop
+     * thread, after which the task is destroyed.
+     */
+    SGUI_TASK_DONE_EVENT            = 0x0080,
+
     /** \brief Generated by sgui_dialog if it got rejected */
     SGUI_DIALOG_REJECTED            = 0x0100,
 
@@ -457,6 +467,83 @@ SGUI_ARG_TYPE;
  */
 typedef void (* sgui_function )( void* object, ... );
 
+/**
+ * \brief A callback that receives the event that triggered it
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_event
+ * \param event    The event that is being dispatched
+ */
+typedef void (* sgui_event_callback )( void* receiver,
+                                       const sgui_event* event );
+
+/**
+ * \brief A callback without arguments
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_void
+ */
+typedef void (* sgui_void_callback )( void* receiver );
+
+/**
+ * \brief A callback with an integer argument
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_int
+ * \param value    The value passed to sgui_event_connect_int
+ */
+typedef void (* sgui_int_callback )( void* receiver, int value );
+
+/**
+ * \brief A callback with a pointer argument
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_pointer
+ * \param value    The value passed to sgui_event_connect_pointer
+ */
+typedef void (* sgui_pointer_callback )( void* receiver, void* value );
+
+/**
+ * \brief A callback with two integer arguments
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_int2
+ * \param a        The first value passed to sgui_event_connect_int2
+ * \param b        The second value passed to sgui_event_connect_int2
+ */
+typedef void (* sgui_int2_callback )( void* receiver, int a, int b );
+
+/**
+ * \brief A callback with three integer arguments
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_int3
+ * \param a        The first value passed to sgui_event_connect_int3
+ * \param b        The second value passed to sgui_event_connect_int3
+ * \param c        The third value passed to sgui_event_connect_int3
+ */
+typedef void (* sgui_int3_callback )( void* receiver, int a, int b, int c );
+
+/**
+ * \brief A callback with a long integer argument
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_long
+ * \param value    The value passed to sgui_event_connect_long
+ */
+typedef void (* sgui_long_callback )( void* receiver, long value );
+
+#ifndef SGUI_NO_FLOAT
+/**
+ * \brief A callback with a float argument
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_float
+ * \param value    The value passed to sgui_event_connect_float
+ */
+typedef void (* sgui_float_callback )( void* receiver, float value );
+
+/**
+ * \brief A callback with a double argument
+ *
+ * \param receiver The receiver object passed to sgui_event_connect_double
+ * \param value    The value passed to sgui_event_connect_double
+ */
+typedef void (* sgui_double_callback )( void* receiver, double value );
+#endif
+
 
 
 #ifdef __cplusplus
@@ -477,6 +564,12 @@ extern "C" {
  * When the callback is called, the receiver object is passed as first
  * argument, followed by the supplied arguments.
  *
+ * \deprecated The callback is called through a variadic function pointer
+ *             that does not match its actual prototype, which is undefined
+ *             behaviour. Use one of the typed connect functions instead,
+ *             e.g. sgui_event_connect_event with a callback that picks the
+ *             fields it needs from the event.
+ *
  * \param sender    A pointer to the sender object, or NULL for any
  * \param eventtype The event identifyer to listen to
  * \param ...       A pointer to a callback function, followed by a pointer to
@@ -487,12 +580,155 @@ extern "C" {
  */
 SGUI_DLL void sgui_event_connect( void* sender, int eventtype, ... );
 
+/**
+ * \brief Connect an event with a callback that receives the event
+ *
+ * Unlike sgui_event_connect, the callback is called through its exact
+ * prototype, so the compiler can check it and no variadic call or argument
+ * type switch is involved when dispatching.
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_event( void* sender, int eventtype,
+                                       sgui_event_callback callback,
+                                       void* receiver );
+
+/**
+ * \brief Connect an event with a callback that takes no arguments
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_void( void* sender, int eventtype,
+                                      sgui_void_callback callback,
+                                      void* receiver );
+
+/**
+ * \brief Connect an event with a callback that takes an integer
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param value     The value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_int( void* sender, int eventtype,
+                                     sgui_int_callback callback,
+                                     void* receiver, int value );
+
+/**
+ * \brief Connect an event with a callback that takes a pointer
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param value     The value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_pointer( void* sender, int eventtype,
+                                         sgui_pointer_callback callback,
+                                         void* receiver, void* value );
+
+/**
+ * \brief Connect an event with a callback that takes two integers
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param a         The first value to pass to the callback
+ * \param b         The second value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_int2( void* sender, int eventtype,
+                                      sgui_int2_callback callback,
+                                      void* receiver, int a, int b );
+
+/**
+ * \brief Connect an event with a callback that takes three integers
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param a         The first value to pass to the callback
+ * \param b         The second value to pass to the callback
+ * \param c         The third value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_int3( void* sender, int eventtype,
+                                      sgui_int3_callback callback,
+                                      void* receiver, int a, int b, int c );
+
+/**
+ * \brief Connect an event with a callback that takes a long integer
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param value     The value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_long( void* sender, int eventtype,
+                                      sgui_long_callback callback,
+                                      void* receiver, long value );
+
+#ifndef SGUI_NO_FLOAT
+/**
+ * \brief Connect an event with a callback that takes a float
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param value     The value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_float( void* sender, int eventtype,
+                                       sgui_float_callback callback,
+                                       void* receiver, float value );
+
+/**
+ * \brief Connect an event with a callback that takes a double
+ *
+ * \param sender    A pointer to the sender object, or NULL for any
+ * \param eventtype The event identifyer to listen to
+ * \param callback  The function to call
+ * \param receiver  A pointer to the receiver object
+ * \param value     The value to pass to the callback
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_event_connect_double( void* sender, int eventtype,
+                                        sgui_double_callback callback,
+                                        void* receiver, double value );
+#endif
+
 /**
  * \brief Disconnect an event from a callback
  *
  * Given a sender, event type, receiver and callback, this function runs
  * through the internal list of event connections and disconnects all matching
- * connections.
+ * connections. Callbacks connected through one of the typed connect
+ * functions are disconnected by passing them cast to sgui_function.
  *
  * \param sender    A pointer to the sender object
  * \param eventtype The event identifyer to listen to
@@ -524,6 +760,28 @@ SGUI_DLL void sgui_event_reset( void );
 /**
  * \brief Called from sgui_main_loop and sgui_main_loop_step to process the
  *        event queue and event connections
+ *
+ * Events that only report a new state are merged with earlier events of the
+ * same type and source that are still waiting in the queue, so listeners
+ * see bursts of them only once per cycle: the latest position, size or
+ * value is kept for mouse move, size change, slider, numeric edit and color
+ * picker events, expose rectangles are joined and mouse wheel steps are
+ * added up. Other events from the same source (e.g. a button press) are
+ * never reordered with respect to a merged event.
+ *
+ * Input events (key, character, mouse button, wheel and double click
+ * events) are dispatched ahead of the events of other sources, but never
+ * ahead of earlier events of their own source. The remaining events are
+ * dispatched until SGUI_EVENT_TIME_BUDGET milliseconds have passed; what is
+ * left is kept in order for the next call, so that typing stays responsive
+ * while a large number of application events is queued.
+ *
+ * The callbacks are called without holding the global sgui mutex, so other
+ * threads can keep posting events and using widgets while a callback does
+ * slow work. Connecting and disconnecting (also from within a callback) is
+ * safe while events are being dispatched. A listener that is disconnected
+ * from an other thread while its callback is running may still receive the
+ * event that is currently being dispatched.
  */
 SGUI_DLL void sgui_event_process( void );
 
@@ -34,6 +34,8 @@
 
 
 #include "sgui_predef.h"
+#include "sgui_alloc.h"
+#include "sgui_loop.h"
 #include "sgui_rect.h"
 #include "sgui_window.h"
 #include "sgui_canvas.h"
@@ -85,6 +87,8 @@ extern "C" {
  *
  * The mutex is recursive, so for a certain number lock calls, the same number
  * of unlock calls is required to unlock the mutex.
+ *
+ * Same as sgui_internal_lock( SGUI_LOCK_GLOBAL ).
  */
 SGUI_DLL void sgui_internal_lock_mutex( void );
 
@@ -93,6 +97,352 @@ SGUI_DLL void sgui_internal_lock_mutex( void );
  */
 SGUI_DLL void sgui_internal_unlock_mutex( void );
 
+/**
+ * \brief Lock one of the internal locks. Blocks until the lock is held.
+ *
+ * All locks are recursive. A thread holding a lock may only take locks
+ * that come after it in \ref SGUI_LOCK (it may take the same lock again),
+ * so the locks are always acquired in the same order and cannot deadlock.
+ *
+ * A thread may hold the global mutex while taking any of the other locks,
+ * e.g. while drawing a widget that looks up glyphs or posts events, but
+ * never takes the global mutex while holding one of them. The other locks
+ * protect the state of a single subsystem and no callback is called while
+ * holding them. Only a few nest: the task lock is held while posting the
+ * completion event, which takes the event lock if the ring buffer is full,
+ * and the icon cache lock while allocating an icon from its pool. The pool
+ * lock comes last, since objects are allocated while holding any of them.
+ *
+ * \param lock A \ref SGUI_LOCK value
+ */
+SGUI_DLL void sgui_internal_lock( int lock );
+
+/**
+ * \brief Unlock one of the internal locks
+ *
+ * \param lock A \ref SGUI_LOCK value
+ */
+SGUI_DLL void sgui_internal_unlock( int lock );
+
+/**
+ * \brief Atomically replace a value if it has an expected value
+ *
+ * \param ptr      A pointer to the value
+ * \param expected The value that the target has to have
+ * \param value    The new value to store
+ *
+ * \return Non-zero if the value was replaced, zero if it was not equal
+ *         to the expected value
+ */
+SGUI_DLL int sgui_internal_atomic_cas( volatile unsigned int* ptr,
+                                       unsigned int expected,
+                                       unsigned int value );
+
+/**
+ * \brief Atomically add a value to a variable
+ *
+ * \return The new value of the variable
+ */
+SGUI_DLL long sgui_internal_atomic_add( volatile long* ptr, long value );
+
+/**
+ * \brief A full memory barrier for the compiler and the processor
+ */
+SGUI_DLL void sgui_internal_memory_barrier( void );
+
+/**
+ * \brief Make the main loop wake up if it is waiting for system events
+ *
+ * Can be called from any thread, e.g. after posting an event.
+ */
+SGUI_DLL void sgui_internal_wake_main_loop( void );
+
+/**
+ * \brief Get the time in milliseconds from a monotonic clock
+ *
+ * The value wraps around, so only differences between two values are
+ * meaningful.
+ */
+SGUI_DLL unsigned long sgui_internal_get_time_ms( void );
+
+/**
+ * \brief Get the number of milliseconds until the next timer expires
+ *
+ * \return The number of milliseconds (zero if a timer already expired),
+ *         or a negative value if there are no timers
+ */
+SGUI_DLL long sgui_internal_timer_timeout( void );
+
+/**
+ * \brief Called by the main loop to run the callbacks of expired timers
+ */
+SGUI_DLL void sgui_internal_timer_run( void );
+
+/**
+ * \brief Called by sgui_deinit to destroy all timers
+ */
+SGUI_DLL void sgui_internal_timer_reset( void );
+
+/**
+ * \brief Request that the main loop starts a frame, e.g. to redraw
+ *
+ * Can be called from any thread.
+ */
+SGUI_DLL void sgui_internal_frame_request( void );
+
+/**
+ * \brief Get the number of milliseconds until the next frame starts
+ *
+ * \return The number of milliseconds (zero if the frame is due), or a
+ *         negative value if no frame was requested
+ */
+SGUI_DLL long sgui_internal_frame_timeout( void );
+
+/**
+ * \brief Called by the main loop to start a frame if one is due
+ *
+ * Calls the callbacks requested with sgui_request_frame.
+ *
+ * \return Non-zero if the frame was started and the main loop should
+ *         redraw damaged windows, zero if not
+ */
+SGUI_DLL int sgui_internal_frame_run( void );
+
+/**
+ * \brief Called by sgui_deinit to reset the frame clock
+ */
+SGUI_DLL void sgui_internal_frame_reset( void );
+
+/**
+ * \brief Check if the main loop has idle tasks to run
+ */
+SGUI_DLL int sgui_internal_idle_pending( void );
+
+/**
+ * \brief Called by the main loop to run idle tasks until they have to yield
+ */
+SGUI_DLL void sgui_internal_idle_run( void );
+
+/**
+ * \brief Called by sgui_deinit to destroy all idle tasks
+ */
+SGUI_DLL void sgui_internal_idle_reset( void );
+
+/**
+ * \brief Check if the window system has input or paint messages waiting
+ *        that the main loop has not fetched yet
+ */
+SGUI_DLL int sgui_internal_input_pending( void );
+
+/**
+ * \brief Start a thread
+ *
+ * \param function The function to run in the new thread
+ * \param arg      An argument to pass to the function
+ *
+ * \return A handle for the thread on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_thread_create( void(* function )( void* ),
+                                            void* arg );
+
+/**
+ * \brief Wait for a thread to terminate and free its handle
+ */
+SGUI_DLL void sgui_internal_thread_join( void* thread );
+
+/**
+ * \brief Create a counting semaphore with an initial count of zero
+ *
+ * \return A handle for the semaphore on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_semaphore_create( void );
+
+/**
+ * \brief Destroy a semaphore created with sgui_internal_semaphore_create
+ */
+SGUI_DLL void sgui_internal_semaphore_destroy( void* sem );
+
+/**
+ * \brief Increment the count of a semaphore
+ */
+SGUI_DLL void sgui_internal_semaphore_post( void* sem );
+
+/**
+ * \brief Wait until the count of a semaphore is non-zero and decrement it
+ */
+SGUI_DLL void sgui_internal_semaphore_wait( void* sem );
+
+/**
+ * \brief Combine a \ref SGUI_MEMORY_CATEGORY and an \ref SGUI_ALLOC_HINT,
+ *        e.g. SGUI_MEM(WIDGETS,OBJECT), to pass as hint to the allocation
+ *        functions below
+ *
+ * Memory allocated with a plain \ref SGUI_ALLOC_HINT is accounted to
+ * \ref SGUI_MEMORY_OTHER.
+ */
+#define SGUI_MEM( category, hint ) \
+        ((SGUI_MEMORY_##category << 4) | SGUI_ALLOC_##hint)
+
+/**
+ * \brief Allocate memory with the allocator set by sgui_set_allocator
+ *
+ * All memory allocated by sgui goes through this function or the other
+ * allocation functions below, which account it to a memory category.
+ *
+ * \param size The number of bytes to allocate
+ * \param hint An \ref SGUI_ALLOC_HINT value, optionally combined with a
+ *             memory category using SGUI_MEM
+ *
+ * \return A pointer to the memory on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_malloc( size_t size, int hint );
+
+/**
+ * \brief Allocate zero initialized memory for an array
+ *
+ * \param count The number of array elements
+ * \param size  The size of an array element
+ * \param hint  An \ref SGUI_ALLOC_HINT value
+ *
+ * \return A pointer to the memory on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_calloc( size_t count, size_t size, int hint );
+
+/**
+ * \brief Resize memory allocated with the same hint, like realloc
+ *
+ * \param ptr  A pointer to the memory, or NULL to allocate new memory
+ * \param size The new size in bytes
+ * \param hint The \ref SGUI_ALLOC_HINT the memory was allocated with
+ *
+ * \return A pointer to the memory on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_realloc( void* ptr, size_t size, int hint );
+
+/**
+ * \brief Free memory allocated with one of the functions above
+ *
+ * \param ptr  A pointer to the memory, or NULL
+ * \param hint The \ref SGUI_ALLOC_HINT the memory was allocated with
+ */
+SGUI_DLL void sgui_internal_free( void* ptr, int hint );
+
+/**
+ * \brief Duplicate a string into memory allocated with the
+ *        \ref SGUI_ALLOC_BUFFER hint
+ *
+ * \param str      The string to copy
+ * \param category The \ref SGUI_MEMORY_CATEGORY to account the copy to
+ */
+SGUI_DLL char* sgui_internal_strdup( const char* str, int category );
+
+/**
+ * \brief Account memory that is not allocated through the functions above
+ *        to a memory category, e.g. estimated X server memory
+ *
+ * \param category A \ref SGUI_MEMORY_CATEGORY value
+ * \param bytes    The number of bytes to add, negative to subtract
+ * \param objects  The number of objects to add, negative to subtract
+ */
+SGUI_DLL void sgui_internal_memory_account( int category, long bytes,
+                                            long objects );
+
+/**
+ * \enum SGUI_POOL
+ *
+ * \brief Pools for small fixed size objects that are created and destroyed
+ *        often, e.g. every time a dialog is opened
+ *
+ * Objects are carved out of slabs of SGUI_POOL_SLAB_SIZE bytes, which are
+ * kept until sgui_deinit, so creating and destroying objects at a high rate
+ * doesn't go through the heap for every object. Widgets and model items
+ * are not pooled, since their size depends on the implementation. They
+ * come from the allocator set with sgui_set_allocator instead.
+ */
+typedef enum
+{
+    /** \brief Event listeners created by the connect functions */
+    SGUI_POOL_LISTENER = 0,
+
+    /** \brief Glyphs of font caches */
+    SGUI_POOL_GLYPH,
+
+    /** \brief Icons of icon maps */
+    SGUI_POOL_ICON,
+
+    /** \brief Dirty rectangle arrays of canvases */
+    SGUI_POOL_DIRTY,
+
+    /** \brief Timers */
+    SGUI_POOL_TIMER,
+
+    /** \brief Tasks submitted to the task pool */
+    SGUI_POOL_TASK,
+
+    SGUI_NUM_POOLS
+}
+SGUI_POOL;
+
+/**
+ * \brief Allocate a zero initialized object from a pool
+ *
+ * \param pool An \ref SGUI_POOL value
+ * \param size The size of the object, which must be the same for every
+ *             allocation from the pool
+ *
+ * \return A pointer to the object on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_pool_alloc( int pool, unsigned int size );
+
+/**
+ * \brief Return an object to the pool it was allocated from
+ *
+ * \param pool An \ref SGUI_POOL value
+ * \param obj  A pointer to the object, or NULL
+ */
+SGUI_DLL void sgui_internal_pool_free( int pool, void* obj );
+
+/**
+ * \brief Allocate temporary memory from the scratch arena
+ *
+ * The scratch arena is meant for short lived buffers that are freed again
+ * before the caller returns, e.g. the listener snapshot taken while an
+ * event is sent. Allocating is a pointer increment. The memory is recycled
+ * as a whole once every scratch allocation has been freed.
+ *
+ * \param size The number of bytes to allocate
+ *
+ * \return A pointer to the memory on success, NULL on failure
+ */
+SGUI_DLL void* sgui_internal_scratch_alloc( unsigned long size );
+
+/**
+ * \brief Free memory allocated with sgui_internal_scratch_alloc
+ *
+ * \param ptr A pointer to the memory, or NULL
+ */
+SGUI_DLL void sgui_internal_scratch_free( void* ptr );
+
+/**
+ * \brief Called by sgui_deinit to free the slabs of pools that have no
+ *        objects in use and the scratch arena
+ */
+SGUI_DLL void sgui_internal_pool_reset( void );
+
+/**
+ * \brief Called by sgui_init after resetting the event system, to connect
+ *        the completion event of tasks
+ *
+ * \return Non-zero on success, zero on failure
+ */
+SGUI_DLL int sgui_internal_task_init( void );
+
+/**
+ * \brief Called by sgui_deinit to stop the worker threads and destroy all
+ *        remaining tasks without calling their completion callbacks
+ */
+SGUI_DLL void sgui_internal_task_deinit( void );
+
 /**
  * \brief Perform common operations at the end of sgui_window_create
  *
@@ -124,6 +474,150 @@ SGUI_DLL void sgui_internal_window_post_init( sgui_window* window,
 SGUI_DLL void sgui_internal_window_fire_event( sgui_window* wnd,
                                                const sgui_event* e );
 
+/**
+ * \brief Check if a widget paints every pixel of an area
+ *
+ * \memberof sgui_widget
+ * \protected
+ *
+ * \param w A pointer to a widget
+ * \param r An area in canvas coordinates
+ *
+ * \return Non-zero if the widget or one of its descendants is visible,
+ *         flagged as SGUI_WIDGET_OPAQUE and covers the entire area
+ */
+SGUI_DLL int sgui_internal_widget_covers( const sgui_widget* w,
+                                          const sgui_rect* r );
+
+/**
+ * \brief Draw a cached widget and its children from its layer
+ *
+ * \memberof sgui_widget
+ * \protected
+ *
+ * If the layer of the widget is out of date, the widget is first rendered
+ * into it. Used by sgui_widget_draw for widgets with the SGUI_WIDGET_CACHED
+ * flag set.
+ *
+ * \param w     A pointer to a widget
+ * \param focus The widget that has keyboard focus, or NULL
+ *
+ * \return Non-zero on success, zero if the widget has to be drawn directly
+ */
+SGUI_DLL int sgui_internal_layer_draw( sgui_widget* w, sgui_widget* focus );
+
+/**
+ * \brief Add a dirty rect to a canvas without touching its cached layers
+ *
+ * \memberof sgui_canvas
+ * \protected
+ *
+ * Used where the layer contents are known to be up to date, e.g. for
+ * exposed areas, or are damaged separately, as by
+ * sgui_widget_add_dirty_rect.
+ *
+ * \param cv A pointer to a canvas
+ * \param r  The dirty area in canvas coordinates
+ */
+SGUI_DLL void sgui_internal_canvas_add_dirty_rect( sgui_canvas* cv,
+                                                   const sgui_rect* r );
+
+/**
+ * \brief Mark all layers of a canvas touching an area as out of date
+ *
+ * \memberof sgui_canvas
+ * \protected
+ *
+ * Used if it is not known which widget changed, e.g. for dirty rects added
+ * through sgui_canvas_add_dirty_rect, or the area that a widget occupied
+ * before a transaction moved it elsewhere.
+ *
+ * \param cv A pointer to a canvas
+ * \param r  The dirty area in canvas coordinates
+ */
+SGUI_DLL void sgui_internal_layer_invalidate( sgui_canvas* cv,
+                                              const sgui_rect* r );
+
+/**
+ * \brief Mark an area as out of date in the layers of a widget and of its
+ *        parents, after something inside the widget changed
+ *
+ * \memberof sgui_widget
+ * \protected
+ *
+ * Only the damaged part of the layers is rendered again.
+ *
+ * \param w A pointer to the widget that changed
+ * \param r The damaged area in canvas coordinates
+ */
+SGUI_DLL void sgui_internal_layer_damage( sgui_widget* w,
+                                          const sgui_rect* r );
+
+/**
+ * \brief Release the layers of a widget and its children
+ *
+ * \memberof sgui_widget
+ * \protected
+ *
+ * Called before a widget is detached from its canvas.
+ */
+SGUI_DLL void sgui_internal_layer_release( sgui_widget* w );
+
+/**
+ * \brief Free all remaining layers of a canvas
+ *
+ * \memberof sgui_canvas
+ * \protected
+ */
+SGUI_DLL void sgui_internal_layer_destroy_all( sgui_canvas* cv );
+
+/**
+ * \brief Create an empty spatial index for widgets
+ *
+ * \param cell_size The edge length of a grid cell in pixels
+ */
+SGUI_DLL sgui_grid* sgui_internal_grid_create( unsigned int cell_size );
+
+/**
+ * \brief Destroy a spatial index
+ */
+SGUI_DLL void sgui_internal_grid_destroy( sgui_grid* grid );
+
+/**
+ * \brief Add a widget to a spatial index, using its current area
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_internal_grid_insert( sgui_grid* grid, sgui_widget* w );
+
+/**
+ * \brief Remove a widget from a spatial index
+ */
+SGUI_DLL void sgui_internal_grid_remove( sgui_grid* grid, sgui_widget* w );
+
+/**
+ * \brief Find the topmost visible widget in a spatial index at a point
+ *
+ * \param grid A pointer to a spatial index
+ * \param x    The horizontal component of the point, parent relative
+ * \param y    The vertical component of the point, parent relative
+ * \param sx   The horizontal content offset of the parent
+ * \param sy   The vertical content offset of the parent
+ */
+SGUI_DLL sgui_widget* sgui_internal_grid_find( sgui_grid* grid, int x, int y,
+                                               int sx, int sy );
+
+/**
+ * \brief Update the position of a widget in the spatial index of its parent
+ *
+ * \memberof sgui_widget
+ * \protected
+ *
+ * Has to be called by widget implementations after changing the area of a
+ * widget directly.
+ */
+SGUI_DLL void sgui_internal_widget_update_index( sgui_widget* w );
+
 /**
  * \brief Initialise the sgui_default_skin structue with the default skin
  */
@@ -164,6 +658,14 @@ SGUI_DLL unsigned char* sgui_internal_mem_pixmap_buffer( sgui_pixmap* pix );
  */
 SGUI_DLL int sgui_internal_mem_pixmap_format( sgui_pixmap* pix );
 
+/**
+ * \brief Check if a pixmap is a memory pixmap with a given channel order
+ *
+ * \memberof sgui_mem_pixmap
+ */
+SGUI_DLL int sgui_internal_mem_pixmap_compatible( sgui_pixmap* pix,
+                                                  int swaprb );
+
 #ifdef __cplusplus
 }
 #endif
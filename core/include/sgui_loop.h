@@ -0,0 +1,331 @@
+/*
+ * sgui_loop.h
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file sgui_loop.h
+ *
+ * \brief Contains timers, file descriptor watchers, idle tasks and the frame
+ *        clock of the main loop, and statistics about its locks.
+ */
+#ifndef SGUI_LOOP_H
+#define SGUI_LOOP_H
+
+
+
+#include "sgui_predef.h"
+
+
+
+/**
+ * \enum SGUI_FD_EVENT
+ *
+ * \brief Conditions a file descriptor watcher can wait for
+ */
+typedef enum
+{
+    /** \brief Data is available for reading */
+    SGUI_FD_READ  = 0x01,
+
+    /** \brief Data can be written without blocking */
+    SGUI_FD_WRITE = 0x02,
+
+    /** \brief An error occoured or the other end hung up */
+    SGUI_FD_ERROR = 0x04
+}
+SGUI_FD_EVENT;
+
+/**
+ * \enum SGUI_LOCK
+ *
+ * \brief The locks that sgui uses internally to protect its state
+ *
+ * \see sgui_get_lock_contention
+ */
+typedef enum
+{
+    /** \brief Widget trees, canvases, windows and the window system */
+    SGUI_LOCK_GLOBAL = 0,
+
+    /** \brief Queue of the task pool */
+    SGUI_LOCK_TASK,
+
+    /** \brief Timer heap of the main loop */
+    SGUI_LOCK_TIMER,
+
+    /** \brief Idle tasks of the main loop */
+    SGUI_LOCK_IDLE,
+
+    /** \brief Frame clock requests */
+    SGUI_LOCK_FRAME,
+
+    /** \brief Search trees and allocation state of icon and font caches */
+    SGUI_LOCK_ICON_CACHE,
+
+    /** \brief Event listeners and the overflow event queue */
+    SGUI_LOCK_EVENT,
+
+    /** \brief Object pools, the scratch arena and pixel buffer tracking */
+    SGUI_LOCK_POOL,
+
+    SGUI_NUM_LOCKS
+}
+SGUI_LOCK;
+
+
+
+/**
+ * \brief Callback that is called when a timer expires
+ *
+ * \param timer A pointer to the timer that expired
+ * \param user  The user pointer passed to sgui_timer_create
+ */
+typedef void (* sgui_timer_callback )( sgui_timer* timer, void* user );
+
+/**
+ * \brief Callback that is called when a watched file descriptor is ready
+ *
+ * \param fd     The file descriptor
+ * \param events A combination of \ref SGUI_FD_EVENT flags that occoured
+ * \param user   The user pointer passed to sgui_watch_fd
+ */
+typedef void (* sgui_fd_callback )( int fd, int events, void* user );
+
+/**
+ * \brief Callback that is called at the start of a frame
+ *
+ * \param time The frame time stamp in milliseconds from a monotonic clock.
+ *             All callbacks of the same frame get the same time stamp.
+ * \param user The user pointer passed to sgui_request_frame
+ */
+typedef void (* sgui_frame_callback )( unsigned long time, void* user );
+
+/**
+ * \brief Callback that does a slice of the work of an idle task
+ *
+ * The callback should do work until sgui_idle_should_yield returns
+ * non-zero and then return, so the main loop can handle input and redraw
+ * windows before calling it again.
+ *
+ * \param idle A pointer to the idle task
+ * \param user The user pointer passed to sgui_idle_create
+ *
+ * \return Non-zero if there is work left to do, zero if the task is done
+ *         and should be destroyed
+ */
+typedef int (* sgui_idle_callback )( sgui_idle* idle, void* user );
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Create a timer that is run by the main loop
+ *
+ * The timer expires after the given number of milliseconds, measured with a
+ * monotonic clock, and the main loop calls the callback without holding the
+ * global sgui mutex. The main loop sleeps exactly until the next timer
+ * expires, so there is no polling involved.
+ *
+ * A one-shot timer stays around after it expired and has to be destroyed
+ * with sgui_timer_destroy (e.g. from within its own callback).
+ *
+ * \note This function may be called from any thread.
+ *
+ * \param ms       The number of milliseconds until the timer expires
+ * \param periodic If non-zero, the timer is rearmed with the same interval
+ *                 every time it expires, if zero the timer expires only once
+ * \param callback The function to call when the timer expires
+ * \param user     A user pointer to pass to the callback
+ *
+ * \return A pointer to a new timer on success, NULL on failure
+ */
+SGUI_DLL sgui_timer* sgui_timer_create( unsigned long ms, int periodic,
+                                        sgui_timer_callback callback,
+                                        void* user );
+
+/**
+ * \brief Stop and destroy a timer
+ *
+ * The timer may be destroyed from within its own callback.
+ *
+ * \param timer A pointer to a timer
+ */
+SGUI_DLL void sgui_timer_destroy( sgui_timer* timer );
+
+/**
+ * \brief Let the main loop watch an application file descriptor
+ *
+ * When the file descriptor becomes ready, the main loop calls the callback
+ * without holding the global sgui mutex, so sockets or pipes can be handled
+ * by the GUI thread without a dedicated thread feeding them in. Watching a
+ * file descriptor again replaces the previous watcher.
+ *
+ * \note Only supported by the X11 backend, which uses epoll.
+ *
+ * \param fd       The file descriptor to watch
+ * \param events   A combination of \ref SGUI_FD_READ and \ref SGUI_FD_WRITE
+ * \param callback The function to call when the file descriptor is ready
+ * \param user     A user pointer to pass to the callback
+ *
+ * \return Non-zero on success, zero on failure or if not supported
+ */
+SGUI_DLL int sgui_watch_fd( int fd, int events, sgui_fd_callback callback,
+                            void* user );
+
+/**
+ * \brief Stop watching a file descriptor
+ *
+ * This must be called before the file descriptor is closed.
+ *
+ * \param fd The file descriptor
+ */
+SGUI_DLL void sgui_unwatch_fd( int fd );
+
+/**
+ * \brief Get a file descriptor for embedding sgui into a foreign event loop
+ *
+ * The returned file descriptor becomes readable when there are window system
+ * messages, posted events, watched file descriptors that are ready or
+ * expired timers. An application with its own event loop can wait for it
+ * and call sgui_main_loop_step when it is readable.
+ *
+ * \return The main loop file descriptor, or -1 if not supported
+ */
+SGUI_DLL int sgui_get_loop_fd( void );
+
+/**
+ * \brief Set the rate at which the main loop redraws windows
+ *
+ * Damaged areas of windows are collected and redrawn at most once per
+ * frame, so widgets that are updated at a high rate (e.g. a progress bar
+ * updated from a worker thread) are only redrawn once per frame. The
+ * default is SGUI_FRAME_RATE frames per second.
+ *
+ * \param fps The number of frames per second, zero to redraw as soon as the
+ *            main loop gets to it
+ */
+SGUI_DLL void sgui_set_frame_rate( unsigned int fps );
+
+/**
+ * \brief Request a callback at the start of the next frame
+ *
+ * The callback is called once, right before damaged windows are redrawn,
+ * without holding the global sgui mutex. An animation can request the next
+ * frame from within the callback and use the time stamp to compute its
+ * state, so it runs at the frame rate of the main loop.
+ *
+ * \note This function may be called from any thread.
+ *
+ * \param callback The function to call
+ * \param user     A user pointer to pass to the callback
+ *
+ * \return Non-zero on success, zero on failure
+ */
+SGUI_DLL int sgui_request_frame( sgui_frame_callback callback, void* user );
+
+/**
+ * \brief Cancel a callback requested with sgui_request_frame
+ *
+ * \param callback The function passed to sgui_request_frame
+ * \param user     The user pointer passed to sgui_request_frame
+ */
+SGUI_DLL void sgui_cancel_frame( sgui_frame_callback callback, void* user );
+
+/**
+ * \brief Create an idle task that the main loop runs in small slices
+ *
+ * Long jobs in the GUI thread (e.g. loading a huge model into a view) can
+ * be spread across main loop iterations without blocking input and without
+ * a worker thread. The main loop calls the callback repeatedly, without
+ * holding the global sgui mutex, whenever there is no input, event or frame
+ * pending, with a time budget of SGUI_IDLE_TIME_BUDGET milliseconds per
+ * main loop iteration. Multiple idle tasks are run round robin.
+ *
+ * The task is destroyed when the callback returns zero.
+ *
+ * \note This function may be called from any thread.
+ *
+ * \param callback The function to call
+ * \param user     A user pointer to pass to the callback
+ *
+ * \return A pointer to a new idle task on success, NULL on failure
+ */
+SGUI_DLL sgui_idle* sgui_idle_create( sgui_idle_callback callback,
+                                      void* user );
+
+/**
+ * \brief Destroy an idle task before it is done
+ *
+ * The idle task may be destroyed from within its own callback.
+ *
+ * \param idle A pointer to an idle task
+ */
+SGUI_DLL void sgui_idle_destroy( sgui_idle* idle );
+
+/**
+ * \brief Check if an idle task was destroyed from within its own callback
+ *
+ * A callback can use this to find out whether the object its user pointer
+ * refers to is still alive, e.g. if the task was destroyed together with
+ * that object while the callback waited for a lock.
+ *
+ * \param idle A pointer to the idle task passed to the callback
+ *
+ * \return Non-zero if the task was destroyed, zero if not
+ */
+SGUI_DLL int sgui_idle_is_destroyed( sgui_idle* idle );
+
+/**
+ * \brief Check if an idle task callback should return to the main loop
+ *
+ * \return Non-zero if the time budget of the main loop iteration is used
+ *         up, or input, events or a frame are pending. Always non-zero if
+ *         not called from within an idle task callback.
+ */
+SGUI_DLL int sgui_idle_should_yield( void );
+
+/**
+ * \brief Get the number of times threads had to wait for the locks of sgui
+ *
+ * A counter is incremented every time a thread tries to take a lock that
+ * is held by another thread, which is useful for finding out which lock
+ * is a bottleneck in a multithreaded program.
+ *
+ * \note The counters are read without locking and may be slightly off
+ *       while other threads keep taking locks.
+ *
+ * \param counts A pointer to an array of SGUI_NUM_LOCKS values, indexed
+ *               by \ref SGUI_LOCK
+ */
+SGUI_DLL void sgui_get_lock_contention( unsigned long* counts );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGUI_LOOP_H */
+
@@ -116,6 +116,18 @@ struct sgui_model
      */
     sgui_icon* (* item_icon )( const sgui_model* model, const sgui_item* item,
                                unsigned int column );
+
+    /**
+     * \copydoc sgui_model_fetch_items
+     *
+     * Can be NULL if not implemented, in which case the items are collected
+     * by walking the list returned by query_items. Only called if count is
+     * not zero.
+     */
+    unsigned int (* fetch_items )( const sgui_model* model,
+                                   const sgui_item* parent,
+                                   unsigned int start, unsigned int count,
+                                   const sgui_item** items );
 };
 
 
@@ -150,6 +162,10 @@ typedef int (* sgui_item_compare_fun )( const sgui_model* model,
  * \implements sgui_model
  *
  * \brief A simple, in-memory implementation of an sgui_model
+ *
+ * The children of each item are kept in an array, so querying, fetching and
+ * counting them takes constant time regardless of the position in the list.
+ * New items are added to the front of the list of their parent.
  */
 
 
@@ -226,6 +242,31 @@ const sgui_item* sgui_model_query_items( const sgui_model* model,
     return model->query_items( model, parent, start, count );
 }
 
+/**
+ * \brief Get pointers to a range of items from an sgui_model
+ *
+ * \memberof sgui_model
+ *
+ * Unlike sgui_model_query_items, this gives random access to the items of a
+ * list without following the next pointers, e.g. to page through a large
+ * model. For models that implement sgui_model_free_item_list, the items
+ * have to be freed by passing the first one to it.
+ *
+ * \param model  A pointer to a model object
+ * \param parent The parent item, or NULL for the topmost in the hirarchy
+ * \param start  An offset into the list of children
+ * \param count  The maximum number of items to retrieve
+ * \param items  An array of at least count pointers that receives the items
+ *
+ * \return The number of items stored in the array, less than count if the
+ *         end of the list was reached
+ */
+SGUI_DLL unsigned int sgui_model_fetch_items( const sgui_model* model,
+                                              const sgui_item* parent,
+                                              unsigned int start,
+                                              unsigned int count,
+                                              const sgui_item** items );
+
 /**
  * \brief Free a list of items obtained from sgui_model_query_items
  *
@@ -46,6 +46,7 @@
 struct sgui_pixmap
 {
     unsigned int width, height;     /**< \brief Size of the pixmap */
+    int format;                     /**< \brief Color format of the pixmap */
 
     /** \copydoc sgui_pixmap_destroy */
     void(* destroy )( sgui_pixmap* pixmap );
@@ -66,6 +66,8 @@ typedef struct sgui_canvas sgui_canvas;
 typedef struct sgui_widget sgui_widget;
 typedef struct sgui_window sgui_window;
 typedef struct sgui_pixmap sgui_pixmap;
+typedef struct sgui_layer sgui_layer;
+typedef struct sgui_grid sgui_grid;
 typedef struct sgui_skin sgui_skin;
 typedef struct sgui_context sgui_context;
 typedef struct sgui_event sgui_event;
@@ -73,6 +75,9 @@ typedef struct sgui_window_description sgui_window_description;
 typedef struct sgui_model sgui_model;
 typedef struct sgui_item sgui_item;
 typedef struct sgui_dialog sgui_dialog;
+typedef struct sgui_timer sgui_timer;
+typedef struct sgui_idle sgui_idle;
+typedef struct sgui_task sgui_task;
 
 typedef void(* sgui_funptr )( );
 
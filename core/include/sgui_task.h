@@ -0,0 +1,143 @@
+/*
+ * sgui_task.h
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file sgui_task.h
+ *
+ * \brief Contains the worker thread task interface.
+ */
+#ifndef SGUI_TASK_H
+#define SGUI_TASK_H
+
+
+
+#include "sgui_predef.h"
+
+
+
+/**
+ * \enum SGUI_TASK_STATUS
+ *
+ * \brief Passed to the completion callback of a task
+ */
+typedef enum
+{
+    /** \brief The work function of the task ran to completion */
+    SGUI_TASK_DONE = 0,
+
+    /**
+     * \brief The task was canceled, either before the work function
+     *        started or while it was running
+     */
+    SGUI_TASK_CANCELED = 1
+}
+SGUI_TASK_STATUS;
+
+
+
+/**
+ * \brief Function that does the work of a task in a worker thread
+ *
+ * A long running function can poll sgui_task_is_canceled to stop early.
+ *
+ * \param task A pointer to the task
+ * \param data The data pointer passed to sgui_task_submit
+ */
+typedef void (* sgui_task_function )( sgui_task* task, void* data );
+
+/**
+ * \brief Completion callback of a task, called on the main loop thread
+ *
+ * \param task   A pointer to the task. It is destroyed after the callback
+ *               returns.
+ * \param status An \ref SGUI_TASK_STATUS value
+ * \param data   The data pointer passed to sgui_task_submit
+ */
+typedef void (* sgui_task_callback )( sgui_task* task, int status,
+                                      void* data );
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Run a function in a worker thread
+ *
+ * The task is queued for a fixed pool of SGUI_TASK_THREADS worker threads
+ * that is started on first use. When the work function returns, or the
+ * task got canceled, a \ref SGUI_TASK_DONE_EVENT is posted to the event
+ * queue and the completion callback is called from the main loop, i.e. on
+ * the same thread as all other event callbacks, where it can safely hand
+ * the result to widgets.
+ *
+ * The work function runs concurrently with the main loop and must not
+ * access data that the main loop thread uses without synchronisation.
+ *
+ * \note This function may be called from any thread.
+ *
+ * \param work The function to run in a worker thread
+ * \param done If not NULL, called on the main loop thread when the task
+ *             is done or canceled
+ * \param data A data pointer to pass to both functions
+ *
+ * \return A pointer to the task on success, NULL on failure. The pointer
+ *         stays valid until the completion callback returned.
+ */
+SGUI_DLL sgui_task* sgui_task_submit( sgui_task_function work,
+                                      sgui_task_callback done, void* data );
+
+/**
+ * \brief Cancel a task
+ *
+ * If the task is still waiting for a worker thread, it is removed from the
+ * queue and its work function is never called. If it is already running,
+ * sgui_task_is_canceled returns non-zero from now on, so the work function
+ * can stop early. Either way, the completion callback receives
+ * \ref SGUI_TASK_CANCELED.
+ *
+ * \param task A pointer to a task whose completion callback was not
+ *             called yet
+ *
+ * \return Non-zero if the work function never got to run, zero otherwise
+ */
+SGUI_DLL int sgui_task_cancel( sgui_task* task );
+
+/**
+ * \brief Check if a task got canceled, e.g. from its work function
+ *
+ * \param task A pointer to a task
+ *
+ * \return Non-zero if sgui_task_cancel was called on the task
+ */
+SGUI_DLL int sgui_task_is_canceled( sgui_task* task );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGUI_TASK_H */
+
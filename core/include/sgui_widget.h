@@ -50,7 +50,8 @@ typedef enum
     SGUI_WIDGET_PARENT_CHANGED       = 0x04,
     SGUI_WIDGET_CHILD_ADDED          = 0x08,
     SGUI_WIDGET_CHILD_REMOVED        = 0x10,
-    SGUI_WIDGET_CANVAS_CHANGED       = 0x20
+    SGUI_WIDGET_CANVAS_CHANGED       = 0x20,
+    SGUI_WIDGET_SIZE_CHANGED         = 0x40
 }
 SGUI_WIDGET_STATE_CHANGE_FLAG;
 
@@ -65,7 +66,38 @@ typedef enum
     SGUI_FOCUS_DRAW     = 0x02,    /**< \brief draw focus box */
     SGUI_FOCUS_DROP_ESC = 0x04,    /**< \brief drop focus on ESC-key */
     SGUI_FOCUS_DROP_TAB = 0x08,    /**< \brief drop focus on TAB-key */
-    SGUI_WIDGET_VISIBLE = 0x10     /**< \brief widget is visible */
+    SGUI_WIDGET_VISIBLE = 0x10,    /**< \brief widget is visible */
+
+    /**
+     * \brief The draw callback paints every pixel of the widget area
+     *
+     * Widgets below an opaque widget and the canvas background are not
+     * drawn where the opaque widget covers them.
+     */
+    SGUI_WIDGET_OPAQUE  = 0x20,
+
+    /**
+     * \brief Keep a rendered image of the widget and its children
+     *
+     * \see sgui_widget_set_cached
+     */
+    SGUI_WIDGET_CACHED  = 0x40,
+
+    /**
+     * \brief The widget is not moved by the content offset of its parent
+     *
+     * \see sgui_widget_set_content_offset
+     */
+    SGUI_WIDGET_FIXED   = 0x80,
+
+    /**
+     * \brief The widget depends on its absolute position (e.g. to move a
+     *        native window along) and gets a position change notification
+     *        when the content offset of its parent changes
+     *
+     * \see sgui_widget_set_content_offset
+     */
+    SGUI_WIDGET_TRACK_POSITION = 0x100
 }
 SGUI_WIDGET_FLAG;
 
@@ -85,14 +117,54 @@ struct sgui_widget
     /** \brief The canvas that the widget is attached to */
     sgui_canvas* canvas;
 
-    /** \brief The next widget on the same level (linked list) */
-    sgui_widget* next;
+    /**
+     * \brief An array of pointers to the children of the widget, in
+     *        stacking order (i.e. the last one is drawn on top)
+     */
+    sgui_widget** children;
 
-    /** \brief A pointer to the first widget in the children list */
-    sgui_widget* children;
+    unsigned int num_children;  /**< \brief Number of children */
+    unsigned int max_children;  /**< \brief Size of the children array */
 
     sgui_widget* parent;    /**< \brief A pointer to the parent widget */
 
+    /**
+     * \brief The position of the widget in the children array of its
+     *        parent, i.e. the stacking order among the siblings
+     */
+    unsigned int index;
+
+    /** \brief If not NULL, a spatial index of the children */
+    sgui_grid* grid;
+
+    /** \brief The area under which the widget is stored in the parent grid */
+    sgui_rect grid_area;
+
+    /** \brief If the widget is cached, the layer holding its image */
+    sgui_layer* layer;
+
+    /**
+     * \brief Content offset, subtracted from the positions of all children
+     *        that don't have the SGUI_WIDGET_FIXED flag set
+     */
+    int scroll_x, scroll_y;
+
+    /**
+     * \brief Damage and state changes that are deferred until the current
+     *        transaction is committed
+     *
+     * \see sgui_widget_begin_transaction
+     */
+    struct
+    {
+        int listed;             /**< \brief In the transaction list */
+        int changes;            /**< \brief Pending state change flags */
+        int damaged;            /**< \brief Needs redrawing on commit */
+        sgui_canvas* canvas;    /**< \brief Canvas the widget was on */
+        sgui_rect area;         /**< \brief Absolute area it occupied */
+    }
+    pending;
+
     /** \copydoc sgui_widget_destroy */
     void (* destroy )( sgui_widget* widget );
 
@@ -146,6 +218,25 @@ extern "C" {
 SGUI_DLL void sgui_widget_init( sgui_widget* widget, int x, int y,
                                 unsigned int width, unsigned int height );
 
+/**
+ * \brief Enable or disable a spatial index for the children of a widget
+ *
+ * \memberof sgui_widget
+ *
+ * By default, finding the child widget at a position tests every child. For
+ * widgets with lots of children, a uniform grid can be used instead, that
+ * stores each child in the cells it overlaps. The grid is updated when
+ * children are added, removed or moved.
+ *
+ * \param widget    A pointer to a widget
+ * \param cell_size The edge length of a grid cell in pixels, or zero to
+ *                  disable the spatial index
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_widget_set_spatial_index( sgui_widget* widget,
+                                            unsigned int cell_size );
+
 /**
  * \brief Destroy a widget, freeing up all its resources
  *
@@ -153,10 +244,7 @@ SGUI_DLL void sgui_widget_init( sgui_widget* widget, int x, int y,
  *
  * \param widget A pointer to the widget to destroy
  */
-static SGUI_INLINE void sgui_widget_destroy( sgui_widget* widget )
-{
-    widget->destroy( widget );
-}
+SGUI_DLL void sgui_widget_destroy( sgui_widget* widget );
 
 /**
  * \brief Destroy the children of a widget
@@ -203,6 +291,50 @@ static SGUI_INLINE void sgui_widget_get_position( const sgui_widget* w,
     *y = w->area.top;
 }
 
+/**
+ * \brief Scroll the children of a widget
+ *
+ * \memberof sgui_widget
+ *
+ * Sets the content offset of a widget, i.e. an offset that is subtracted
+ * from the positions of all children without the SGUI_WIDGET_FIXED flag when
+ * drawing them, computing absolute positions and looking up widgets by
+ * position. The parent relative positions of the children stay the same.
+ *
+ * If a view area is given and the canvas supports it, the pixels already
+ * drawn inside the view area are moved and only the area that becomes
+ * visible is redrawn. The view must only contain scrolled children on a
+ * uniform background.
+ *
+ * Only children with the SGUI_WIDGET_TRACK_POSITION flag get a position
+ * change notification.
+ *
+ * \param widget A pointer to a widget
+ * \param x      The horizontal content offset
+ * \param y      The vertical content offset
+ * \param view   If not NULL, the widget relative area that displays the
+ *               scrolled children
+ */
+SGUI_DLL void sgui_widget_set_content_offset( sgui_widget* widget,
+                                              int x, int y,
+                                              const sgui_rect* view );
+
+/**
+ * \brief Get the content offset of a widget
+ *
+ * \memberof sgui_widget
+ *
+ * \param w A pointer to a widget
+ * \param x Returns the horizontal content offset
+ * \param y Returns the vertical content offset
+ */
+static SGUI_INLINE void sgui_widget_get_content_offset( const sgui_widget* w,
+                                                        int* x, int* y )
+{
+    *x = w->scroll_x;
+    *y = w->scroll_y;
+}
+
 /**
  * \brief Get the absolute position of a widget (i.e. not parent relative
  *        but relative to the window)
@@ -216,6 +348,21 @@ static SGUI_INLINE void sgui_widget_get_position( const sgui_widget* w,
 SGUI_DLL void sgui_widget_get_absolute_position( const sgui_widget* w,
                                                  int* x, int* y );
 
+/**
+ * \brief Change the size of a widget
+ *
+ * \memberof sgui_widget
+ *
+ * The widget receives a state change with the SGUI_WIDGET_SIZE_CHANGED flag
+ * set. Not all widgets adjust their contents to the new size.
+ *
+ * \param w      The widget to resize
+ * \param width  The new width of the widget
+ * \param height The new height of the widget
+ */
+SGUI_DLL void sgui_widget_set_size( sgui_widget* w, unsigned int width,
+                                    unsigned int height );
+
 /**
  * \brief Get the size of a widget
  *
@@ -259,6 +406,43 @@ SGUI_DLL void sgui_widget_set_visible( sgui_widget* w, int visible );
 SGUI_DLL void sgui_widget_get_absolute_rect( const sgui_widget* w,
                                              sgui_rect* r );
 
+/**
+ * \brief Flag an area of a widget as dirty, so it gets redrawn
+ *
+ * \memberof sgui_widget
+ *
+ * Widget implementations use this instead of sgui_canvas_add_dirty_rect
+ * when their appearance changes. Besides adding a dirty rect to the canvas,
+ * the area is rendered again in the cached layers of the widget and its
+ * parents only, while sgui_canvas_add_dirty_rect renders every layer
+ * touching the area again entirely.
+ *
+ * \param w A pointer to the widget
+ * \param r The dirty area in absolute coordinates
+ */
+SGUI_DLL void sgui_widget_add_dirty_rect( sgui_widget* w, sgui_rect* r );
+
+/**
+ * \brief Enable or disable caching of a widget subtree
+ *
+ * \memberof sgui_widget
+ *
+ * If enabled, the widget and its children are rendered into an off-screen
+ * pixmap on the canvas, composed over the plain window background.
+ * Redrawing the widget only copies the pixmap to the canvas. When the widget
+ * or one of its children flags an area as dirty with
+ * sgui_widget_add_dirty_rect, only that area is rendered into the pixmap
+ * again; moving the widget or redrawing things around it does not touch the
+ * pixmap. The pixmaps of a canvas are limited in
+ * size (see sgui_canvas_set_layer_limit) and the least recently drawn ones
+ * are discarded first. If a canvas implementation cannot render off-screen,
+ * the widget is drawn as usual.
+ *
+ * \param widget A pointer to a widget
+ * \param cached Non-zero to enable caching, zero to disable it
+ */
+SGUI_DLL void sgui_widget_set_cached( sgui_widget* widget, int cached );
+
 /**
  * \brief Send a parent widget or window event to a widget
  *
@@ -282,10 +466,51 @@ SGUI_DLL void sgui_widget_send_event( sgui_widget* widget,
  *
  * \memberof sgui_widget
  *
+ * The child is placed on top of all other children of the parent.
+ *
  * \param parent The parent to add the child widget to
  * \param child  The child widget to add to the parent
+ *
+ * \return Non-zero on success, zero if out of memory
+ */
+SGUI_DLL int sgui_widget_add_child( sgui_widget* parent, sgui_widget* child );
+
+/**
+ * \brief Start a batch of changes to the widget tree
+ *
+ * Until the matching call to sgui_widget_commit_transaction, the global
+ * mutex is held and the redrawing and state change callbacks caused by
+ * moving, showing, hiding, adding or removing widgets are collected. Every
+ * affected widget is then redrawn once and receives a single state change
+ * call with all flags that apply to it.
+ *
+ * Transactions can be nested, the changes are applied when the outermost
+ * transaction is committed.
+ */
+SGUI_DLL void sgui_widget_begin_transaction( void );
+
+/**
+ * \brief Apply all changes collected since sgui_widget_begin_transaction
+ */
+SGUI_DLL void sgui_widget_commit_transaction( void );
+
+/**
+ * \brief Move a widget on top of all its siblings
+ *
+ * \memberof sgui_widget
+ *
+ * \param widget A pointer to a widget
+ */
+SGUI_DLL void sgui_widget_raise( sgui_widget* widget );
+
+/**
+ * \brief Move a widget below all its siblings
+ *
+ * \memberof sgui_widget
+ *
+ * \param widget A pointer to a widget
  */
-SGUI_DLL void sgui_widget_add_child( sgui_widget* parent, sgui_widget* child );
+SGUI_DLL void sgui_widget_lower( sgui_widget* widget );
 
 /**
  * \brief Remove a widget from the widget hirarchy
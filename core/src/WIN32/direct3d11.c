@@ -140,7 +140,7 @@ static void context_d3d11_destroy( sgui_context* super )
     if( this->swapchain )
         IDXGISwapChain_Release( this->swapchain );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     release_d3d11( );
 }
 
@@ -269,7 +269,8 @@ sgui_context* d3d11_context_create( sgui_window* wnd,
         return NULL;
 
     /* allocate memory for the context object */
-    this = calloc( 1, sizeof(sgui_d3d11_context) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_d3d11_context),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_context*)this;
 
     if( !this )
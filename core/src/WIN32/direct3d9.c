@@ -138,7 +138,7 @@ static const int d_formats[] =
 static void context_d3d9_destroy( sgui_context* this )
 {
     IDirect3DDevice9_Release( ((sgui_d3d9_context*)this)->device );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     release_d3d9( );
 }
 
@@ -181,7 +181,8 @@ sgui_context* d3d9_context_create( sgui_window* wnd,
 
     sgui_internal_lock_mutex( );
 
-    this = calloc( 1, sizeof(sgui_d3d9_context) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_d3d9_context),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_context*)this;
     devtype = D3DDEVTYPE_HAL;
     adapter = 0;
@@ -290,7 +291,7 @@ sgui_context* d3d9_context_create( sgui_window* wnd,
     sgui_internal_unlock_mutex( );
     return super;
 fail:
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     release_d3d9( );
     sgui_internal_unlock_mutex( );
     return NULL;
@@ -52,8 +52,9 @@ static void w32_font_destroy( sgui_font* this )
     {
         FT_Done_Face( ((sgui_w32_font*)this)->face );
 
-        free( ((sgui_w32_font*)this)->buffer );
-        free( this );
+        sgui_internal_free( ((sgui_w32_font*)this)->buffer,
+                            SGUI_ALLOC_BUFFER );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     }
 }
 
@@ -144,7 +145,7 @@ sgui_font* sgui_font_load( const char* filename, unsigned int pixel_height )
         return NULL;
 
     /* allocate font structure */
-    this = calloc( 1, sizeof(sgui_w32_font) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_w32_font), SGUI_ALLOC_OBJECT );
     super = (sgui_font*)this;
 
     if( !this )
@@ -159,7 +160,7 @@ sgui_font* sgui_font_load( const char* filename, unsigned int pixel_height )
     if( !FT_New_Face( freetype, buffer, 0, &this->face ) )
         goto cont;
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 
 cont:
@@ -190,26 +191,26 @@ sgui_font* sgui_font_load_memory( const void* data, unsigned long size,
         return NULL;
 
     /* allocate font structure */
-    this = calloc( 1, sizeof(sgui_w32_font) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_w32_font), SGUI_ALLOC_OBJECT );
     super = (sgui_font*)this;
 
     if( !this )
         return NULL;
 
     /* allocate a buffer for the file */
-    this->buffer = malloc( size );
+    this->buffer = sgui_internal_malloc( size, SGUI_ALLOC_BUFFER );
 
     if( !this->buffer )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
     /* initialise the font */
     if( FT_New_Memory_Face( freetype, this->buffer, size, 0, &this->face ) )
     {
-        free( this->buffer );
-        free( this );
+        sgui_internal_free( this->buffer, SGUI_ALLOC_BUFFER );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
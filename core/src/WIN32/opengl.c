@@ -286,7 +286,8 @@ sgui_context* gl_context_create( sgui_window_w32* wnd, int backend,
 {
     HGLRC temp, oldctx, src = share ? ((sgui_gl_context*)share)->hRC : 0;
     WGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB = NULL;
-    sgui_gl_context* this = calloc( 1, sizeof(sgui_gl_context) );
+    sgui_gl_context* this = sgui_internal_calloc( 1, sizeof(sgui_gl_context),
+                                                  SGUI_ALLOC_OBJECT );
     sgui_context* super = (sgui_context*)this;
     int attribs[20];
     unsigned int i;
@@ -368,7 +369,7 @@ sgui_context* gl_context_create( sgui_window_w32* wnd, int backend,
     sgui_internal_unlock_mutex( );
     return super;
 fail:
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     sgui_internal_unlock_mutex( );
     return NULL;
 }
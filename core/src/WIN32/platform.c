@@ -63,11 +63,15 @@ static int is_window_active( void )
 static void update_windows( void )
 {
     sgui_window_w32* i;
+    int redraw;
+
+    /* damaged areas are collected and redrawn once per frame */
+    redraw = sgui_internal_frame_run( );
 
     sgui_internal_lock_mutex( );
 
     for( i=w32.list; i!=NULL; i=i->next )
-       update_window( i );
+       update_window( i, redraw );
 
     sgui_internal_unlock_mutex( );
 }
@@ -77,7 +81,8 @@ static void update_windows( void )
 WCHAR* utf8_to_utf16( const char* utf8, int rdbytes )
 {
     unsigned int length = MultiByteToWideChar(CP_UTF8,0,utf8,rdbytes,NULL,0);
-    WCHAR* out = malloc( sizeof(WCHAR)*(length+1) );
+    WCHAR* out = sgui_internal_malloc( sizeof(WCHAR)*(length+1),
+                                       SGUI_ALLOC_BUFFER );
 
     if( out )
     {
@@ -90,7 +95,7 @@ WCHAR* utf8_to_utf16( const char* utf8, int rdbytes )
 char* utf16_to_utf8( WCHAR* utf16 )
 {
     unsigned int size = WideCharToMultiByte(CP_UTF8,0,utf16,-1,0,0,0,0);
-    char* out = malloc( size+1 );
+    char* out = sgui_internal_malloc( size+1, SGUI_ALLOC_BUFFER );
 
     if( out )
     {
@@ -129,7 +134,7 @@ void w32_window_write_clipboard( sgui_window* this, const char* text,
                 }
             }
 
-            free( ptr );
+            sgui_internal_free( ptr, SGUI_ALLOC_BUFFER );
         }
 
         CloseClipboard( );
@@ -146,7 +151,7 @@ const char* w32_window_read_clipboard( sgui_window* this )
 
     sgui_internal_lock_mutex( );
 
-    free( w32.clipboard );
+    sgui_internal_free( w32.clipboard, SGUI_ALLOC_BUFFER );
     w32.clipboard = NULL;
 
     if( OpenClipboard( NULL ) )
@@ -183,25 +188,171 @@ void remove_window( sgui_window_w32* this )
 
 /****************************************************************************/
 
+void sgui_internal_lock( int lock )
+{
+    if( !TryEnterCriticalSection( w32.locks + lock ) )
+    {
+        InterlockedIncrement( w32.contention + lock );
+        EnterCriticalSection( w32.locks + lock );
+    }
+}
+
+void sgui_internal_unlock( int lock )
+{
+    LeaveCriticalSection( w32.locks + lock );
+}
+
+void sgui_get_lock_contention( unsigned long* counts )
+{
+    int i;
+
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )
+        counts[ i ] = (unsigned long)w32.contention[ i ];
+}
+
 void sgui_internal_lock_mutex( void )
 {
-    EnterCriticalSection( &w32.mutex );
+    sgui_internal_lock( SGUI_LOCK_GLOBAL );
 }
 
 void sgui_internal_unlock_mutex( void )
 {
-    LeaveCriticalSection( &w32.mutex );
+    sgui_internal_unlock( SGUI_LOCK_GLOBAL );
+}
+
+int sgui_internal_atomic_cas( volatile unsigned int* ptr,
+                              unsigned int expected, unsigned int value )
+{
+    return InterlockedCompareExchange( (volatile LONG*)ptr, (LONG)value,
+                                       (LONG)expected ) == (LONG)expected;
+}
+
+long sgui_internal_atomic_add( volatile long* ptr, long value )
+{
+    return InterlockedExchangeAdd( (volatile LONG*)ptr, value ) + value;
+}
+
+void sgui_internal_memory_barrier( void )
+{
+    MemoryBarrier( );
+}
+
+typedef struct
+{
+    HANDLE thread;
+    void (* function )( void* );
+    void* arg;
+}
+thread_start;
+
+static DWORD WINAPI thread_trampoline( LPVOID arg )
+{
+    thread_start* start = arg;
+
+    start->function( start->arg );
+    return 0;
+}
+
+void* sgui_internal_thread_create( void(* function )( void* ), void* arg )
+{
+    thread_start* start = sgui_internal_malloc( sizeof(thread_start),
+                                                SGUI_ALLOC_OBJECT );
+
+    if( !start )
+        return NULL;
+
+    start->function = function;
+    start->arg = arg;
+    start->thread = CreateThread( NULL, 0, thread_trampoline, start, 0, NULL );
+
+    if( !start->thread )
+    {
+        sgui_internal_free( start, SGUI_ALLOC_OBJECT );
+        return NULL;
+    }
+
+    return start;
+}
+
+void sgui_internal_thread_join( void* thread )
+{
+    thread_start* start = thread;
+
+    WaitForSingleObject( start->thread, INFINITE );
+    CloseHandle( start->thread );
+    sgui_internal_free( start, SGUI_ALLOC_OBJECT );
+}
+
+void* sgui_internal_semaphore_create( void )
+{
+    return CreateSemaphoreA( NULL, 0, 0x7FFFFFFF, NULL );
+}
+
+void sgui_internal_semaphore_destroy( void* sem )
+{
+    CloseHandle( sem );
+}
+
+void sgui_internal_semaphore_post( void* sem )
+{
+    ReleaseSemaphore( sem, 1, NULL );
+}
+
+void sgui_internal_semaphore_wait( void* sem )
+{
+    WaitForSingleObject( sem, INFINITE );
+}
+
+void sgui_internal_wake_main_loop( void )
+{
+    /* only the first wake up since the main loop last woke posts */
+    if( InterlockedCompareExchange( &w32.wake_pending, 1, 0 ) != 0 )
+        return;
+
+    if( !PostThreadMessageA( w32.main_thread, WM_NULL, 0, 0 ) )
+        w32.wake_pending = 0;
+}
+
+int sgui_internal_input_pending( void )
+{
+    return HIWORD( GetQueueStatus( QS_INPUT|QS_PAINT|QS_POSTMESSAGE ) )!=0;
+}
+
+unsigned long sgui_internal_get_time_ms( void )
+{
+    return GetTickCount( );
+}
+
+int sgui_watch_fd( int fd, int events, sgui_fd_callback callback,
+                   void* user )
+{
+    (void)fd; (void)events; (void)callback; (void)user;
+    return 0;
+}
+
+void sgui_unwatch_fd( int fd )
+{
+    (void)fd;
+}
+
+int sgui_get_loop_fd( void )
+{
+    return -1;
 }
 
 int sgui_init( void )
 {
     WNDCLASSEXA wc;
+    int i;
 
     memset( &w32, 0, sizeof(w32) );             /* clear global state */
 
     w32.wndclass = "sgui_wnd_class";            /* store wndclass name */
 
-    InitializeCriticalSection( &w32.mutex );    /* initalize global mutex */
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )           /* initialize the locks */
+        InitializeCriticalSection( w32.locks + i );
+
+    w32.main_thread = GetCurrentThreadId( );    /* for main loop wake up */
 
     if( !font_init( ) )                         /* initialise font system */
         goto fail;
@@ -224,6 +375,10 @@ int sgui_init( void )
 
     sgui_skin_set( NULL );      /* initialise default GUI skin */
     sgui_event_reset( );        /* reset event subsystem */
+
+    if( !sgui_internal_task_init( ) )
+        goto fail;
+
     return 1;
 fail:
     sgui_deinit( );
@@ -232,13 +387,24 @@ fail:
 
 void sgui_deinit( void )
 {
+    int i;
+
+    sgui_internal_task_deinit( );               /* stop worker threads */
     sgui_event_reset( );                        /* reset event subsystem */
+    sgui_internal_timer_reset( );               /* destroy all timers */
+    sgui_internal_frame_reset( );               /* reset frame clock */
+    sgui_internal_idle_reset( );                /* destroy all idle tasks */
     sgui_interal_skin_deinit_default( );        /* reset skinning system */
     font_deinit( );                             /* cleanup font system */
+    sgui_internal_pool_reset( );                /* free object pools */
 
     UnregisterClassA( w32.wndclass, w32.hInstance );   /* remove wndclass */
-    DeleteCriticalSection( &w32.mutex );        /* destroy global mutex */
-    free( w32.clipboard );                      /* destroy clipboard buffer */
+
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )           /* destroy the locks */
+        DeleteCriticalSection( w32.locks + i );
+
+    sgui_internal_free( w32.clipboard,          /* destroy clipboard buffer */
+                        SGUI_ALLOC_BUFFER );
 
     memset( &w32, 0, sizeof(w32) );             /* clear global state */
 }
@@ -255,22 +421,50 @@ int sgui_main_loop_step( void )
         DispatchMessageA( &msg );
     }
 
+    sgui_internal_timer_run( );
     sgui_event_process( );
+    sgui_internal_idle_run( );
 
     return is_window_active( ) || sgui_event_queued( );
 }
 
 void sgui_main_loop( void )
 {
+    long timeout, frame;
     MSG msg;
 
     while( is_window_active( ) )
     {
         update_windows( );
-        GetMessageA( &msg, 0, 0, 0 );
-        TranslateMessage( &msg );
-        DispatchMessageA( &msg );
+
+        /* sleep until a message arrives, a timer expires or a frame is due */
+        timeout = sgui_internal_timer_timeout( );
+        frame = sgui_internal_frame_timeout( );
+
+        if( frame >= 0 && (timeout < 0 || frame < timeout) )
+            timeout = frame;
+
+        /* idle tasks must not let the loop sleep */
+        if( sgui_internal_idle_pending( ) )
+            timeout = 0;
+
+        MsgWaitForMultipleObjects( 0, NULL, FALSE,
+                                   timeout<0 ? INFINITE : (DWORD)timeout,
+                                   QS_ALLINPUT );
+
+        InterlockedExchange( &w32.wake_pending, 0 );
+
+        while( PeekMessageA( &msg, 0, 0, 0, PM_REMOVE ) )
+        {
+            TranslateMessage( &msg );
+            DispatchMessageA( &msg );
+        }
+
+        sgui_internal_timer_run( );
         sgui_event_process( );
+
+        /* idle tasks get what is left of the iteration */
+        sgui_internal_idle_run( );
     }
 
     while( sgui_event_queued( ) )
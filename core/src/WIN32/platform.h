@@ -71,8 +71,11 @@ extern struct w32_state
     HINSTANCE hInstance;        /* instance handle */
     const char* wndclass;       /* window class name */
     sgui_window_w32* list;      /* global list of all windows */
-    CRITICAL_SECTION mutex;     /* global sgui mutex */
+    CRITICAL_SECTION locks[ SGUI_NUM_LOCKS ];   /* see SGUI_LOCK */
+    volatile LONG contention[ SGUI_NUM_LOCKS ];
     char* clipboard;            /* clipboard translaton buffer */
+    DWORD main_thread;          /* ID of the thread that called sgui_init */
+    volatile LONG wake_pending; /* non-zero if a wake up message is queued */
 }
 w32;
 
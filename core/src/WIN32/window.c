@@ -148,7 +148,7 @@ static void w32_window_set_title( sgui_window* this, const char* title )
 
     sgui_internal_unlock_mutex( );
 
-    free( utf16 );
+    sgui_internal_free( utf16, SGUI_ALLOC_BUFFER );
 }
 
 static void w32_window_set_size( sgui_window* this,
@@ -273,19 +273,19 @@ static void w32_window_destroy( sgui_window* this )
     DestroyWindow( TO_W32(this)->hWnd );
     sgui_internal_unlock_mutex( );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
 
-void update_window( sgui_window_w32* this )
+void update_window( sgui_window_w32* this, int redraw )
 {
     sgui_window* super = (sgui_window*)this;
     unsigned int i, num;
     sgui_rect sr;
     RECT r;
 
-    if( super->backend == SGUI_NATIVE )
+    if( super->backend == SGUI_NATIVE && redraw )
     {
         num = sgui_canvas_num_dirty_rects( super->ctx.canvas );
 
@@ -466,7 +466,8 @@ sgui_window* sgui_window_create_desc( const sgui_window_description* desc )
     if( desc->flags & ~SGUI_ALL_WINDOW_FLAGS )
         return NULL;
 
-    this = calloc( 1, sizeof(sgui_window_w32) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_window_w32),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_window*)this;
 
     if( !this )
@@ -549,7 +550,7 @@ sgui_window* sgui_window_create_desc( const sgui_window_description* desc )
     return (sgui_window*)this;
 faildc:  ReleaseDC(this->hWnd, this->hDC);
 failcv:  DestroyWindow( this->hWnd );
-failwnd: free( this );
+failwnd: sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     sgui_internal_unlock_mutex( );
     return NULL;
 }
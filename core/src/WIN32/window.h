@@ -57,8 +57,11 @@ sgui_window_w32;
 extern "C" {
 #endif
 
-/* in window.c: invalidate all dirty rects of the canvas */
-void update_window( sgui_window_w32* wnd );
+/*
+    in window.c: invalidate all dirty rects of the canvas if
+    redraw is non-zero, check if a Direct3D 9 device got lost
+ */
+void update_window( sgui_window_w32* wnd, int redraw );
 
 /* in window.c: handle window messages */
 int handle_window_events( sgui_window_w32* wnd, UINT msg,
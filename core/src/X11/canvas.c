@@ -30,27 +30,6 @@
 
 
 
-static int canvas_x11_dirty_hook( sgui_canvas* super, const sgui_rect* r )
-{
-    sgui_canvas_x11* this = (sgui_canvas_x11*)super;
-    XExposeEvent exp;
-
-    memset( &exp, 0, sizeof(exp) );
-    exp.type       = Expose;
-    exp.send_event = 1;
-    exp.display    = x11.dpy;
-    exp.window     = (Window)this->wnd;
-    exp.x          = r->left;
-    exp.y          = r->top;
-    exp.width      = SGUI_RECT_WIDTH_V(r);
-    exp.height     = SGUI_RECT_HEIGHT_V(r);
-
-    sgui_internal_lock_mutex( );
-    XSendEvent(x11.dpy,(Window)this->wnd,False,ExposureMask,(XEvent*)&exp);
-    sgui_internal_unlock_mutex( );
-    return 0;
-}
-
 static int canvas_x11_draw_string( sgui_canvas* super, int x, int y,
                                    sgui_font* font,
                                    const unsigned char* color,
@@ -124,16 +103,61 @@ static void canvas_x11_clear( sgui_canvas* super, sgui_rect* r )
     sgui_internal_unlock_mutex( );
 }
 
+static int canvas_x11_scroll( sgui_canvas* super, const sgui_rect* r,
+                              int dx, int dy )
+{
+    sgui_canvas_x11* this = (sgui_canvas_x11*)super;
+    XGCValues values;
+    sgui_rect src;
+    XEvent e;
+    int ret = 0;
+
+    sgui_internal_lock_mutex( );
+
+    if( !this->scroll_gc )
+    {
+        values.graphics_exposures = True;
+        this->scroll_gc = XCreateGC( x11.dpy, this->wnd,
+                                     GCGraphicsExposures, &values );
+        if( !this->scroll_gc )
+            goto out;
+    }
+
+    /* pending exposures would end up in the wrong place, redraw instead */
+    XSync( x11.dpy, False );
+
+    if( XCheckTypedWindowEvent( x11.dpy, this->wnd, Expose, &e ) )
+    {
+        XPutBackEvent( x11.dpy, &e );
+        goto out;
+    }
+
+    /* copy the part that stays inside the area, obscured parts
+       generate GraphicsExpose events */
+    src = *r;
+    sgui_rect_add_offset( &src, -dx, -dy );
+    sgui_rect_get_intersection( &src, &src, r );
+
+    XCopyArea( x11.dpy, this->wnd, this->wnd, this->scroll_gc,
+               src.left, src.top, SGUI_RECT_WIDTH(src),
+               SGUI_RECT_HEIGHT(src), src.left+dx, src.top+dy );
+    ret = 1;
+out:
+    sgui_internal_unlock_mutex( );
+    return ret;
+}
+
 static void canvas_x11_init( sgui_canvas* super, Drawable wnd,
-                             sgui_funptr clip, int sendexpose )
+                             sgui_funptr clip, int is_window )
 {
     sgui_canvas_x11* this = (sgui_canvas_x11*)super;
     super->resize       = canvas_x11_resize;
     super->clear        = canvas_x11_clear;
     super->draw_string  = canvas_x11_draw_string;
     this->wnd           = wnd;
+    this->target        = wnd;
     this->set_clip_rect = clip;
-    super->dirty_rect_hook = sendexpose ? canvas_x11_dirty_hook : NULL;
+    super->scroll       = is_window ? canvas_x11_scroll : NULL;
 }
 
 /************************ xlib based implementation ************************/
@@ -145,10 +169,13 @@ static void canvas_xlib_destroy( sgui_canvas* super )
     if( ((sgui_canvas_x11*)this)->cache )
         sgui_icon_cache_destroy( ((sgui_canvas_x11*)this)->cache );
 
+    if( ((sgui_canvas_x11*)this)->scroll_gc )
+        XFreeGC( x11.dpy, ((sgui_canvas_x11*)this)->scroll_gc );
+
     XFreeGC( x11.dpy, this->gc );
     sgui_internal_unlock_mutex( );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void canvas_xlib_set_clip_rect( sgui_canvas_x11* super,
@@ -194,8 +221,9 @@ static void canvas_xlib_draw_box( sgui_canvas* super, sgui_rect* r,
 
     sgui_internal_lock_mutex( );
     XSetForeground( x11.dpy, this->gc, (R<<16) | (G<<8) | B );
-    XFillRectangle( x11.dpy, ((sgui_canvas_x11*)this)->wnd, this->gc, r->left,
-                    r->top, SGUI_RECT_WIDTH_V(r), SGUI_RECT_HEIGHT_V(r) );
+    XFillRectangle( x11.dpy, ((sgui_canvas_x11*)this)->target, this->gc,
+                    r->left, r->top,
+                    SGUI_RECT_WIDTH_V(r), SGUI_RECT_HEIGHT_V(r) );
     sgui_internal_unlock_mutex( );
 }
 
@@ -209,12 +237,24 @@ static void canvas_xlib_blit( sgui_canvas* super, int x, int y,
         return;
 
     sgui_internal_lock_mutex( );
-    XCopyArea( x11.dpy, pix->data.xpm, ((sgui_canvas_x11*)this)->wnd,
+    XCopyArea( x11.dpy, pix->data.xpm, ((sgui_canvas_x11*)this)->target,
                this->gc, srcrect->left, srcrect->top,
                SGUI_RECT_WIDTH_V(srcrect), SGUI_RECT_HEIGHT_V(srcrect), x, y );
     sgui_internal_unlock_mutex( );
 }
 
+static int canvas_xlib_set_target( sgui_canvas* super, sgui_pixmap* pixmap )
+{
+    sgui_canvas_x11* this = (sgui_canvas_x11*)super;
+    xlib_pixmap* pix = (xlib_pixmap*)pixmap;
+
+    if( pix && pix->is_stencil )
+        return 0;
+
+    this->target = pix ? pix->data.xpm : this->wnd;
+    return 1;
+}
+
 static void canvas_xlib_blend_glyph( sgui_canvas* super, int x, int y,
                                      sgui_pixmap* pixmap, sgui_rect* r,
                                      const unsigned char* color )
@@ -252,7 +292,7 @@ static void canvas_xlib_blend_glyph( sgui_canvas* super, int x, int y,
                  C[0];
 
             XSetForeground( x11.dpy, this->gc, sc );
-            XDrawPoint( x11.dpy, ((sgui_canvas_x11*)this)->wnd, this->gc,
+            XDrawPoint( x11.dpy, ((sgui_canvas_x11*)this)->target, this->gc,
                         x+X-r->left, y+Y-r->top );
         }
     }
@@ -269,13 +309,16 @@ static void canvas_xrender_destroy( sgui_canvas* super )
     if( ((sgui_canvas_x11*)this)->cache )
         sgui_icon_cache_destroy( ((sgui_canvas_x11*)this)->cache );
 
+    if( ((sgui_canvas_x11*)this)->scroll_gc )
+        XFreeGC( x11.dpy, ((sgui_canvas_x11*)this)->scroll_gc );
+
     if( this->pic ) XRenderFreePicture( x11.dpy, this->pic );
     if( this->pen ) XRenderFreePicture( x11.dpy, this->pen );
     if( this->penmap ) XFreePixmap( x11.dpy, this->penmap );
 
     sgui_internal_unlock_mutex( );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void canvas_xrender_set_clip_rect( sgui_canvas_x11* super,
@@ -350,6 +393,15 @@ static void canvas_xrender_blend( sgui_canvas* super, int x, int y,
     sgui_internal_unlock_mutex( );
 }
 
+static int canvas_xrender_set_target( sgui_canvas* super,
+                                      sgui_pixmap* pixmap )
+{
+    sgui_canvas_xrender* this = (sgui_canvas_xrender*)super;
+
+    this->pic = pixmap ? ((xrender_pixmap*)pixmap)->pic : this->wndpic;
+    return 1;
+}
+
 static void canvas_xrender_blend_glyph( sgui_canvas* super, int x, int y,
                                         sgui_pixmap* pixmap, sgui_rect* r,
                                         const unsigned char* color )
@@ -373,7 +425,7 @@ static void canvas_xrender_blend_glyph( sgui_canvas* super, int x, int y,
 }
 
 static sgui_canvas* canvas_xrender_create(Drawable wnd, unsigned int width,
-                                          unsigned int height, int sendexpose)
+                                          unsigned int height, int is_window)
 {
     sgui_canvas_xrender* this;
     sgui_canvas* super = NULL;
@@ -389,7 +441,8 @@ static sgui_canvas* canvas_xrender_create(Drawable wnd, unsigned int width,
     if( !fmt )
         goto fail;
 
-    this = calloc( 1, sizeof(sgui_canvas_xrender) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_canvas_xrender),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_canvas*)this;
 
     if( !this )
@@ -399,6 +452,8 @@ static sgui_canvas* canvas_xrender_create(Drawable wnd, unsigned int width,
     if( !(this->pic = XRenderCreatePicture( x11.dpy, wnd, fmt, 0, NULL )) )
         goto failfree;
 
+    this->wndpic = this->pic;
+
     attr.repeat = RepeatNormal;
     this->pen = XRenderCreatePicture(x11.dpy,this->penmap,fmt,CPRepeat,&attr);
     if( !this->pen )
@@ -413,9 +468,11 @@ static sgui_canvas* canvas_xrender_create(Drawable wnd, unsigned int width,
     super->blend         = canvas_xrender_blend;
     super->blend_glyph   = canvas_xrender_blend_glyph;
     super->create_pixmap = xrender_pixmap_create;
+    super->adopt_pixmap  = xrender_pixmap_adopt;
     super->draw_box      = canvas_xrender_draw_box;
+    super->set_target    = canvas_xrender_set_target;
 
-    canvas_x11_init( super, wnd, canvas_xrender_set_clip_rect, sendexpose );
+    canvas_x11_init( super, wnd, canvas_xrender_set_clip_rect, is_window );
     return (sgui_canvas*)this;
 failfree:
     sgui_internal_unlock_mutex( );
@@ -427,18 +484,19 @@ fail:
 #endif /* !SGUI_NO_XRENDER */
 
 sgui_canvas* canvas_x11_create( Drawable wnd, unsigned int width,
-                                unsigned int height, int sendexpose )
+                                unsigned int height, int is_window )
 {
     sgui_canvas_xlib* this;
     sgui_canvas* super;
 
 #ifndef SGUI_NO_XRENDER
-    super = canvas_xrender_create( wnd, width, height, sendexpose );
+    super = canvas_xrender_create( wnd, width, height, is_window );
     if( super )
         return super;
 #endif
 
-    this = calloc( 1, sizeof(sgui_canvas_xlib) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_canvas_xlib),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_canvas*)this;
 
     if( !this )
@@ -461,14 +519,16 @@ sgui_canvas* canvas_x11_create( Drawable wnd, unsigned int width,
     super->blend         = canvas_xlib_blit;
     super->blend_glyph   = canvas_xlib_blend_glyph;
     super->create_pixmap = xlib_pixmap_create;
+    super->adopt_pixmap  = xlib_pixmap_adopt;
     super->draw_box      = canvas_xlib_draw_box;
+    super->set_target    = canvas_xlib_set_target;
 
-    canvas_x11_init( super, wnd, canvas_xlib_set_clip_rect, sendexpose );
+    canvas_x11_init( super, wnd, canvas_xlib_set_clip_rect, is_window );
     return (sgui_canvas*)this;
 fail:
     if( this->gc ) XFreeGC( x11.dpy, this->gc );
     sgui_internal_unlock_mutex( );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
 
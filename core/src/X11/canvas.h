@@ -45,6 +45,8 @@ typedef struct sgui_canvas_x11
 {
     sgui_canvas super;
     Drawable wnd;
+    Drawable target;    /* drawable rendered to, wnd or a layer pixmap */
+    GC scroll_gc;       /* GC for moving pixels inside wnd */
 
     sgui_icon_cache* cache; /* a font cache by the canvas */
 
@@ -57,6 +59,7 @@ typedef struct
 {
     sgui_canvas_x11 super;
     Picture pic;
+    Picture wndpic;     /* picture of wnd, pic may refer to a layer */
 
     Picture pen;
     Pixmap penmap;
@@ -76,7 +79,7 @@ extern "C" {
 #endif
 
 sgui_canvas* canvas_x11_create( Drawable wnd, unsigned int width,
-                                unsigned int height, int sendexpose );
+                                unsigned int height, int is_window );
 
 #ifdef __cplusplus
 }
@@ -52,8 +52,9 @@ static void x11_font_destroy( sgui_font* this )
     {
         FT_Done_Face( ((sgui_x11_font*)this)->face );
 
-        free( ((sgui_x11_font*)this)->buffer );
-        free( this );
+        sgui_internal_free( ((sgui_x11_font*)this)->buffer,
+                            SGUI_ALLOC_BUFFER );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     }
 }
 
@@ -139,7 +140,7 @@ static sgui_x11_font* sgui_font_load_common( unsigned int pixel_height )
     sgui_font* super;
 
     /* allocate font structure */
-    this = calloc( 1, sizeof(sgui_x11_font) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_x11_font), SGUI_ALLOC_OBJECT );
     super = (sgui_font*)this;
 
     if( !this )
@@ -185,7 +186,7 @@ sgui_font* sgui_font_load( const char* filename, unsigned int pixel_height )
         goto cont;
 #endif
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 
 cont:
@@ -210,19 +211,19 @@ sgui_font* sgui_font_load_memory( const void* data, unsigned long size,
         return NULL;
 
     /* allocate a buffer for the file */
-    this->buffer = malloc( size );
+    this->buffer = sgui_internal_malloc( size, SGUI_ALLOC_BUFFER );
 
     if( !this->buffer )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
     /* initialise the font */
     if( FT_New_Memory_Face( freetype, this->buffer, size, 0, &this->face ) )
     {
-        free( this->buffer );
-        free( this );
+        sgui_internal_free( this->buffer, SGUI_ALLOC_BUFFER );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -81,7 +81,7 @@ static void gl_context_destroy( sgui_context* this )
     glXDestroyContext( x11.dpy, ((sgui_context_gl*)this)->gl );
     sgui_internal_unlock_mutex( );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void gl_context_make_current( sgui_context* this, sgui_window* wnd )
@@ -149,7 +149,8 @@ sgui_context* gl_context_create( sgui_window* wnd, int backend,
                                  sgui_context* share )
 {
     CREATECONTEXTATTRIBSPROC CreateContextAttribs;
-    sgui_context_gl* this = calloc( 1, sizeof(sgui_context_gl) );
+    sgui_context_gl* this = sgui_internal_calloc( 1, sizeof(sgui_context_gl),
+                                                  SGUI_ALLOC_OBJECT );
     sgui_context* super = (sgui_context*)this;
     GLXContext sctx = share ? ((sgui_context_gl*)share)->gl : 0;
     int attribs[10];
@@ -204,7 +205,7 @@ sgui_context* gl_context_create( sgui_window* wnd, int backend,
     sgui_internal_unlock_mutex( );
     return super;
 fail:
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
 
@@ -34,16 +34,19 @@ void xlib_pixmap_destroy( sgui_pixmap* super )
 
     if( this->is_stencil )
     {
-        free( this->data.pixels );
+        sgui_internal_free( this->data.pixels, SGUI_ALLOC_PIXELS );
     }
     else
     {
         sgui_internal_lock_mutex( );
         XFreePixmap( x11.dpy, this->data.xpm );
         sgui_internal_unlock_mutex( );
+
+        sgui_internal_memory_account( SGUI_MEMORY_X11_SERVER,
+                                      -4L*super->width*super->height, -1 );
     }
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 void xlib_pixmap_load( sgui_pixmap* super, int dstx, int dsty,
@@ -105,7 +108,8 @@ void xlib_pixmap_load( sgui_pixmap* super, int dstx, int dsty,
 sgui_pixmap* xlib_pixmap_create( sgui_canvas* cv, unsigned int width,
                                  unsigned int height, int format )
 {
-    xlib_pixmap* this = calloc( 1, sizeof(xlib_pixmap) );
+    xlib_pixmap* this = sgui_internal_calloc( 1, sizeof(xlib_pixmap),
+                                              SGUI_MEM(X11_PIXMAPS,OBJECT) );
     sgui_canvas_xlib* owner = (sgui_canvas_xlib*)cv;
     Drawable wnd = ((sgui_canvas_x11*)cv)->wnd;
     sgui_pixmap* super = (sgui_pixmap*)this;
@@ -122,13 +126,21 @@ sgui_pixmap* xlib_pixmap_create( sgui_canvas* cv, unsigned int width,
 
         if( format==SGUI_A8 )
         {
-            this->data.pixels = malloc( width*height );
+            this->data.pixels =
+                sgui_internal_malloc( width*height,
+                                      SGUI_MEM(X11_PIXMAPS,PIXELS) );
         }
         else
         {
             sgui_internal_lock_mutex( );
             this->data.xpm = XCreatePixmap( x11.dpy, wnd, width, height, 24 );
             sgui_internal_unlock_mutex( );
+
+            if( this->data.xpm )
+            {
+                sgui_internal_memory_account( SGUI_MEMORY_X11_SERVER,
+                                              4L*width*height, 1 );
+            }
         }
 
         if( !this->data.pixels || !this->data.xpm )
@@ -137,9 +149,19 @@ sgui_pixmap* xlib_pixmap_create( sgui_canvas* cv, unsigned int width,
 
     return (sgui_pixmap*)this;
 fail:
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
+
+int xlib_pixmap_adopt( sgui_canvas* cv, sgui_pixmap* super )
+{
+    if( super->destroy!=xlib_pixmap_destroy )
+        return 0;
+
+    /* X pixmaps live on the server, only the GC for uploads is per canvas */
+    ((xlib_pixmap*)super)->owner = (sgui_canvas_xlib*)cv;
+    return 1;
+}
 /****************************************************************************/
 #ifndef SGUI_NO_XRENDER
 void xrender_pixmap_destroy( sgui_pixmap* super )
@@ -150,7 +172,10 @@ void xrender_pixmap_destroy( sgui_pixmap* super )
     XRenderFreePicture( x11.dpy, this->pic );
     XFreePixmap( x11.dpy, this->pix );
     sgui_internal_unlock_mutex( );
-    free( this );
+
+    sgui_internal_memory_account( SGUI_MEMORY_X11_SERVER,
+                                  -this->server_bytes, -1 );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 void xrender_pixmap_load( sgui_pixmap* super, int dstx, int dsty,
@@ -228,7 +253,8 @@ sgui_pixmap* xrender_pixmap_create( sgui_canvas* cv, unsigned int width,
     int type;
 
     /* create pixmap structure */
-    this = calloc( 1, sizeof(xrender_pixmap) ); 
+    this = sgui_internal_calloc( 1, sizeof(xrender_pixmap),
+                                 SGUI_MEM(X11_PIXMAPS,OBJECT) );
     super = (sgui_pixmap*)this;
 
     if( !this )
@@ -263,11 +289,23 @@ sgui_pixmap* xrender_pixmap_create( sgui_canvas* cv, unsigned int width,
     }
 
     sgui_internal_unlock_mutex( );
+
+    /* 8 bit pixmaps take a byte per pixel, 24 and 32 bit ones four */
+    this->server_bytes = (long)width*height *
+                         (format==SGUI_RGBA8 || format==SGUI_RGB8 ? 4 : 1);
+    sgui_internal_memory_account( SGUI_MEMORY_X11_SERVER,
+                                  this->server_bytes, 1 );
     return (sgui_pixmap*)this;
 fail:
     sgui_internal_unlock_mutex( );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
+
+int xrender_pixmap_adopt( sgui_canvas* cv, sgui_pixmap* super )
+{
+    (void)cv;
+    return super->destroy==xrender_pixmap_destroy;
+}
 #endif /* !SGUI_NO_XRENDER */
 
@@ -46,6 +46,7 @@ typedef struct
 
     Pixmap pix;
     Picture pic;
+    long server_bytes;      /* estimated size of the server side pixmap */
 }
 xrender_pixmap;
 
@@ -75,10 +76,16 @@ extern "C" {
 sgui_pixmap* xrender_pixmap_create( sgui_canvas* canvas, unsigned int width,
                                     unsigned int height, int format );
 
+/* use an xrender pixmap of a different canvas on an xrender canvas */
+int xrender_pixmap_adopt( sgui_canvas* canvas, sgui_pixmap* pixmap );
+
 /* create an xlib pixmap */
 sgui_pixmap* xlib_pixmap_create( sgui_canvas* cv, unsigned int width,
                                  unsigned int height, int format );
 
+/* use an xlib pixmap of a different canvas on an xlib canvas */
+int xlib_pixmap_adopt( sgui_canvas* cv, sgui_pixmap* pixmap );
+
 #ifdef __cplusplus
 }
 #endif
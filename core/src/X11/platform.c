@@ -26,8 +26,12 @@
 #include "sgui.h"
 #include "platform.h"
 
-#include <sys/select.h>
+#include <semaphore.h>
 #include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <time.h>
 
 
@@ -40,7 +44,9 @@ static int resize_clipboard_buffer( unsigned int additional )
 {
     char* new;
 
-    new = realloc(x11.clipboard_buffer, x11.clipboard_size + additional);
+    new = sgui_internal_realloc( x11.clipboard_buffer,
+                                 x11.clipboard_size + additional,
+                                 SGUI_MEM(CLIPBOARD,BUFFER) );
 
     if( !new )
         return 0;
@@ -136,6 +142,30 @@ static void handle_events( void )
     }
 }
 
+/* redraw the dirty areas of all windows, called once per frame */
+static void redraw_windows( void )
+{
+    sgui_window_xlib* i;
+    sgui_canvas* cv;
+
+    sgui_internal_lock_mutex( );
+
+    /* input that arrived in the mean time goes before redrawing */
+    handle_events( );
+
+    for( i=x11.list; i!=NULL; i=i->next )
+    {
+        cv = i->super.ctx.canvas;
+
+        if( i->super.backend==SGUI_NATIVE && (i->super.flags & SGUI_VISIBLE) &&
+            sgui_canvas_num_dirty_rects( cv ) )
+            sgui_canvas_redraw_widgets( cv, 1 );
+    }
+
+    XFlush( x11.dpy );
+    sgui_internal_unlock_mutex( );
+}
+
 /* returns non-zero if there's at least 1 window still active */
 static int have_active_windows( void )
 {
@@ -204,7 +234,9 @@ void xlib_window_clipboard_write( sgui_window* this, const char* text,
     if( x11.clipboard_size <= x11.clipboard_strlen )
     {
         x11.clipboard_size=x11.clipboard_strlen+1;
-        x11.clipboard_buffer=realloc(x11.clipboard_buffer,x11.clipboard_size);
+        x11.clipboard_buffer =
+            sgui_internal_realloc( x11.clipboard_buffer, x11.clipboard_size,
+                                   SGUI_MEM(CLIPBOARD,BUFFER) );
     }
 
     strncpy( x11.clipboard_buffer, text, x11.clipboard_strlen );
@@ -345,12 +377,13 @@ const char* xlib_window_clipboard_read( sgui_window* this )
     {
         pty_size = sgui_utf8_from_latin1_length( x11.clipboard_buffer );
 
-        buffer = malloc( pty_size + 1 );
+        buffer = sgui_internal_malloc( pty_size + 1,
+                                       SGUI_MEM(CLIPBOARD,BUFFER) );
         if( !buffer )
             goto fail;
 
         sgui_utf8_from_latin1( (char*)buffer, x11.clipboard_buffer );
-        free( x11.clipboard_buffer );
+        sgui_internal_free( x11.clipboard_buffer, SGUI_ALLOC_BUFFER );
         x11.clipboard_buffer = (char*)buffer;
         x11.clipboard_size = pty_size+1;
         x11.clipboard_strlen = pty_size;
@@ -366,7 +399,7 @@ fail:
 
 /****************************************************************************/
 
-static unsigned long get_time_ms( void )
+unsigned long sgui_internal_get_time_ms( void )
 {
     struct timespec ts;
 
@@ -385,7 +418,7 @@ int check_double_click( sgui_window_xlib* window )
 
     if( x11.clicked == window )
     {
-        current = get_time_ms( );
+        current = sgui_internal_get_time_ms( );
         delta = current >= x11.click_time ? (current - x11.click_time) :
                                              DOUBLE_CLICK_MS*64;
 
@@ -394,7 +427,7 @@ int check_double_click( sgui_window_xlib* window )
     }
 
     x11.clicked = window;
-    x11.click_time = get_time_ms( );
+    x11.click_time = sgui_internal_get_time_ms( );
     return 0;
 }
 
@@ -406,25 +439,410 @@ void interrupt_double_click( void )
 
 /****************************************************************************/
 
+void sgui_internal_lock( int lock )
+{
+    if( pthread_mutex_trylock( x11.locks + lock ) != 0 )
+    {
+        __sync_fetch_and_add( x11.contention + lock, 1 );
+        pthread_mutex_lock( x11.locks + lock );
+    }
+}
+
+void sgui_internal_unlock( int lock )
+{
+    pthread_mutex_unlock( x11.locks + lock );
+}
+
+void sgui_get_lock_contention( unsigned long* counts )
+{
+    int i;
+
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )
+        counts[ i ] = x11.contention[ i ];
+}
+
 void sgui_internal_lock_mutex( void )
 {
-    pthread_mutex_lock( &x11.mutex );
+    sgui_internal_lock( SGUI_LOCK_GLOBAL );
 }
 
 void sgui_internal_unlock_mutex( void )
 {
-    pthread_mutex_unlock( &x11.mutex );
+    sgui_internal_unlock( SGUI_LOCK_GLOBAL );
+}
+
+int sgui_internal_atomic_cas( volatile unsigned int* ptr,
+                              unsigned int expected, unsigned int value )
+{
+    return __sync_bool_compare_and_swap( ptr, expected, value );
+}
+
+long sgui_internal_atomic_add( volatile long* ptr, long value )
+{
+    return __sync_add_and_fetch( ptr, value );
+}
+
+void sgui_internal_memory_barrier( void )
+{
+    __sync_synchronize( );
+}
+
+typedef struct
+{
+    pthread_t thread;
+    void (* function )( void* );
+    void* arg;
+}
+thread_start;
+
+static void* thread_trampoline( void* arg )
+{
+    thread_start* start = arg;
+
+    start->function( start->arg );
+    return NULL;
+}
+
+void* sgui_internal_thread_create( void(* function )( void* ), void* arg )
+{
+    thread_start* start = sgui_internal_malloc( sizeof(thread_start),
+                                                SGUI_ALLOC_OBJECT );
+
+    if( !start )
+        return NULL;
+
+    start->function = function;
+    start->arg = arg;
+
+    if( pthread_create( &start->thread, NULL, thread_trampoline, start ) )
+    {
+        sgui_internal_free( start, SGUI_ALLOC_OBJECT );
+        return NULL;
+    }
+
+    return start;
+}
+
+void sgui_internal_thread_join( void* thread )
+{
+    thread_start* start = thread;
+
+    pthread_join( start->thread, NULL );
+    sgui_internal_free( start, SGUI_ALLOC_OBJECT );
 }
 
+void* sgui_internal_semaphore_create( void )
+{
+    sem_t* sem = sgui_internal_malloc( sizeof(sem_t), SGUI_ALLOC_OBJECT );
+
+    if( sem && sem_init( sem, 0, 0 ) != 0 )
+    {
+        sgui_internal_free( sem, SGUI_ALLOC_OBJECT );
+        sem = NULL;
+    }
+
+    return sem;
+}
+
+void sgui_internal_semaphore_destroy( void* sem )
+{
+    sem_destroy( sem );
+    sgui_internal_free( sem, SGUI_ALLOC_OBJECT );
+}
+
+void sgui_internal_semaphore_post( void* sem )
+{
+    sem_post( sem );
+}
+
+void sgui_internal_semaphore_wait( void* sem )
+{
+    while( sem_wait( sem ) != 0 )
+        ;
+}
+
+void sgui_internal_wake_main_loop( void )
+{
+    char c = 0;
+
+    /*
+        The state is all zeros outside of sgui_init and sgui_deinit, so
+        the write end would be stdin. Only the first wake up since the
+        main loop last woke writes.
+     */
+    if( !x11.wake_open ||
+        !sgui_internal_atomic_cas( &x11.wake_pending, 0, 1 ) )
+        return;
+
+    if( write( x11.wake_pipe[1], &c, 1 ) < 0 )
+        x11.wake_pending = 0;
+}
+
+int sgui_internal_input_pending( void )
+{
+    int pending;
+
+    sgui_internal_lock_mutex( );
+    pending = XEventsQueued( x11.dpy, QueuedAfterReading ) > 0;
+    sgui_internal_unlock_mutex( );
+
+    return pending;
+}
+
+/****************************************************************************/
+
+static void drain_wake_pipe( int fd, int events, void* user )
+{
+    char buffer[ 64 ];
+    (void)events; (void)user;
+
+    x11.wake_pending = 0;
+    sgui_internal_memory_barrier( );
+
+    while( read( fd, buffer, sizeof(buffer) ) > 0 )
+        ;
+}
+
+static void drain_timer( int fd, int events, void* user )
+{
+    unsigned char expirations[ 8 ];
+    (void)events; (void)user;
+
+    while( read( fd, expirations, sizeof(expirations) ) > 0 )
+        ;
+}
+
+static void x11_readable( int fd, int events, void* user )
+{
+    /* X11 events are handled at the start of each main loop iteration */
+    (void)fd; (void)events; (void)user;
+}
+
+static int add_watch( fd_watch* w, int events )
+{
+    struct epoll_event ev;
+
+    memset( &ev, 0, sizeof(ev) );
+    ev.events = (events & SGUI_FD_READ ? EPOLLIN : 0) |
+                (events & SGUI_FD_WRITE ? EPOLLOUT : 0);
+    ev.data.ptr = w;
+
+    return epoll_ctl( x11.epoll_fd, EPOLL_CTL_ADD, w->fd, &ev ) == 0;
+}
+
+static int add_internal_watch( int i, int fd, sgui_fd_callback callback )
+{
+    x11.internal[ i ].fd = fd;
+    x11.internal[ i ].callback = callback;
+    return add_watch( x11.internal + i, SGUI_FD_READ );
+}
+
+/*
+    arm the timer fd, so the epoll fd is readable when a timer
+    expires or the next frame is due
+ */
+static void arm_timer( void )
+{
+    struct itimerspec its;
+    long timeout, frame;
+
+    memset( &its, 0, sizeof(its) );
+    timeout = sgui_internal_timer_timeout( );
+    frame = sgui_internal_frame_timeout( );
+
+    if( frame >= 0 && (timeout < 0 || frame < timeout) )
+        timeout = frame;
+
+    if( timeout >= 0 )
+    {
+        its.it_value.tv_sec = timeout / 1000;
+        its.it_value.tv_nsec = (timeout % 1000) * 1000000L;
+
+        /* a zero value would disarm the timer */
+        if( !timeout )
+            its.it_value.tv_nsec = 1;
+    }
+
+    timerfd_settime( x11.timer_fd, 0, &its, NULL );
+}
+
+/* wait for file descriptors and call the watcher callbacks */
+static void wait_fds( int timeout )
+{
+    struct epoll_event ev[ 16 ];
+    fd_watch *w, *prev, *next;
+    int i, count, events;
+
+    count = epoll_wait( x11.epoll_fd, ev, 16, timeout );
+
+    for( i=0; i<count; ++i )
+    {
+        w = ev[i].data.ptr;
+
+        if( w->removed )
+            continue;
+
+        events = (ev[i].events & EPOLLIN ? SGUI_FD_READ : 0) |
+                 (ev[i].events & EPOLLOUT ? SGUI_FD_WRITE : 0) |
+                 (ev[i].events & (EPOLLERR|EPOLLHUP) ? SGUI_FD_ERROR : 0);
+
+        w->callback( w->fd, events, w->user );
+    }
+
+    /* free watches that were removed, now that nothing points to them */
+    sgui_internal_lock_mutex( );
+
+    if( x11.watch_stale )
+    {
+        for( prev=NULL, w=x11.watches; w; w=next )
+        {
+            next = w->next;
+
+            if( w->removed )
+            {
+                if( prev )
+                    prev->next = next;
+                else
+                    x11.watches = next;
+
+                sgui_internal_free( w, SGUI_ALLOC_OBJECT );
+            }
+            else
+            {
+                prev = w;
+            }
+        }
+
+        x11.watch_stale = 0;
+    }
+
+    sgui_internal_unlock_mutex( );
+}
+
+int sgui_watch_fd( int fd, int events, sgui_fd_callback callback,
+                   void* user )
+{
+    struct epoll_event ev;
+    fd_watch* w;
+    int ret = 0;
+
+    if( fd < 0 || !callback )
+        return 0;
+
+    sgui_internal_lock_mutex( );
+
+    for( w=x11.watches; w; w=w->next )
+    {
+        if( w->fd == fd && !w->removed )
+            break;
+    }
+
+    if( w )
+    {
+        memset( &ev, 0, sizeof(ev) );
+        ev.events = (events & SGUI_FD_READ ? EPOLLIN : 0) |
+                    (events & SGUI_FD_WRITE ? EPOLLOUT : 0);
+        ev.data.ptr = w;
+
+        if( epoll_ctl( x11.epoll_fd, EPOLL_CTL_MOD, fd, &ev ) == 0 )
+        {
+            w->callback = callback;
+            w->user = user;
+            ret = 1;
+        }
+    }
+    else if( (w = sgui_internal_calloc( 1, sizeof(fd_watch),
+                                        SGUI_ALLOC_OBJECT )) )
+    {
+        w->fd = fd;
+        w->callback = callback;
+        w->user = user;
+
+        if( add_watch( w, events ) )
+        {
+            w->next = x11.watches;
+            x11.watches = w;
+            ret = 1;
+        }
+        else
+        {
+            sgui_internal_free( w, SGUI_ALLOC_OBJECT );
+        }
+    }
+
+    sgui_internal_unlock_mutex( );
+    return ret;
+}
+
+void sgui_unwatch_fd( int fd )
+{
+    fd_watch* w;
+
+    sgui_internal_lock_mutex( );
+
+    for( w=x11.watches; w; w=w->next )
+    {
+        if( w->fd == fd && !w->removed )
+        {
+            epoll_ctl( x11.epoll_fd, EPOLL_CTL_DEL, fd, NULL );
+            w->removed = 1;
+            x11.watch_stale = 1;
+            break;
+        }
+    }
+
+    sgui_internal_unlock_mutex( );
+}
+
+int sgui_get_loop_fd( void )
+{
+    return x11.epoll_fd;
+}
+
+/****************************************************************************/
+
 int sgui_init( void )
 {
     pthread_mutexattr_t attr;
+    int i;
 
     memset( &x11, 0, sizeof(x11) );
 
     pthread_mutexattr_init( &attr );
     pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
-    pthread_mutex_init( &x11.mutex, &attr );
+
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )
+        pthread_mutex_init( x11.locks + i, &attr );
+
+    /* self pipe, so threads posting events can wake up the main loop */
+    x11.wake_pipe[0] = x11.wake_pipe[1] = -1;
+    x11.epoll_fd = x11.timer_fd = -1;
+
+    if( pipe( x11.wake_pipe ) != 0 )
+    {
+        x11.wake_pipe[0] = x11.wake_pipe[1] = -1;
+        goto fail;
+    }
+
+    fcntl( x11.wake_pipe[0], F_SETFL, O_NONBLOCK );
+    fcntl( x11.wake_pipe[1], F_SETFL, O_NONBLOCK );
+    fcntl( x11.wake_pipe[0], F_SETFD, FD_CLOEXEC );
+    fcntl( x11.wake_pipe[1], F_SETFD, FD_CLOEXEC );
+    x11.wake_open = 1;
+
+    /* the main loop waits for everything through a single epoll fd */
+    x11.epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+    x11.timer_fd = timerfd_create( CLOCK_MONOTONIC,
+                                   TFD_NONBLOCK | TFD_CLOEXEC );
+
+    if( x11.epoll_fd < 0 || x11.timer_fd < 0 )
+        goto fail;
+
+    if( !add_internal_watch( 1, x11.wake_pipe[0], drain_wake_pipe ) ||
+        !add_internal_watch( 2, x11.timer_fd, drain_timer ) )
+    {
+        goto fail;
+    }
 
     if( !font_init( ) )
         goto fail;
@@ -437,6 +855,12 @@ int sgui_init( void )
 
     XSetErrorHandler( xlib_swallow_errors );
 
+    if( !add_internal_watch( 0, XConnectionNumber( x11.dpy ),
+                             x11_readable ) )
+    {
+        goto fail;
+    }
+
     /* create input method */
     if( !(x11.im = XOpenIM( x11.dpy, NULL, NULL, NULL )) )
         goto fail;
@@ -445,6 +869,9 @@ int sgui_init( void )
     sgui_skin_set( NULL );      /* initialise default GUI skin */
     sgui_event_reset( );        /* reset event system */
 
+    if( !sgui_internal_task_init( ) )
+        goto fail;
+
     x11.atom_wm_delete = XInternAtom( x11.dpy, "WM_DELETE_WINDOW", True );
     x11.atom_pty       = XInternAtom( x11.dpy, "SGUI_CLIP", False );
     x11.atom_targets   = XInternAtom( x11.dpy, "TARGETS", False );
@@ -462,10 +889,20 @@ fail:
 
 void sgui_deinit( void )
 {
+    fd_watch* w;
+    int i;
+
+    sgui_internal_task_deinit( );           /* stop worker threads */
     sgui_event_reset( );                    /* clear event queue */
+    sgui_internal_timer_reset( );           /* destroy all timers */
+    sgui_internal_frame_reset( );           /* reset frame clock */
+    sgui_internal_idle_reset( );            /* destroy all idle tasks */
     sgui_interal_skin_deinit_default( );    /* reset skinning system */
     font_deinit( );                         /* reset font system */
-    pthread_mutex_destroy( &x11.mutex );    /* destroy global mutex */
+    sgui_internal_pool_reset( );            /* free object pools */
+
+    for( i=0; i<SGUI_NUM_LOCKS; ++i )        /* destroy the locks */
+        pthread_mutex_destroy( x11.locks + i );
 
     if( x11.im )
         XCloseIM( x11.im );
@@ -473,7 +910,28 @@ void sgui_deinit( void )
     if( x11.dpy )
         XCloseDisplay( x11.dpy );
 
-    free( x11.clipboard_buffer );
+    x11.wake_open = 0;
+
+    if( x11.wake_pipe[0] >= 0 )
+        close( x11.wake_pipe[0] );
+
+    if( x11.wake_pipe[1] >= 0 )
+        close( x11.wake_pipe[1] );
+
+    if( x11.epoll_fd >= 0 )
+        close( x11.epoll_fd );
+
+    if( x11.timer_fd >= 0 )
+        close( x11.timer_fd );
+
+    while( x11.watches )
+    {
+        w = x11.watches;
+        x11.watches = w->next;
+        sgui_internal_free( w, SGUI_ALLOC_OBJECT );
+    }
+
+    sgui_internal_free( x11.clipboard_buffer, SGUI_ALLOC_BUFFER );
     memset( &x11, 0, sizeof(x11) );
 }
 
@@ -484,16 +942,22 @@ int sgui_main_loop_step( void )
     XFlush( x11.dpy );
     sgui_internal_unlock_mutex( );
 
+    wait_fds( 0 );
+    sgui_internal_timer_run( );
     sgui_event_process( );
 
+    if( sgui_internal_frame_run( ) )
+        redraw_windows( );
+
+    sgui_internal_idle_run( );
+    arm_timer( );
+
     return have_active_windows( ) || sgui_event_queued( );
 }
 
 void sgui_main_loop( void )
 {
-    int x11_fd = XConnectionNumber( x11.dpy );
-    struct timeval tv;
-    fd_set in_fds;
+    int timeout;
 
     while( have_active_windows( ) )
     {
@@ -502,15 +966,36 @@ void sgui_main_loop( void )
         XFlush( x11.dpy );
         sgui_internal_unlock_mutex( );
 
+        sgui_internal_timer_run( );
         sgui_event_process( );
 
-        /* wait for X11 events, one second time out */
-        FD_ZERO( &in_fds );
-        FD_SET( x11_fd, &in_fds );
+        /* damaged areas are collected and redrawn once per frame */
+        if( sgui_internal_frame_run( ) )
+            redraw_windows( );
+
+        /* idle tasks get what is left, but must not let the loop sleep */
+        sgui_internal_idle_run( );
+
+        /*
+            Timer, event, frame and idle callbacks that talk to the server
+            may have made Xlib read events into its queue behind our back.
+            The connection does not become readable for those, so check
+            right before sleeping, which also flushes their requests.
+         */
+        sgui_internal_lock_mutex( );
+        timeout = XEventsQueued( x11.dpy, QueuedAfterFlush ) ? 0 : -1;
+        sgui_internal_unlock_mutex( );
+
+        if( sgui_internal_idle_pending( ) )
+            timeout = 0;
 
-        tv.tv_usec = 0;
-        tv.tv_sec = 1;
-        select( x11_fd+1, &in_fds, 0, 0, &tv );
+        /*
+            Sleep until the X11 connection, the wake up pipe, an application
+            file descriptor or the timer fd armed to the next deadline or
+            frame becomes readable.
+         */
+        arm_timer( );
+        wait_fds( timeout );
     }
 
     while( sgui_event_queued( ) )
@@ -27,8 +27,10 @@
 
 
 
+#include "sgui_internal.h"
 #include "sgui_skin.h"
 #include "sgui_rect.h"
+#include "sgui_loop.h"
 
 #include "opengl.h"
 #include "window.h"
@@ -53,6 +55,17 @@
 
 #define DOUBLE_CLICK_MS 750
 
+/* a file descriptor registered with the epoll instance of the main loop */
+typedef struct fd_watch
+{
+    int fd;
+    sgui_fd_callback callback;
+    void* user;
+    int removed;                    /* unwatched, free after dispatching */
+    struct fd_watch* next;
+}
+fd_watch;
+
 extern struct x11_state
 {
     XIM im;                         /* X11 input method */
@@ -75,7 +88,18 @@ extern struct x11_state
     sgui_window_xlib* clicked;      /* last window clicked for double click */
     unsigned long click_time;       /* last click time for double click */
 
-    pthread_mutex_t mutex;          /* global mutex */
+    pthread_mutex_t locks[ SGUI_NUM_LOCKS ];    /* see SGUI_LOCK */
+    volatile unsigned long contention[ SGUI_NUM_LOCKS ];
+
+    int wake_pipe[2];               /* self pipe to wake up the main loop */
+    int wake_open;                  /* non-zero while the pipe is open */
+    volatile unsigned int wake_pending; /* non-zero if pipe is written to */
+
+    int epoll_fd;                   /* waited for by the main loop */
+    int timer_fd;                   /* armed to the next timer deadline */
+    fd_watch internal[3];           /* X11 connection, wake pipe, timer */
+    fd_watch* watches;              /* file descriptors of the application */
+    int watch_stale;                /* non-zero if a watch was removed */
 
     sgui_window_xlib* list;         /* internal list of Xlib windows */
 }
@@ -79,11 +79,14 @@ static void xlib_window_set_visible( sgui_window* this, int visible )
     sgui_internal_unlock_mutex( );
 }
 
+/*
+    Requests that only touch the X window itself don't need the global
+    mutex. XInitThreads makes Xlib lock the display connection on its own.
+ */
 static void xlib_window_set_title( sgui_window* this, const char* title )
 {
-    sgui_internal_lock_mutex( );
     XStoreName( x11.dpy, TO_X11(this)->wnd, title );
-    sgui_internal_unlock_mutex( );
+    XFlush( x11.dpy );
 }
 
 static void xlib_window_set_size( sgui_window* this,
@@ -138,9 +141,8 @@ static void xlib_window_force_redraw( sgui_window* this, sgui_rect* r )
     exp.width      = SGUI_RECT_WIDTH_V(r);
     exp.height     = SGUI_RECT_HEIGHT_V(r);
 
-    sgui_internal_lock_mutex( );
     XSendEvent(x11.dpy,TO_X11(this)->wnd,False,ExposureMask,(XEvent*)&exp);
-    sgui_internal_unlock_mutex( );
+    XFlush( x11.dpy );
 }
 
 static void xlib_window_destroy( sgui_window* this )
@@ -157,7 +159,7 @@ static void xlib_window_destroy( sgui_window* this )
     XDestroyWindow( x11.dpy, TO_X11(this)->wnd );
     sgui_internal_unlock_mutex( );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void xlib_window_get_platform_data( const sgui_window* this,
@@ -339,7 +341,7 @@ void handle_window_events( sgui_window_xlib* this, XEvent* e )
             sgui_rect r;
             sgui_rect_set_size( &r, e->xexpose.x, e->xexpose.y,
                                     e->xexpose.width, e->xexpose.height );
-            sgui_canvas_redraw_area( super->ctx.canvas, &r, 1 );
+            sgui_internal_canvas_add_dirty_rect( super->ctx.canvas, &r );
         }
         else
         {
@@ -348,6 +350,17 @@ void handle_window_events( sgui_window_xlib* this, XEvent* e )
             sgui_internal_window_fire_event( super, &se );
         }
         break;
+    case GraphicsExpose:        /* canvas scrolled in obscured area */
+        if( super->backend==SGUI_NATIVE )
+        {
+            sgui_rect r;
+            sgui_rect_set_size( &r, e->xgraphicsexpose.x,
+                                    e->xgraphicsexpose.y,
+                                    e->xgraphicsexpose.width,
+                                    e->xgraphicsexpose.height );
+            sgui_internal_canvas_add_dirty_rect( super->ctx.canvas, &r );
+        }
+        break;
     case FocusIn:
         se.type = SGUI_FOCUS_EVENT;
         sgui_internal_window_fire_event( super, &se );
@@ -376,7 +389,8 @@ sgui_window* sgui_window_create_desc( const sgui_window_description* desc )
     if( desc->flags & (~SGUI_ALL_WINDOW_FLAGS) )
         return NULL;
 
-    this = calloc( 1, sizeof(sgui_window_xlib) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_window_xlib),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_window*)this;
 
     if( !this )
@@ -466,7 +480,7 @@ sgui_window* sgui_window_create_desc( const sgui_window_description* desc )
     /* failure cleanup */
 failcv: XDestroyIC( this->ic );
 failic: XDestroyWindow( x11.dpy, this->wnd );
-fail:   free( this );
+fail:   sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     sgui_internal_unlock_mutex( );
     return NULL;
 }
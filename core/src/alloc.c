@@ -0,0 +1,494 @@
+/*
+ * alloc.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+#define HINT( hint ) ((hint) & 0x0F)
+#define CATEGORY( hint ) ((hint) >> 4)
+
+/* hash of a pixel block address, the low bits are zero due to alignment */
+#define PTR_HASH( ptr ) ((size_t)(ptr) >> 4)
+
+
+
+/*
+    Stored in front of object and buffer blocks, so freeing knows what to
+    account. Pixel blocks are handed out exactly as the allocator returned
+    them, so page or huge page alignment is kept, and use the table below.
+ */
+typedef union
+{
+    struct
+    {
+        size_t size;
+        unsigned short hint;
+        unsigned short category;
+    }
+    info;
+
+    long l;
+    void* p;
+#ifndef SGUI_NO_FLOAT
+    double d;
+#endif
+}
+header;
+
+/* entry of the side table for pixel blocks */
+typedef struct
+{
+    void* ptr;
+    size_t size;
+    int category;
+}
+pixel_block;
+
+typedef struct
+{
+    volatile long bytes;
+    volatile long objects;
+    long peak_bytes;
+    long peak_objects;
+}
+counter;
+
+
+
+static void* std_alloc( void* user, size_t size, int hint )
+{
+    (void)user; (void)hint;
+    return malloc( size );
+}
+
+static void* std_resize( void* user, void* ptr, size_t size, int hint )
+{
+    (void)user; (void)hint;
+    return realloc( ptr, size );
+}
+
+static void std_release( void* user, void* ptr, int hint )
+{
+    (void)user; (void)hint;
+    free( ptr );
+}
+
+static sgui_allocator allocator = { std_alloc, std_resize, std_release, NULL };
+
+static counter counters[ SGUI_NUM_MEMORY_CATEGORIES ];
+
+/* open addressing hash table of pixel blocks, protected by the pool lock */
+static pixel_block* pixel_table = NULL;
+static unsigned long pixel_table_size = 0;   /* power of two */
+static unsigned long num_pixel_blocks = 0;
+static unsigned long num_reserved = 0;      /* entries held for adding */
+
+
+
+static void account_block( header* h, int sign )
+{
+    sgui_internal_memory_account( h->info.category,
+                                  sign * (long)h->info.size,
+                                  h->info.hint==SGUI_ALLOC_OBJECT ? sign : 0 );
+}
+
+/* called with the pool lock held */
+static pixel_block* find_pixels( void* ptr )
+{
+    unsigned long i, mask = pixel_table_size - 1;
+
+    if( !pixel_table )
+        return NULL;
+
+    for( i=PTR_HASH( ptr ) & mask; pixel_table[i].ptr; i=(i+1) & mask )
+    {
+        if( pixel_table[i].ptr == ptr )
+            return pixel_table + i;
+    }
+
+    return NULL;
+}
+
+/* called with the pool lock held, moves all entries to a bigger table */
+static void rehash_pixels( pixel_block* new_table, unsigned long new_size )
+{
+    unsigned long i, j;
+
+    for( i=0; i<pixel_table_size; ++i )
+    {
+        if( !pixel_table[i].ptr )
+            continue;
+
+        j = PTR_HASH( pixel_table[i].ptr ) & (new_size - 1);
+
+        while( new_table[j].ptr )
+            j = (j + 1) & (new_size - 1);
+
+        new_table[j] = pixel_table[i];
+    }
+}
+
+/*
+    Reserves an entry for a pixel block that is about to be allocated,
+    keeping the table at most half full. Returns zero if out of memory.
+    The table is grown without holding the pool lock, so another thread
+    may have grown it in the mean time, in which case the new one is
+    thrown away.
+ */
+static int reserve_pixels( void )
+{
+    pixel_block *new_table, *old_table;
+    unsigned long new_size;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    while( 2*(num_pixel_blocks + num_reserved + 1) > pixel_table_size )
+    {
+        new_size = pixel_table_size ? pixel_table_size*2 : 64;
+        sgui_internal_unlock( SGUI_LOCK_POOL );
+
+        new_table = sgui_internal_calloc( new_size, sizeof(pixel_block),
+                                          SGUI_ALLOC_BUFFER );
+
+        if( !new_table )
+            return 0;
+
+        sgui_internal_lock( SGUI_LOCK_POOL );
+        old_table = new_table;
+
+        if( new_size > pixel_table_size )
+        {
+            rehash_pixels( new_table, new_size );
+            old_table = pixel_table;
+            pixel_table = new_table;
+            pixel_table_size = new_size;
+        }
+
+        sgui_internal_unlock( SGUI_LOCK_POOL );
+        sgui_internal_free( old_table, SGUI_ALLOC_BUFFER );
+        sgui_internal_lock( SGUI_LOCK_POOL );
+    }
+
+    ++num_reserved;
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+    return 1;
+}
+
+/*
+    Called with the pool lock held. Takes the table away if it is no
+    longer used, so the caller can free it after unlocking.
+ */
+static pixel_block* detach_pixels( void )
+{
+    pixel_block* table = NULL;
+
+    if( !num_pixel_blocks && !num_reserved )
+    {
+        table = pixel_table;
+        pixel_table = NULL;
+        pixel_table_size = 0;
+    }
+
+    return table;
+}
+
+/* called with the pool lock held, fills an entry reserved before */
+static void add_pixels( void* ptr, size_t size, int category )
+{
+    unsigned long i, mask = pixel_table_size - 1;
+
+    for( i=PTR_HASH( ptr ) & mask; pixel_table[i].ptr; i=(i+1) & mask );
+
+    pixel_table[i].ptr = ptr;
+    pixel_table[i].size = size;
+    pixel_table[i].category = category;
+    ++num_pixel_blocks;
+    --num_reserved;
+}
+
+/*
+    Called with the pool lock held. Moves the following entries of the
+    same probe sequence back, so lookups don't stop at the gap.
+ */
+static void remove_pixels( pixel_block* b )
+{
+    unsigned long i, j, home, mask = pixel_table_size - 1;
+
+    i = b - pixel_table;
+    pixel_table[i].ptr = NULL;
+    --num_pixel_blocks;
+
+    for( j=(i+1) & mask; pixel_table[j].ptr; j=(j+1) & mask )
+    {
+        home = PTR_HASH( pixel_table[j].ptr ) & mask;
+
+        /* the entry must stay if its home lies in (i, j] */
+        if( i<=j ? (i<home && home<=j) : (i<home || home<=j) )
+            continue;
+
+        pixel_table[i] = pixel_table[j];
+        pixel_table[j].ptr = NULL;
+        i = j;
+    }
+}
+
+/*
+    The allocator is called without holding the pool lock. A block is
+    removed from the table before it is given back to the allocator and
+    added after the allocator returned it, so an address that another
+    thread gets in the mean time cannot show up twice in the table.
+ */
+static void* alloc_pixels( size_t size, int category )
+{
+    pixel_block* table;
+    void* ptr;
+
+    if( !reserve_pixels( ) )
+        return NULL;
+
+    ptr = allocator.alloc( allocator.user, size, SGUI_ALLOC_PIXELS );
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    if( ptr )
+    {
+        add_pixels( ptr, size, category );
+        table = NULL;
+    }
+    else
+    {
+        --num_reserved;
+        table = detach_pixels( );
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+
+    sgui_internal_free( table, SGUI_ALLOC_BUFFER );
+
+    if( ptr )
+        sgui_internal_memory_account( category, (long)size, 0 );
+
+    return ptr;
+}
+
+static void* resize_pixels( void* ptr, size_t size )
+{
+    pixel_block* b;
+    size_t old_size;
+    int category;
+    void* new;
+
+    /* the entry is kept reserved, so adding either block cannot fail */
+    sgui_internal_lock( SGUI_LOCK_POOL );
+    b = find_pixels( ptr );
+    old_size = b->size;
+    category = b->category;
+    remove_pixels( b );
+    ++num_reserved;
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+
+    new = allocator.resize( allocator.user, ptr, size, SGUI_ALLOC_PIXELS );
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    if( new )
+        add_pixels( new, size, category );
+    else
+        add_pixels( ptr, old_size, category );
+
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+
+    if( new )
+        sgui_internal_memory_account( category,
+                                      (long)size - (long)old_size, 0 );
+
+    return new;
+}
+
+static void free_pixels( void* ptr )
+{
+    pixel_block *b, *table;
+    size_t size;
+    int category;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+    b = find_pixels( ptr );
+    size = b->size;
+    category = b->category;
+    remove_pixels( b );
+    table = detach_pixels( );
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+
+    allocator.release( allocator.user, ptr, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( table, SGUI_ALLOC_BUFFER );
+
+    sgui_internal_memory_account( category, -(long)size, 0 );
+}
+
+/****************************************************************************/
+
+void sgui_set_allocator( const sgui_allocator* a )
+{
+    if( a )
+    {
+        allocator = *a;
+    }
+    else
+    {
+        allocator.alloc = std_alloc;
+        allocator.resize = std_resize;
+        allocator.release = std_release;
+        allocator.user = NULL;
+    }
+}
+
+void sgui_get_memory_stats( sgui_memory_stats* stats )
+{
+    int i;
+
+    for( i=0; i<SGUI_NUM_MEMORY_CATEGORIES; ++i )
+    {
+        stats[i].bytes = counters[i].bytes;
+        stats[i].objects = counters[i].objects;
+        stats[i].peak_bytes = counters[i].peak_bytes;
+        stats[i].peak_objects = counters[i].peak_objects;
+    }
+}
+
+/****************************************************************************/
+
+void sgui_internal_memory_account( int category, long bytes, long objects )
+{
+    counter* c = counters + category;
+    long now;
+
+    /* counters are updated atomically, the peaks are best effort */
+    if( bytes )
+    {
+        now = sgui_internal_atomic_add( &c->bytes, bytes );
+
+        if( now > c->peak_bytes )
+            c->peak_bytes = now;
+    }
+
+    if( objects )
+    {
+        now = sgui_internal_atomic_add( &c->objects, objects );
+
+        if( now > c->peak_objects )
+            c->peak_objects = now;
+    }
+}
+
+void* sgui_internal_malloc( size_t size, int hint )
+{
+    header* h;
+
+    if( HINT(hint) == SGUI_ALLOC_PIXELS )
+        return alloc_pixels( size, CATEGORY(hint) );
+
+    h = allocator.alloc( allocator.user, sizeof(header) + size, HINT(hint) );
+
+    if( !h )
+        return NULL;
+
+    h->info.size = size;
+    h->info.hint = HINT(hint);
+    h->info.category = CATEGORY(hint);
+    account_block( h, 1 );
+    return h + 1;
+}
+
+void* sgui_internal_calloc( size_t count, size_t size, int hint )
+{
+    void* ptr;
+
+    if( size && count > ((size_t)-1 - sizeof(header)) / size )
+        return NULL;
+
+    if( (ptr = sgui_internal_malloc( count * size, hint )) )
+        memset( ptr, 0, count * size );
+
+    return ptr;
+}
+
+void* sgui_internal_realloc( void* ptr, size_t size, int hint )
+{
+    header *h, *new;
+
+    if( !ptr )
+        return sgui_internal_malloc( size, hint );
+
+    if( HINT(hint) == SGUI_ALLOC_PIXELS )
+        return resize_pixels( ptr, size );
+
+    h = (header*)ptr - 1;
+    new = allocator.resize( allocator.user, h, sizeof(header) + size,
+                            HINT(hint) );
+
+    if( !new )
+        return NULL;
+
+    sgui_internal_memory_account( new->info.category,
+                                  (long)size - (long)new->info.size, 0 );
+    new->info.size = size;
+    return new + 1;
+}
+
+void sgui_internal_free( void* ptr, int hint )
+{
+    header* h;
+
+    if( !ptr )
+        return;
+
+    if( HINT(hint) == SGUI_ALLOC_PIXELS )
+    {
+        free_pixels( ptr );
+        return;
+    }
+
+    h = (header*)ptr - 1;
+    account_block( h, -1 );
+    allocator.release( allocator.user, h, HINT(hint) );
+}
+
+char* sgui_internal_strdup( const char* str, int category )
+{
+    size_t len = strlen( str ) + 1;
+    char* copy;
+
+    copy = sgui_internal_malloc( len, (category << 4) | SGUI_ALLOC_BUFFER );
+
+    if( copy )
+        memcpy( copy, str, len );
+
+    return copy;
+}
@@ -45,7 +45,8 @@ static void mark_focus_area_dirty( sgui_canvas* this, sgui_widget* w )
 
     sgui_widget_get_absolute_rect( w, &r );
     sgui_rect_extend( &r, fbw, fbw );
-    sgui_canvas_add_dirty_rect( this, &r );
+    sgui_internal_layer_damage( w, &r );
+    sgui_internal_canvas_add_dirty_rect( this, &r );
 }
 
 static void redirect_mouse_event( sgui_widget* w, const sgui_event* e )
@@ -65,7 +66,9 @@ static void redirect_mouse_event( sgui_widget* w, const sgui_event* e )
 int sgui_canvas_init( sgui_canvas* this, unsigned int width,
                       unsigned int height )
 {
-    this->dirty = calloc( SGUI_CANVAS_MAX_DIRTY, sizeof(sgui_rect) );
+    this->dirty = sgui_internal_pool_alloc( SGUI_POOL_DIRTY,
+                                            SGUI_CANVAS_MAX_DIRTY *
+                                            sizeof(sgui_rect) );
 
     if( !this->dirty )
         return 0;
@@ -76,6 +79,7 @@ int sgui_canvas_init( sgui_canvas* this, unsigned int width,
     sgui_rect_set_size( &this->root.area, 0, 0, width, height );
     this->root.flags = SGUI_WIDGET_VISIBLE;
     this->root.canvas = this;
+    this->layer_limit = SGUI_CANVAS_LAYER_LIMIT;
     return 1;
 }
 
@@ -116,7 +120,18 @@ void sgui_canvas_set_focus( sgui_canvas* this, sgui_widget* widget )
     sgui_internal_unlock_mutex( );
 }
 
-void sgui_canvas_add_dirty_rect( sgui_canvas* this, sgui_rect* r )
+void sgui_canvas_capture_pointer( sgui_canvas* this, sgui_widget* widget )
+{
+    sgui_internal_lock_mutex( );
+    this->capture = widget;
+
+    if( widget )
+        this->mouse_over = widget;
+    sgui_internal_unlock_mutex( );
+}
+
+void sgui_internal_canvas_add_dirty_rect( sgui_canvas* this,
+                                          const sgui_rect* r )
 {
     unsigned int i;
     sgui_rect r0;
@@ -150,6 +165,20 @@ void sgui_canvas_add_dirty_rect( sgui_canvas* this, sgui_rect* r )
     this->dirty[ this->num_dirty++ ] = r0;
 out:
     sgui_internal_unlock_mutex( );
+
+    /* the main loop redraws dirty areas once per frame */
+    sgui_internal_frame_request( );
+}
+
+void sgui_canvas_add_dirty_rect( sgui_canvas* this, sgui_rect* r )
+{
+    sgui_internal_lock_mutex( );
+
+    /* we don't know which widget changed, so all layers there are redone */
+    sgui_internal_layer_invalidate( this, r );
+    sgui_internal_canvas_add_dirty_rect( this, r );
+
+    sgui_internal_unlock_mutex( );
 }
 
 void sgui_canvas_get_dirty_rect( const sgui_canvas* this, sgui_rect* rect,
@@ -170,20 +199,115 @@ void sgui_canvas_clear_dirty_rects( sgui_canvas* this )
     sgui_internal_unlock_mutex( );
 }
 
+/* move the pixels of the scroll steps since the last redraw */
+static void flush_scroll( sgui_canvas* this )
+{
+    int dx = this->scroll_dx, dy = this->scroll_dy;
+
+    if( !dx && !dy )
+        return;
+
+    this->scroll_dx = this->scroll_dy = 0;
+
+    if( !this->scroll( this, &this->scroll_area, dx, dy ) )
+        sgui_internal_canvas_add_dirty_rect( this, &this->scroll_area );
+}
+
+void sgui_canvas_scroll_area( sgui_canvas* this, const sgui_rect* r,
+                              int dx, int dy )
+{
+    unsigned int i, count;
+    sgui_rect r0, r1;
+
+    sgui_internal_lock_mutex( );
+
+    sgui_rect_set_size( &r0, 0, 0, this->width, this->height );
+    if( !sgui_rect_get_intersection( &r0, &r0, r ) || (!dx && !dy) )
+        goto out;
+
+    if( !this->scroll )
+        goto fail;
+
+    /* only one area can have a pending move */
+    if( (this->scroll_dx || this->scroll_dy) &&
+        memcmp( &this->scroll_area, &r0, sizeof(r0) ) )
+    {
+        flush_scroll( this );
+    }
+
+    if( abs(this->scroll_dx+dx)>=SGUI_RECT_WIDTH(r0) ||
+        abs(this->scroll_dy+dy)>=SGUI_RECT_HEIGHT(r0) )
+    {
+        this->scroll_dx = this->scroll_dy = 0;
+        goto fail;
+    }
+
+    /* move pending dirty rects inside the area along with the pixels */
+    for( i=0, count=this->num_dirty; i<count; ++i )
+    {
+        if( sgui_rect_get_intersection( &r1, this->dirty + i, &r0 ) )
+        {
+            sgui_rect_add_offset( &r1, dx, dy );
+
+            if( sgui_rect_get_intersection( &r1, &r1, &r0 ) )
+                sgui_internal_canvas_add_dirty_rect( this, &r1 );
+        }
+    }
+
+    this->scroll_area = r0;
+    this->scroll_dx += dx;
+    this->scroll_dy += dy;
+
+    /* add the uncovered strips */
+    if( dy )
+    {
+        r1 = r0;
+        if( dy>0 ) r1.bottom = r1.top + dy - 1;
+        else       r1.top = r1.bottom + dy + 1;
+        sgui_internal_canvas_add_dirty_rect( this, &r1 );
+    }
+
+    if( dx )
+    {
+        r1 = r0;
+        if( dx>0 ) r1.right = r1.left + dx - 1;
+        else       r1.left = r1.right + dx + 1;
+        sgui_internal_canvas_add_dirty_rect( this, &r1 );
+    }
+out:
+    sgui_internal_unlock_mutex( );
+    return;
+fail:
+    sgui_internal_canvas_add_dirty_rect( this, &r0 );
+    sgui_internal_unlock_mutex( );
+}
+
+void sgui_canvas_set_layer_limit( sgui_canvas* this, unsigned long limit )
+{
+    sgui_internal_lock_mutex( );
+    this->layer_limit = limit;
+    sgui_internal_unlock_mutex( );
+}
+
 void sgui_canvas_redraw_widgets( sgui_canvas* this, int clear )
 {
     unsigned int i;
 
     sgui_internal_lock_mutex( );
 
+    flush_scroll( this );
+
     for( i=0; i<this->num_dirty; ++i )
     {
         sgui_canvas_begin( this, this->dirty + i );
 
-        if( clear )
+        if( clear && !sgui_internal_widget_covers( &this->root,
+                                                   this->dirty + i ) )
+        {
             this->clear( this, this->dirty + i );
+        }
 
-        if( this->root.children )
+        if( this->root.num_children )
         {
             sgui_widget_draw( &this->root, this->dirty + i,
                               (this->flags & SGUI_CANVAS_DRAW_FOCUS) ?
@@ -208,13 +332,14 @@ void sgui_canvas_redraw_area(sgui_canvas* this, const sgui_rect* r, int clear)
     if( r && !sgui_rect_get_intersection( &r1, &r1, r ) )
         goto done;
 
+    flush_scroll( this );
     sgui_canvas_begin( this, NULL );
     this->num_dirty = 0;
 
-    if( clear )
+    if( clear && !sgui_internal_widget_covers( &this->root, &r1 ) )
         this->clear( this, &r1 );
 
-    if( this->root.children )
+    if( this->root.num_children )
     {
         sgui_widget_draw( &this->root, &r1,
                           (this->flags & SGUI_CANVAS_DRAW_FOCUS) ?
@@ -233,10 +358,11 @@ void sgui_canvas_send_window_event( sgui_canvas* this, const sgui_event* e )
 
     sgui_internal_lock_mutex( );
 
-    if( !this->root.children )
+    if( !this->root.num_children )
         goto out;
 
-    if( e->type==SGUI_MOUSE_MOVE_EVENT || e->type==SGUI_DOUBLE_CLICK_EVENT )
+    if( (e->type==SGUI_MOUSE_MOVE_EVENT ||
+         e->type==SGUI_DOUBLE_CLICK_EVENT) && !this->capture )
     {
         i = sgui_widget_get_child_from_point( &this->root,
                                               e->arg.i2.x, e->arg.i2.y );
@@ -269,6 +395,12 @@ void sgui_canvas_send_window_event( sgui_canvas* this, const sgui_event* e )
         break;
     case SGUI_MOUSE_PRESS_EVENT:
     case SGUI_MOUSE_RELEASE_EVENT:
+        if( this->capture )
+        {
+            redirect_mouse_event( this->capture, e );
+            break;
+        }
+
         if( this->mouse_over )
             redirect_mouse_event( this->mouse_over, e );
 
@@ -280,7 +412,9 @@ void sgui_canvas_send_window_event( sgui_canvas* this, const sgui_event* e )
         break;
     case SGUI_MOUSE_MOVE_EVENT:
     case SGUI_DOUBLE_CLICK_EVENT:
-        if( this->mouse_over )
+        if( this->capture )
+            redirect_mouse_event( this->capture, e );
+        else if( this->mouse_over )
             redirect_mouse_event( this->mouse_over, e );
         break;
     case SGUI_MOUSE_WHEEL_EVENT:
@@ -320,12 +454,21 @@ out:
 
 void sgui_canvas_destroy( sgui_canvas* this )
 {
-    sgui_widget* i;
+    sgui_internal_lock_mutex( );
+
+    while( this->root.num_children )
+        sgui_widget_remove_from_parent( this->root.children[0] );
 
-    for( i=this->root.children; i!=NULL; i=i->next )
-        sgui_widget_remove_from_parent( i );
+    sgui_internal_free( this->root.children, SGUI_ALLOC_BUFFER );
 
-    free( this->dirty );
+    sgui_internal_layer_destroy_all( this );
+
+    while( this->num_pooled )
+        sgui_pixmap_destroy( this->pixmap_pool[ --this->num_pooled ] );
+
+    sgui_internal_unlock_mutex( );
+
+    sgui_internal_pool_free( SGUI_POOL_DIRTY, this->dirty );
 
     this->destroy( this );
 }
@@ -344,6 +487,13 @@ void sgui_canvas_resize( sgui_canvas* this, unsigned int width,
 
         sgui_rect_set_size( &this->root.area, 0, 0, width, height );
 
+        /* the scrolled area may not fit anymore, redraw it instead */
+        if( this->scroll_dx || this->scroll_dy )
+        {
+            this->scroll_dx = this->scroll_dy = 0;
+            sgui_internal_canvas_add_dirty_rect( this, &this->scroll_area );
+        }
+
         sgui_internal_unlock_mutex( );
     }
 }
@@ -352,10 +502,71 @@ sgui_pixmap* sgui_canvas_create_pixmap( sgui_canvas* this,
                                         unsigned int width,
                                         unsigned int height, int format )
 {
+    sgui_pixmap *pixmap = NULL, *p;
+    unsigned int i;
+
     if( !width || !height )
         return NULL;
 
-    return this->create_pixmap( this, width, height, format );
+    sgui_internal_lock_mutex( );
+
+    /* pixmap sizes double as scan line lengths, only reuse exact matches */
+    for( i=0; i<this->num_pooled; ++i )
+    {
+        p = this->pixmap_pool[i];
+
+        if( p->width==width && p->height==height && p->format==format )
+        {
+            pixmap = p;
+            --this->num_pooled;
+            memmove( this->pixmap_pool + i, this->pixmap_pool + i + 1,
+                     (this->num_pooled - i) * sizeof(sgui_pixmap*) );
+            break;
+        }
+    }
+
+    if( !pixmap )
+    {
+        pixmap = this->create_pixmap( this, width, height, format );
+
+        if( pixmap )
+            pixmap->format = format;
+    }
+
+    sgui_internal_unlock_mutex( );
+    return pixmap;
+}
+
+void sgui_canvas_release_pixmap( sgui_canvas* this, sgui_pixmap* pixmap )
+{
+    if( !pixmap )
+        return;
+
+    sgui_internal_lock_mutex( );
+
+    if( this->num_pooled == SGUI_CANVAS_PIXMAP_POOL )
+    {
+        sgui_pixmap_destroy( this->pixmap_pool[0] );
+        --this->num_pooled;
+        memmove( this->pixmap_pool, this->pixmap_pool + 1,
+                 this->num_pooled * sizeof(sgui_pixmap*) );
+    }
+
+    this->pixmap_pool[ this->num_pooled++ ] = pixmap;
+    sgui_internal_unlock_mutex( );
+}
+
+int sgui_canvas_adopt_pixmap( sgui_canvas* this, sgui_pixmap* pixmap )
+{
+    int ret;
+
+    if( !this->adopt_pixmap )
+        return 0;
+
+    sgui_internal_lock_mutex( );
+    ret = this->adopt_pixmap( this, pixmap );
+    sgui_internal_unlock_mutex( );
+    return ret;
 }
 
 void sgui_canvas_set_scissor_rect( sgui_canvas* this, const sgui_rect* r )
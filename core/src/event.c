@@ -30,9 +30,15 @@
 #include <stddef.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 
+struct listener;
+
+typedef void (* listener_thunk )( const struct listener* l,
+                                  const sgui_event* e );
+
 typedef struct listener
 {
     int event;                  /* event to listen for */
@@ -40,6 +46,7 @@ typedef struct listener
 
     void* receiver;             /* receiver */
     sgui_function callback;
+    listener_thunk thunk;       /* calls callback with the right arguments */
 
     int type;                   /* type of function argument */
 
@@ -58,19 +65,341 @@ typedef struct listener
     }
     value;
 
-    struct listener* next;      /* linked list pointer */
+    struct listener* next;      /* next listener in the same bucket */
 }
 listener;
 
 
 
+/* number of slots for counting listeners per event type, power of two */
+#define TYPE_SLOTS 512
+
+#define TYPE_SLOT( type ) ((unsigned int)(type) & (TYPE_SLOTS - 1))
+
+#define RING_MASK (SGUI_EVENT_RING_SIZE - 1)
+
+/* how far back to look for an event that a new one can be merged into */
+#define COALESCE_WINDOW 64
+
+/* listeners an event can have before the snapshot goes to scratch memory */
+#define SNAPSHOT_SIZE 32
+
+/* sources with waiting events before input stops going first altogether */
+#define MAX_HELD 32
+
+
+
+/*
+    Slot of the lock-free event ring. The slot for position pos is free if
+    seq equals pos and holds a posted event if seq equals pos + 1.
+ */
+typedef struct
+{
+    volatile unsigned int seq;
+    sgui_event event;
+}
+ring_slot;
+
+
+
+/* bounded ring that any thread can post to without taking a lock */
+static ring_slot ring[ SGUI_EVENT_RING_SIZE ];
+static volatile unsigned int ring_head = 0; /* next position to post to */
+static unsigned int ring_tail = 0;          /* next position to process */
+
+/* overflow queue used while the ring is full, protected by the event lock */
 static sgui_event* queue = NULL;
-static int queue_top = 0;
+static volatile int queue_top = 0;
 static int queue_size = 0;
-static listener* listeners = NULL;
+
+/* events gathered for the current processing cycle, after merging */
+static sgui_event* batch = NULL;
+static int batch_size = 0;
+static int num_deferred = 0;    /* left over at the start of the batch */
+
+static listener** table = NULL;     /* listeners hashed by event & sender */
+static unsigned int table_size = 0; /* number of buckets, power of two */
+static unsigned int num_listeners = 0;
+static unsigned int type_count[ TYPE_SLOTS ];  /* listeners per type slot */
+static int dispatching = 0;         /* listeners may be in a snapshot */
+static int stale = 0;               /* disconnected while dispatching */
 
 
 
+static unsigned int hash( int event, const void* sender )
+{
+    unsigned long h = (unsigned long)((size_t)sender >> 3);
+
+    h = h * 31 + (unsigned int)event;
+    h ^= h >> 11;
+
+    return (unsigned int)h & (table_size - 1);
+}
+
+static int grow_table( void )
+{
+    unsigned int i, old_size = table_size;
+    listener** old = table;
+    listener *l, *next, *rev;
+    listener** new;
+
+    new = sgui_internal_calloc( old_size ? old_size*2 : 64, sizeof(listener*),
+                                SGUI_MEM(EVENTS,BUFFER) );
+
+    if( !new )
+        return 0;
+
+    table = new;
+    table_size = old_size ? old_size*2 : 64;
+
+    for( i=0; i<old_size; ++i )
+    {
+        /* reverse the chain, so the order is kept when reinserting */
+        for( rev=NULL, l=old[i]; l; l=next )
+        {
+            next = l->next;
+            l->next = rev;
+            rev = l;
+        }
+
+        for( l=rev; l; l=next )
+        {
+            next = l->next;
+            SGUI_ADD_TO_LIST( table[ hash( l->event, l->sender ) ], l );
+        }
+    }
+
+    sgui_internal_free( old, SGUI_ALLOC_BUFFER );
+    return 1;
+}
+
+static void unlink_listener( listener** bucket, listener* l )
+{
+    listener* i = NULL;
+
+    SGUI_REMOVE_FROM_LIST( *bucket, i, l );
+
+    --type_count[ TYPE_SLOT( l->event ) ];
+    --num_listeners;
+    sgui_internal_pool_free( SGUI_POOL_LISTENER, l );
+}
+
+/* remove listeners that were disconnected while dispatching events */
+static void remove_stale( void )
+{
+    listener *l, *next;
+    unsigned int i;
+
+    for( i=0; i<table_size; ++i )
+    {
+        for( l=table[i]; l; l=next )
+        {
+            next = l->next;
+
+            if( !l->callback )
+                unlink_listener( table + i, l );
+        }
+    }
+
+    stale = 0;
+}
+
+
+
+/*
+    Thunks that call a listener with the arguments it asked for. The right
+    one is picked once when connecting, so dispatching an event is a single
+    indirect call instead of a switch over the argument type.
+ */
+#define THUNK( name, call )\
+        static void name( const listener* l, const sgui_event* e )\
+        { (void)e; call; }
+
+#define CALL( name, args ) THUNK( name, l->callback args )
+#define TYPED( name, type, args ) THUNK( name, ((type)l->callback) args )
+
+#define FROM_EVENT1( name, a ) CALL( name, (l->receiver, a) )
+#define FROM_EVENT2( name, a, b ) CALL( name, (l->receiver, a, b) )
+#define FROM_EVENT3( name, a, b, c ) CALL( name, (l->receiver, a, b, c) )
+
+FROM_EVENT1( call_event,  e )
+FROM_EVENT1( call_widget, e->src.widget )
+FROM_EVENT1( call_window, e->src.window )
+FROM_EVENT1( call_type,   e->type )
+FROM_EVENT1( call_i,      e->arg.i )
+FROM_EVENT1( call_i2_x,   e->arg.i2.x )
+FROM_EVENT1( call_i2_y,   e->arg.i2.y )
+FROM_EVENT1( call_i3_x,   e->arg.i3.x )
+FROM_EVENT1( call_i3_y,   e->arg.i3.y )
+FROM_EVENT1( call_i3_z,   e->arg.i3.z )
+FROM_EVENT1( call_ui2_x,  e->arg.ui2.x )
+FROM_EVENT1( call_ui2_y,  e->arg.ui2.y )
+FROM_EVENT1( call_utf8,   e->arg.utf8 )
+FROM_EVENT1( call_rect,   &e->arg.rect )
+FROM_EVENT1( call_color,  e->arg.color )
+FROM_EVENT2( call_ui2_xy, e->arg.ui2.x, e->arg.ui2.y )
+FROM_EVENT2( call_ui2_yx, e->arg.ui2.y, e->arg.ui2.x )
+FROM_EVENT2( call_i2_xy,  e->arg.i2.x,  e->arg.i2.y )
+FROM_EVENT2( call_i2_yx,  e->arg.i2.y,  e->arg.i2.x )
+FROM_EVENT2( call_i3_xy,  e->arg.i3.x,  e->arg.i3.y )
+FROM_EVENT2( call_i3_xz,  e->arg.i3.x,  e->arg.i3.z )
+FROM_EVENT2( call_i3_yx,  e->arg.i3.y,  e->arg.i3.x )
+FROM_EVENT2( call_i3_yz,  e->arg.i3.y,  e->arg.i3.z )
+FROM_EVENT2( call_i3_zx,  e->arg.i3.z,  e->arg.i3.x )
+FROM_EVENT2( call_i3_zy,  e->arg.i3.z,  e->arg.i3.y )
+FROM_EVENT3( call_i3_xyz, e->arg.i3.x,  e->arg.i3.y,  e->arg.i3.z )
+FROM_EVENT3( call_i3_xzy, e->arg.i3.x,  e->arg.i3.z,  e->arg.i3.y )
+FROM_EVENT3( call_i3_yxz, e->arg.i3.y,  e->arg.i3.x,  e->arg.i3.z )
+FROM_EVENT3( call_i3_yzx, e->arg.i3.y,  e->arg.i3.z,  e->arg.i3.x )
+FROM_EVENT3( call_i3_zxy, e->arg.i3.z,  e->arg.i3.x,  e->arg.i3.y )
+FROM_EVENT3( call_i3_zyx, e->arg.i3.z,  e->arg.i3.y,  e->arg.i3.x )
+
+CALL( call_void,    (l->receiver) )
+CALL( call_char,    (l->receiver, l->value.c) )
+CALL( call_short,   (l->receiver, l->value.s) )
+CALL( call_int,     (l->receiver, l->value.i3[0]) )
+CALL( call_long,    (l->receiver, l->value.l) )
+CALL( call_pointer, (l->receiver, l->value.p) )
+#ifndef SGUI_NO_FLOAT
+CALL( call_float,   (l->receiver, l->value.f) )
+CALL( call_double,  (l->receiver, l->value.d) )
+#endif
+CALL( call_int2,    (l->receiver, l->value.i3[0], l->value.i3[1]) )
+CALL( call_int3,    (l->receiver, l->value.i3[0], l->value.i3[1],
+                     l->value.i3[2]) )
+
+/* thunks for the typed connect functions, no variadic call involved */
+TYPED( call_typed_event,   sgui_event_callback,   (l->receiver, e) )
+TYPED( call_typed_void,    sgui_void_callback,    (l->receiver) )
+TYPED( call_typed_int,     sgui_int_callback,     (l->receiver,
+                                                   l->value.i3[0]) )
+TYPED( call_typed_pointer, sgui_pointer_callback, (l->receiver,
+                                                   l->value.p) )
+TYPED( call_typed_int2,    sgui_int2_callback,    (l->receiver,
+                                                   l->value.i3[0],
+                                                   l->value.i3[1]) )
+TYPED( call_typed_int3,    sgui_int3_callback,    (l->receiver,
+                                                   l->value.i3[0],
+                                                   l->value.i3[1],
+                                                   l->value.i3[2]) )
+TYPED( call_typed_long,    sgui_long_callback,    (l->receiver,
+                                                   l->value.l) )
+#ifndef SGUI_NO_FLOAT
+TYPED( call_typed_float,   sgui_float_callback,   (l->receiver,
+                                                   l->value.f) )
+TYPED( call_typed_double,  sgui_double_callback,  (l->receiver,
+                                                   l->value.d) )
+#endif
+
+#undef FROM_EVENT3
+#undef FROM_EVENT2
+#undef FROM_EVENT1
+#undef TYPED
+#undef CALL
+#undef THUNK
+
+/* get the thunk for an argument type, NULL if the type is unknown */
+static listener_thunk select_thunk( int type, int from )
+{
+    switch( type )
+    {
+    case SGUI_FROM_EVENT:
+        switch( from )
+        {
+        case SGUI_EVENT:   return call_event;
+        case SGUI_WIDGET:  return call_widget;
+        case SGUI_WINDOW:  return call_window;
+        case SGUI_TYPE:    return call_type;
+        case SGUI_I:       return call_i;
+        case SGUI_I2_X:    return call_i2_x;
+        case SGUI_I2_Y:    return call_i2_y;
+        case SGUI_I3_X:    return call_i3_x;
+        case SGUI_I3_Y:    return call_i3_y;
+        case SGUI_I3_Z:    return call_i3_z;
+        case SGUI_UI2_X:   return call_ui2_x;
+        case SGUI_UI2_Y:   return call_ui2_y;
+        case SGUI_UTF8:    return call_utf8;
+        case SGUI_RECT:    return call_rect;
+        case SGUI_COLOR:   return call_color;
+        case SGUI_UI2_XY:  return call_ui2_xy;
+        case SGUI_UI2_YX:  return call_ui2_yx;
+        case SGUI_I2_XY:   return call_i2_xy;
+        case SGUI_I2_YX:   return call_i2_yx;
+        case SGUI_I3_XY:   return call_i3_xy;
+        case SGUI_I3_XZ:   return call_i3_xz;
+        case SGUI_I3_YX:   return call_i3_yx;
+        case SGUI_I3_YZ:   return call_i3_yz;
+        case SGUI_I3_ZX:   return call_i3_zx;
+        case SGUI_I3_ZY:   return call_i3_zy;
+        case SGUI_I3_XYZ:  return call_i3_xyz;
+        case SGUI_I3_XZY:  return call_i3_xzy;
+        case SGUI_I3_YXZ:  return call_i3_yxz;
+        case SGUI_I3_YZX:  return call_i3_yzx;
+        case SGUI_I3_ZXY:  return call_i3_zxy;
+        case SGUI_I3_ZYX:  return call_i3_zyx;
+        }
+        break;
+    case SGUI_VOID:    return call_void;
+    case SGUI_CHAR:    return call_char;
+    case SGUI_SHORT:   return call_short;
+    case SGUI_INT:     return call_int;
+    case SGUI_LONG:    return call_long;
+    case SGUI_POINTER: return call_pointer;
+#ifndef SGUI_NO_FLOAT
+    case SGUI_FLOAT:   return call_float;
+    case SGUI_DOUBLE:  return call_double;
+#endif
+    case SGUI_INT2:    return call_int2;
+    case SGUI_INT3:    return call_int3;
+    }
+
+    return NULL;
+}
+
+/* insert a listener into the table, frees it on failure */
+static int add_listener( listener* l )
+{
+    int ret = 0;
+
+    sgui_internal_lock( SGUI_LOCK_EVENT );
+
+    if( !table || num_listeners >= 2*table_size )
+    {
+        if( !grow_table( ) && !table )
+        {
+            sgui_internal_pool_free( SGUI_POOL_LISTENER, l );
+            goto unlock;
+        }
+    }
+
+    SGUI_ADD_TO_LIST( table[ hash( l->event, l->sender ) ], l );
+    ++type_count[ TYPE_SLOT( l->event ) ];
+    ++num_listeners;
+    ret = 1;
+unlock:
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+    return ret;
+}
+
+/* allocate a listener for the typed connect functions */
+static listener* new_listener( void* sender, int eventtype,
+                               sgui_function callback, void* receiver,
+                               listener_thunk thunk )
+{
+    listener* l;
+
+    if( !callback || !(l = sgui_internal_pool_alloc( SGUI_POOL_LISTENER,
+                                                     sizeof(listener) )) )
+        return NULL;
+
+    l->event    = eventtype;
+    l->sender   = sender;
+    l->callback = callback;
+    l->receiver = receiver;
+    l->thunk    = thunk;
+    return l;
+}
+
 void sgui_event_connect( void* sender, int eventtype, ... )
 {
     sgui_function callback;
@@ -80,7 +409,8 @@ void sgui_event_connect( void* sender, int eventtype, ... )
     va_start( va, eventtype );
     callback = va_arg( va, sgui_function );
 
-    if( !callback || !(l = calloc( 1, sizeof(listener) )) )
+    if( !callback || !(l = sgui_internal_pool_alloc( SGUI_POOL_LISTENER,
+                                                     sizeof(listener) )) )
         goto done;
 
     l->event    = eventtype;
@@ -108,60 +438,237 @@ void sgui_event_connect( void* sender, int eventtype, ... )
                              l->value.i3[2] = va_arg( va, int ); break;
     }
 
-    sgui_internal_lock_mutex( );
-    SGUI_ADD_TO_LIST( listeners, l );
-    sgui_internal_unlock_mutex( );
+    if( !(l->thunk = select_thunk( l->type, l->value.i3[0] )) )
+    {
+        sgui_internal_pool_free( SGUI_POOL_LISTENER, l );
+        goto done;
+    }
+
+    add_listener( l );
 done:
     va_end( va );
 }
 
+int sgui_event_connect_event( void* sender, int eventtype,
+                              sgui_event_callback callback,
+                              void* receiver )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_event );
+
+    return l ? add_listener( l ) : 0;
+}
+
+int sgui_event_connect_void( void* sender, int eventtype,
+                             sgui_void_callback callback, void* receiver )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_void );
+
+    return l ? add_listener( l ) : 0;
+}
+
+int sgui_event_connect_int( void* sender, int eventtype,
+                            sgui_int_callback callback, void* receiver,
+                            int value )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_int );
+
+    if( !l )
+        return 0;
+
+    l->value.i3[0] = value;
+    return add_listener( l );
+}
+
+int sgui_event_connect_pointer( void* sender, int eventtype,
+                                sgui_pointer_callback callback,
+                                void* receiver, void* value )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_pointer );
+
+    if( !l )
+        return 0;
+
+    l->value.p = value;
+    return add_listener( l );
+}
+
+int sgui_event_connect_int2( void* sender, int eventtype,
+                             sgui_int2_callback callback, void* receiver,
+                             int a, int b )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_int2 );
+
+    if( !l )
+        return 0;
+
+    l->value.i3[0] = a;
+    l->value.i3[1] = b;
+    return add_listener( l );
+}
+
+int sgui_event_connect_int3( void* sender, int eventtype,
+                             sgui_int3_callback callback, void* receiver,
+                             int a, int b, int c )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_int3 );
+
+    if( !l )
+        return 0;
+
+    l->value.i3[0] = a;
+    l->value.i3[1] = b;
+    l->value.i3[2] = c;
+    return add_listener( l );
+}
+
+int sgui_event_connect_long( void* sender, int eventtype,
+                             sgui_long_callback callback, void* receiver,
+                             long value )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_long );
+
+    if( !l )
+        return 0;
+
+    l->value.l = value;
+    return add_listener( l );
+}
+
+#ifndef SGUI_NO_FLOAT
+int sgui_event_connect_float( void* sender, int eventtype,
+                              sgui_float_callback callback, void* receiver,
+                              float value )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_float );
+
+    if( !l )
+        return 0;
+
+    l->value.f = value;
+    return add_listener( l );
+}
+
+int sgui_event_connect_double( void* sender, int eventtype,
+                               sgui_double_callback callback, void* receiver,
+                               double value )
+{
+    listener* l = new_listener( sender, eventtype, (sgui_function)callback,
+                                receiver, call_typed_double );
+
+    if( !l )
+        return 0;
+
+    l->value.d = value;
+    return add_listener( l );
+}
+#endif
+
 void sgui_event_disconnect( void* sender, int eventtype,
                             sgui_function callback, void* receiver )
 {
-    listener* old = NULL;
-    listener* l = listeners;
+    listener *l, *next;
+    listener** bucket;
 
-    sgui_internal_lock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_EVENT );
 
-    while( l )
+    if( !table || !callback )
+        goto done;
+
+    bucket = table + hash( eventtype, sender );
+
+    for( l=*bucket; l; l=next )
     {
-        if( l->event==eventtype && l->callback==callback &&
-            l->sender==sender && l->receiver==receiver )
+        next = l->next;
+
+        if( l->event!=eventtype || l->callback!=callback ||
+            l->sender!=sender || l->receiver!=receiver )
         {
-            if( old )
-            {
-                old->next = l->next;
-                free( l );
-                l = old->next;
-            }
-            else
-            {
-                listeners = listeners->next;
-                free( l );
-                l = listeners;
-            }
+            continue;
+        }
+
+        /* a listener might be walked right now, remove it later */
+        if( dispatching )
+        {
+            l->callback = NULL;
+            stale = 1;
         }
         else
         {
-            old = l;
-            l = l->next;
+            unlink_listener( bucket, l );
         }
     }
+done:
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+}
 
-    sgui_internal_unlock_mutex( );
+static int ring_pop( sgui_event* event )
+{
+    ring_slot* s = ring + (ring_tail & RING_MASK);
+
+    /* not posted yet, or the producer is still writing it */
+    if( s->seq != ring_tail + 1 )
+        return 0;
+
+    sgui_internal_memory_barrier( );
+    *event = s->event;
+    sgui_internal_memory_barrier( );
+
+    s->seq = ring_tail + SGUI_EVENT_RING_SIZE;
+    ++ring_tail;
+    return 1;
 }
 
 void sgui_event_post( const sgui_event* event )
 {
     sgui_event* new_queue;
+    unsigned int pos;
+    ring_slot* s;
     int new_size;
 
-    sgui_internal_lock_mutex( );
+    /* nobody listens for this type of event */
+    if( !type_count[ TYPE_SLOT( event->type ) ] )
+        return;
+
+    /* once the ring ran full, keep using the overflow queue for ordering */
+    while( !queue_top )
+    {
+        pos = ring_head;
+        s = ring + (pos & RING_MASK);
+
+        if( s->seq != pos )
+        {
+            /* the consumer has not freed the slot yet: the ring is full */
+            if( (int)(s->seq - pos) < 0 )
+                break;
+
+            continue;       /* an other producer took it, try again */
+        }
+
+        if( sgui_internal_atomic_cas( &ring_head, pos, pos + 1 ) )
+        {
+            s->event = *event;
+            sgui_internal_memory_barrier( );
+            s->seq = pos + 1;
+            sgui_internal_wake_main_loop( );
+            return;
+        }
+    }
+
+    sgui_internal_lock( SGUI_LOCK_EVENT );
 
     if( queue_top == queue_size )
     {
         new_size = queue_size<10 ? 10 : queue_size*2;
-        new_queue = realloc( queue, sizeof(sgui_event)*new_size );
+        new_queue = sgui_internal_realloc( queue, sizeof(sgui_event)*new_size,
+                                           SGUI_MEM(EVENTS,BUFFER) );
 
         if( new_queue )
         {
@@ -173,158 +680,402 @@ void sgui_event_post( const sgui_event* event )
     if( queue_top < queue_size )
         queue[ queue_top++ ] = (*event);
 
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+    sgui_internal_wake_main_loop( );
 }
 
 /****************************************************************************/
 
+/*
+    Add all listeners for an event that are registered for a sender to a
+    snapshot. Called with the event lock held. Returns the new snapshot size.
+ */
+static unsigned int snapshot( const sgui_event* e, const void* sender,
+                              listener*** list, unsigned int count,
+                              unsigned int* size, listener** stack )
+{
+    listener **new_list, *l;
+
+    for( l=table[ hash( e->type, sender ) ]; l; l=l->next )
+    {
+        if( !l->callback || l->event!=e->type || l->sender!=sender )
+            continue;
+
+        if( count == *size )
+        {
+            new_list = sgui_internal_scratch_alloc( sizeof(listener*) *
+                                                    (*size) * 2 );
+
+            if( !new_list )
+                break;
+
+            memcpy( new_list, *list, sizeof(listener*) * count );
+
+            if( *list != stack )
+                sgui_internal_scratch_free( *list );
+
+            *list = new_list;
+            *size *= 2;
+        }
+
+        (*list)[ count++ ] = l;
+    }
+
+    return count;
+}
+
+/*
+    Call the listeners for an event without holding a lock, so slow
+    callbacks don't block other threads. The event lock is only held while
+    taking a snapshot of the matching listeners. The caller must have
+    incremented dispatching, so that disconnected listeners are only
+    marked stale and the snapshot doesn't point to freed memory.
+ */
+static void dispatch_event( const sgui_event* e )
+{
+    listener* stack[ SNAPSHOT_SIZE ];
+    unsigned int i, count = 0, size = SNAPSHOT_SIZE;
+    listener** list = stack;
+
+    sgui_internal_lock( SGUI_LOCK_EVENT );
+
+    if( table && type_count[ TYPE_SLOT( e->type ) ] )
+    {
+        /* listeners for the sender first, then for any sender */
+        if( e->src.other )
+            count = snapshot( e, e->src.other, &list, count, &size, stack );
+
+        count = snapshot( e, NULL, &list, count, &size, stack );
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+
+    /* skip listeners disconnected by an earlier callback */
+    for( i=0; i<count; ++i )
+    {
+        if( list[i]->callback )
+            list[i]->thunk( list[i], e );
+    }
+
+    if( list != stack )
+        sgui_internal_scratch_free( list );
+}
+
+/* user input, dispatched before the events of other sources */
+static int is_input( int type )
+{
+    switch( type )
+    {
+    case SGUI_MOUSE_PRESS_EVENT:
+    case SGUI_MOUSE_RELEASE_EVENT:
+    case SGUI_MOUSE_WHEEL_EVENT:
+    case SGUI_KEY_PRESSED_EVENT:
+    case SGUI_KEY_RELEASED_EVENT:
+    case SGUI_CHAR_EVENT:
+    case SGUI_DOUBLE_CLICK_EVENT:
+        return 1;
+    }
+    return 0;
+}
+
+/* events that only report the latest state and can be merged */
+static int is_coalescible( int type )
+{
+    switch( type )
+    {
+    case SGUI_SIZE_CHANGE_EVENT:
+    case SGUI_MOUSE_MOVE_EVENT:
+    case SGUI_MOUSE_WHEEL_EVENT:
+    case SGUI_EXPOSE_EVENT:
+    case SGUI_EDIT_VALUE_CHANGED:
+    case SGUI_SLIDER_CHANGED_EVENT:
+    case SGUI_RGBA_CHANGED_EVENT:
+    case SGUI_HSVA_CHANGED_EVENT:
+        return 1;
+    }
+    return 0;
+}
+
+/*
+    Try to merge an event into an earlier one of the same type and source
+    in the batch. Other events of the source that are not coalescible
+    (e.g. button presses) act as a barrier, so the order in which the
+    listeners see them relative to the merged event does not change.
+ */
+static int coalesce( sgui_event* events, int count, const sgui_event* e )
+{
+    sgui_event* prev;
+    int i, limit;
+
+    if( !is_coalescible( e->type ) )
+        return 0;
+
+    for( i=count-1, limit=COALESCE_WINDOW; i>=0 && limit; --i, --limit )
+    {
+        prev = events + i;
+
+        if( prev->src.other != e->src.other )
+            continue;
+
+        if( prev->type != e->type )
+        {
+            if( is_coalescible( prev->type ) )
+                continue;
+            break;
+        }
+
+        switch( e->type )
+        {
+        case SGUI_EXPOSE_EVENT:
+            sgui_rect_join( &prev->arg.rect, &e->arg.rect, 0 );
+            break;
+        case SGUI_MOUSE_WHEEL_EVENT:
+            prev->arg.i += e->arg.i;
+            break;
+        default:
+            prev->arg = e->arg;
+            break;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+    Check if an earlier event of a source is still waiting. If more sources
+    are waiting than we keep track of, all of them are treated as waiting.
+ */
+static int is_held( void** held, int count, const void* source )
+{
+    int i;
+
+    if( count > MAX_HELD )
+        return 1;
+
+    for( i=0; i<count && held[i]!=source; ++i );
+
+    return i < count;
+}
+
+/*
+    Append an event to the batch. If we run out of memory, dispatch
+    what we have so far and the event directly. Called with the event
+    lock held, which is dropped while calling the listeners.
+ */
+static void gather( sgui_event** events, int* count, int* size,
+                    const sgui_event* e )
+{
+    sgui_event* new_events;
+    int i, new_size;
+
+    if( coalesce( *events, *count, e ) )
+        return;
+
+    if( *count == *size )
+    {
+        new_size = *size<16 ? 16 : *size*2;
+        new_events = sgui_internal_realloc( *events,
+                                            sizeof(sgui_event)*new_size,
+                                            SGUI_MEM(EVENTS,BUFFER) );
+
+        if( !new_events )
+        {
+            sgui_internal_unlock( SGUI_LOCK_EVENT );
+
+            for( i=0; i<*count; ++i )
+                dispatch_event( (*events) + i );
+
+            *count = 0;
+            dispatch_event( e );
+            sgui_internal_lock( SGUI_LOCK_EVENT );
+            return;
+        }
+
+        *events = new_events;
+        *size = new_size;
+    }
+
+    (*events)[ (*count)++ ] = *e;
+}
+
 void sgui_event_process( void )
 {
-    sgui_event* local;
-    sgui_event* e;
-    int i, count;
-    listener* l;
+    int i, j, count, size, num, events_size;
+    void* held[ MAX_HELD ];
+    sgui_event *local, *events;
+    unsigned long start;
+    unsigned int n;
+    sgui_event e;
+    int waiting, k = 0;
+
+    sgui_internal_lock( SGUI_LOCK_EVENT );
+
+    ++dispatching;
 
-    sgui_internal_lock_mutex( );
+    /*
+        snatch the batch buffer in case a callback processes events,
+        including the events deferred by the last call
+     */
+    events = batch;
+    events_size = batch_size;
+    num = num_deferred;
+    batch = NULL;
+    batch_size = 0;
+    num_deferred = 0;
+
+    /*
+        gather the events that were posted before we started, merging
+        bursts of move, resize, expose, wheel and value change events
+     */
+    for( n=ring_head - ring_tail; n && ring_pop( &e ); --n )
+        gather( &events, &num, &events_size, &e );
 
     /*
-        snatch the queue, so modification while processing
+        snatch the overflow queue, so modification while processing
         doesn't confuse us
      */
     local = queue;
     count = queue_top;
+    size = queue_size;
 
     queue_top = 0;
     queue_size = 0;
     queue = NULL;
 
-    for( e=local, i=0; i<count; ++i, ++e )  /* for each event in the queue */
+    for( i=0; i<count; ++i )
+        gather( &events, &num, &events_size, local + i );
+
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+
+    /*
+        User input goes first, so it doesn't wait behind the events of
+        other sources. Input from a source that still has earlier events
+        waiting stays behind them, so the events of a source keep their
+        order. The rest is moved to the front, in order.
+     */
+    for( i=0, j=0; i<num; ++i )
     {
-        for( l=listeners; l; l=l->next )        /* for each listener */
+        waiting = is_held( held, k, events[i].src.other );
+
+        if( is_input( events[i].type ) && !waiting )
         {
-            if( (l->event!=e->type)||(l->sender && l->sender!=e->src.other) )
-                continue;
+            dispatch_event( events + i );
+            continue;
+        }
 
-            switch( l->type )
-            {
-            case SGUI_FROM_EVENT:
-                switch( l->value.i3[0] )
-                {
-                case SGUI_EVENT: l->callback(l->receiver,e            );break;
-                case SGUI_WIDGET:l->callback(l->receiver,e->src.widget);break;
-                case SGUI_WINDOW:l->callback(l->receiver,e->src.window);break;
-                case SGUI_TYPE:  l->callback(l->receiver,e->type      );break;
-                case SGUI_I:     l->callback(l->receiver,e->arg.i     );break;
-                case SGUI_I2_X:  l->callback(l->receiver,e->arg.i2.x  );break;
-                case SGUI_I2_Y:  l->callback(l->receiver,e->arg.i2.y  );break;
-                case SGUI_I3_X:  l->callback(l->receiver,e->arg.i3.x  );break;
-                case SGUI_I3_Y:  l->callback(l->receiver,e->arg.i3.y  );break;
-                case SGUI_I3_Z:  l->callback(l->receiver,e->arg.i3.z  );break;
-                case SGUI_UI2_X: l->callback(l->receiver,e->arg.ui2.x );break;
-                case SGUI_UI2_Y: l->callback(l->receiver,e->arg.ui2.y );break;
-                case SGUI_UTF8:  l->callback(l->receiver,e->arg.utf8  );break;
-                case SGUI_RECT:  l->callback(l->receiver,&e->arg.rect );break;
-                case SGUI_COLOR: l->callback(l->receiver,e->arg.color );break;
-                case SGUI_UI2_XY:
-                    l->callback(l->receiver,e->arg.ui2.x,e->arg.ui2.y); break;
-                case SGUI_UI2_YX:
-                    l->callback(l->receiver,e->arg.ui2.y,e->arg.ui2.x); break;
-                case SGUI_I2_XY:
-                    l->callback(l->receiver,e->arg.i2.x,e->arg.i2.y); break;
-                case SGUI_I2_YX:
-                    l->callback(l->receiver,e->arg.i2.y,e->arg.ui2.x); break;
-                case SGUI_I3_XY:
-                    l->callback(l->receiver,e->arg.i3.x,e->arg.i3.y); break;
-                case SGUI_I3_XZ:
-                    l->callback(l->receiver,e->arg.i3.x,e->arg.i3.z); break;
-                case SGUI_I3_YX:
-                    l->callback(l->receiver,e->arg.i3.y,e->arg.i3.x); break;
-                case SGUI_I3_YZ:
-                    l->callback(l->receiver,e->arg.i3.y,e->arg.i3.z); break;
-                case SGUI_I3_ZX:
-                    l->callback(l->receiver,e->arg.i3.z,e->arg.i3.x); break;
-                case SGUI_I3_ZY:
-                    l->callback(l->receiver,e->arg.i3.z,e->arg.i3.y); break;
-                case SGUI_I3_XYZ:
-                    l->callback( l->receiver,
-                                 e->arg.i3.x, e->arg.i3.y, e->arg.i3.z );
-                    break;
-                case SGUI_I3_XZY:
-                    l->callback( l->receiver,
-                                 e->arg.i3.x, e->arg.i3.z, e->arg.i3.y );
-                    break;
-                case SGUI_I3_YXZ:
-                    l->callback( l->receiver,
-                                 e->arg.i3.y, e->arg.i3.x, e->arg.i3.z );
-                    break;
-                case SGUI_I3_YZX:
-                    l->callback( l->receiver,
-                                 e->arg.i3.y, e->arg.i3.z, e->arg.i3.x );
-                    break;
-                case SGUI_I3_ZXY:
-                    l->callback( l->receiver,
-                                 e->arg.i3.z, e->arg.i3.x, e->arg.i3.y );
-                    break;
-                case SGUI_I3_ZYX:
-                    l->callback( l->receiver,
-                                 e->arg.i3.z, e->arg.i3.y, e->arg.i3.x );
-                    break;
-                }
-                break;
-            case SGUI_VOID:   l->callback(l->receiver);             break;
-            case SGUI_CHAR:   l->callback(l->receiver, l->value.c); break;
-            case SGUI_SHORT:  l->callback(l->receiver, l->value.s); break;
-            case SGUI_INT:    l->callback(l->receiver, l->value.i3[0]); break;
-            case SGUI_LONG:   l->callback(l->receiver, l->value.l); break;
-            case SGUI_POINTER:l->callback(l->receiver, l->value.p); break;
-#ifndef SGUI_NO_FLOAT
-            case SGUI_FLOAT:  l->callback(l->receiver, l->value.f); break;
-            case SGUI_DOUBLE: l->callback(l->receiver, l->value.d); break;
-#endif
-            case SGUI_INT2:
-                l->callback(l->receiver, l->value.i3[0], l->value.i3[1]);
-                break;
-            case SGUI_INT3:
-                l->callback( l->receiver, l->value.i3[0], l->value.i3[1],
-                             l->value.i3[2] );
-                break;
-            }
+        if( !waiting )
+        {
+            if( k < MAX_HELD )
+                held[ k ] = events[i].src.other;
+            ++k;
         }
+
+        events[ j++ ] = events[ i ];
+    }
+
+    num = j;
+
+    /* the rest until the time budget is used up */
+    start = sgui_internal_get_time_ms( );
+
+    for( i=0; i<num; ++i )
+    {
+        if( (sgui_internal_get_time_ms( ) - start) >= SGUI_EVENT_TIME_BUDGET )
+            break;
+
+        dispatch_event( events + i );
+    }
+
+    /* move what is left to the front for the next call */
+    for( j=0; i<num; ++i )
+        events[ j++ ] = events[ i ];
+
+    sgui_internal_lock( SGUI_LOCK_EVENT );
+
+    /* keep the buffers around for the next cycle */
+    if( !queue )
+    {
+        queue = local;
+        queue_size = size;
+        local = NULL;
+    }
+
+    if( !batch )
+    {
+        batch = events;
+        batch_size = events_size;
+        num_deferred = j;
+        events = NULL;
+        j = 0;
     }
 
-    sgui_internal_unlock_mutex( );
+    if( !(--dispatching) && stale )
+        remove_stale( );
 
-    free( local );
+    count = num_deferred;
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
+
+    /* a callback processed events in the mean time, don't defer */
+    for( i=0; i<j; ++i )
+        dispatch_event( events + i );
+
+    /* make sure the main loop comes back for the deferred events */
+    if( count )
+        sgui_internal_wake_main_loop( );
+
+    sgui_internal_free( events, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( local, SGUI_ALLOC_BUFFER );
 }
 
 void sgui_event_reset( void )
 {
     listener* l;
+    unsigned int i;
 
-    sgui_internal_lock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_EVENT );
 
-    while( listeners )
+    for( i=0; i<table_size; ++i )
     {
-        l = listeners;
-        listeners = listeners->next;
-        free( l );
+        while( table[i] )
+        {
+            l = table[i];
+            table[i] = table[i]->next;
+            sgui_internal_pool_free( SGUI_POOL_LISTENER, l );
+        }
     }
 
-    free( queue );
+    sgui_internal_free( table, SGUI_ALLOC_BUFFER );
+    table = NULL;
+    table_size = 0;
+    num_listeners = 0;
+    stale = 0;
+    memset( type_count, 0, sizeof(type_count) );
+
+    sgui_internal_free( queue, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( batch, SGUI_ALLOC_BUFFER );
 
     queue = NULL;
     queue_size = 0;
     queue_top = 0;
-    sgui_internal_unlock_mutex( );
+    batch = NULL;
+    batch_size = 0;
+    num_deferred = 0;
+
+    for( i=0; i<SGUI_EVENT_RING_SIZE; ++i )
+        ring[i].seq = i;
+
+    ring_head = ring_tail = 0;
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
 }
 
 unsigned int sgui_event_queued( void )
 {
     unsigned int count;
 
-    sgui_internal_lock_mutex( );
-    count = queue_top;
-    sgui_internal_unlock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_EVENT );
+    count = (ring_head - ring_tail) + queue_top + num_deferred;
+    sgui_internal_unlock( SGUI_LOCK_EVENT );
 
     return count;
 }
@@ -55,6 +55,16 @@ static int glyph_compare( const sgui_icon* left, const sgui_icon* right )
     return ((GLYPH*)left)->codepoint < ((GLYPH*)right)->codepoint ? -1 : 1;
 }
 
+static void glyph_destroy( sgui_icon* icon )
+{
+    sgui_internal_pool_free( SGUI_POOL_GLYPH, icon );
+}
+
+static void font_cache_destroy( sgui_icon_cache* this )
+{
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+}
+
 static GLYPH* create_glyph( sgui_icon_cache* this, sgui_font* font,
                             unsigned int codepoint )
 {
@@ -69,7 +79,7 @@ static GLYPH* create_glyph( sgui_icon_cache* this, sgui_font* font,
     src = font->get_glyph( font );
 
     /* create glyph */
-    if( !(g = calloc( 1, sizeof(GLYPH) )) )
+    if( !(g = sgui_internal_pool_alloc( SGUI_POOL_GLYPH, sizeof(GLYPH) )) )
         return NULL;
 
     g->super.red = 1;
@@ -85,7 +95,7 @@ static GLYPH* create_glyph( sgui_icon_cache* this, sgui_font* font,
     {
         if( !sgui_icon_cache_alloc_area( this, w, h, &g->super.area ) )
         {
-            free( g );
+            sgui_internal_pool_free( SGUI_POOL_GLYPH, g );
             return NULL;
         }
 
@@ -96,8 +106,11 @@ static GLYPH* create_glyph( sgui_icon_cache* this, sgui_font* font,
         g->super.area.right = w-1;      /* empty dummy area */
     }
 
+    /* sgui_icon_cache_find only takes the icon cache lock */
+    sgui_internal_lock( SGUI_LOCK_ICON_CACHE );
     this->root = sgui_icon_cache_tree_insert(this, this->root, (sgui_icon*)g);
     this->root->red = 0;
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return g;
 }
 
@@ -119,7 +132,8 @@ static GLYPH* fetch_glyph( sgui_icon_cache* this,
 
 sgui_icon_cache* sgui_font_cache_create( sgui_pixmap* map )
 {
-    sgui_icon_cache* this = calloc( 1, sizeof(sgui_icon_cache) );
+    sgui_icon_cache* this = sgui_internal_calloc( 1, sizeof(sgui_icon_cache),
+                                                  SGUI_MEM(GLYPHS,OBJECT) );
 
     if( this )
     {
@@ -127,6 +141,11 @@ sgui_icon_cache* sgui_font_cache_create( sgui_pixmap* map )
 
         this->pixmap = map;
         this->icon_compare = glyph_compare;
+        this->icon_destroy = glyph_destroy;
+        this->destroy = font_cache_destroy;
+
+        sgui_internal_memory_account( SGUI_MEMORY_GLYPHS,
+                                      (long)this->width * this->height, 0 );
     }
     return this;
 }
@@ -0,0 +1,216 @@
+/*
+ * frame_clock.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_loop.h"
+
+#include <stdlib.h>
+
+
+
+typedef struct
+{
+    sgui_frame_callback callback;
+    void* user;
+}
+frame_request;
+
+
+
+static unsigned long interval = 1000 / SGUI_FRAME_RATE;  /* in ms */
+static unsigned long last_frame = 0;    /* time stamp of the last frame */
+static volatile unsigned int pending = 0;   /* non-zero if requested */
+
+static frame_request* requests = NULL;
+static unsigned int num_requests = 0;
+static unsigned int max_requests = 0;
+
+/* requests of the frame whose callbacks are currently being called */
+static frame_request* running = NULL;
+static unsigned int num_running = 0;
+
+
+
+void sgui_internal_frame_request( void )
+{
+    /* only the first request of a frame has to wake up the main loop */
+    if( sgui_internal_atomic_cas( &pending, 0, 1 ) )
+        sgui_internal_wake_main_loop( );
+}
+
+long sgui_internal_frame_timeout( void )
+{
+    unsigned long now, delta;
+    long timeout = -1;
+
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+
+    if( pending )
+    {
+        now = sgui_internal_get_time_ms( );
+        delta = now - last_frame;
+        timeout = delta < interval ? (long)(interval - delta) : 0;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+    return timeout;
+}
+
+int sgui_internal_frame_run( void )
+{
+    frame_request* list;
+    unsigned int i, count, size;
+    unsigned long now;
+
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+
+    now = sgui_internal_get_time_ms( );
+
+    if( !pending || (now - last_frame) < interval )
+    {
+        sgui_internal_unlock( SGUI_LOCK_FRAME );
+        return 0;
+    }
+
+    pending = 0;
+    last_frame = now;
+
+    /* snatch the requests, callbacks may request the next frame */
+    list = requests;
+    count = num_requests;
+    size = max_requests;
+
+    requests = NULL;
+    num_requests = max_requests = 0;
+    running = list;
+    num_running = count;
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+
+    /* skip callbacks that an earlier one cancelled */
+    for( i=0; i<count; ++i )
+    {
+        if( list[i].callback )
+            list[i].callback( now, list[i].user );
+    }
+
+    /* keep the buffer around for the next frame */
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+
+    running = NULL;
+    num_running = 0;
+
+    if( !requests )
+    {
+        requests = list;
+        max_requests = size;
+        list = NULL;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+
+    sgui_internal_free( list, SGUI_ALLOC_BUFFER );
+    return 1;
+}
+
+void sgui_internal_frame_reset( void )
+{
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+    sgui_internal_free( requests, SGUI_ALLOC_BUFFER );
+    requests = NULL;
+    num_requests = max_requests = 0;
+    interval = 1000 / SGUI_FRAME_RATE;
+    last_frame = 0;
+    pending = 0;
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+}
+
+/****************************************************************************/
+
+void sgui_set_frame_rate( unsigned int fps )
+{
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+    interval = fps ? (1000 / fps) : 0;
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+}
+
+int sgui_request_frame( sgui_frame_callback callback, void* user )
+{
+    frame_request* new_requests;
+    unsigned int new_max;
+    int ret = 0;
+
+    if( !callback )
+        return 0;
+
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+
+    if( num_requests == max_requests )
+    {
+        new_max = max_requests ? max_requests*2 : 8;
+        new_requests = sgui_internal_realloc( requests,
+                                              sizeof(frame_request)*new_max,
+                                              SGUI_ALLOC_BUFFER );
+
+        if( !new_requests )
+            goto out;
+
+        requests = new_requests;
+        max_requests = new_max;
+    }
+
+    requests[ num_requests ].callback = callback;
+    requests[ num_requests ].user = user;
+    ++num_requests;
+    ret = 1;
+out:
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+
+    if( ret )
+        sgui_internal_frame_request( );
+
+    return ret;
+}
+
+void sgui_cancel_frame( sgui_frame_callback callback, void* user )
+{
+    unsigned int i;
+
+    sgui_internal_lock( SGUI_LOCK_FRAME );
+
+    for( i=0; i<num_requests; ++i )
+    {
+        if( requests[i].callback==callback && requests[i].user==user )
+            requests[i].callback = NULL;
+    }
+
+    for( i=0; i<num_running; ++i )
+    {
+        if( running[i].callback==callback && running[i].user==user )
+            running[i].callback = NULL;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_FRAME );
+}
+
@@ -0,0 +1,229 @@
+/*
+ * grid.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_widget.h"
+
+#include <stdlib.h>
+
+
+
+/* number of hash buckets, must be a power of two */
+#define GRID_BUCKETS 256
+
+/* widgets covering more cells than this are kept in a separate list */
+#define GRID_MAX_CELLS 64
+
+
+
+typedef struct
+{
+    sgui_widget** w;
+    unsigned int used, size;
+}
+grid_bucket;
+
+struct sgui_grid
+{
+    int cell;                   /* edge length of a grid cell in pixels */
+    grid_bucket large;          /* widgets covering lots of cells */
+    grid_bucket buckets[ GRID_BUCKETS ];
+};
+
+
+
+/* map a coordinate to a cell index, rounding towards negative infinity */
+static int grid_cell( const sgui_grid* this, int x )
+{
+    return x>=0 ? (x / this->cell) : (-((-x - 1) / this->cell) - 1);
+}
+
+static grid_bucket* grid_bucket_at( sgui_grid* this, int cx, int cy )
+{
+    unsigned int h = ((unsigned int)cx * 73856093u) ^
+                     ((unsigned int)cy * 19349663u);
+
+    return this->buckets + (h & (GRID_BUCKETS - 1));
+}
+
+static int bucket_add( grid_bucket* b, sgui_widget* w )
+{
+    sgui_widget** ptr;
+    unsigned int size;
+
+    if( b->used == b->size )
+    {
+        size = b->size ? b->size*2 : 4;
+        ptr = sgui_internal_realloc( b->w, size * sizeof(sgui_widget*),
+                                     SGUI_MEM(WIDGETS,BUFFER) );
+
+        if( !ptr )
+            return 0;
+
+        b->w = ptr;
+        b->size = size;
+    }
+
+    b->w[ b->used++ ] = w;
+    return 1;
+}
+
+static void bucket_remove( grid_bucket* b, const sgui_widget* w )
+{
+    unsigned int i;
+
+    for( i=0; i<b->used; ++i )
+    {
+        if( b->w[i] == w )
+        {
+            b->w[i] = b->w[ --b->used ];
+            break;
+        }
+    }
+}
+
+/* find the topmost visible widget of a bucket containing a point */
+static sgui_widget* bucket_find( const grid_bucket* b, sgui_widget* best,
+                                 int x, int y, int sx, int sy )
+{
+    unsigned int i;
+    sgui_widget* w;
+
+    for( i=0; i<b->used; ++i )
+    {
+        w = b->w[i];
+
+        if( !(w->flags & SGUI_WIDGET_VISIBLE) )
+            continue;
+
+        if( best && best->index > w->index )
+            continue;
+
+        if( w->flags & SGUI_WIDGET_FIXED )
+        {
+            if( sgui_rect_is_point_inside( &w->area, x, y ) )
+                best = w;
+        }
+        else if( sgui_rect_is_point_inside( &w->area, x+sx, y+sy ) )
+        {
+            best = w;
+        }
+    }
+
+    return best;
+}
+
+/****************************************************************************/
+
+sgui_grid* sgui_internal_grid_create( unsigned int cell_size )
+{
+    sgui_grid* this = sgui_internal_calloc( 1, sizeof(sgui_grid),
+                                            SGUI_MEM(WIDGETS,OBJECT) );
+
+    if( this )
+        this->cell = cell_size ? (int)cell_size : 1;
+
+    return this;
+}
+
+void sgui_internal_grid_destroy( sgui_grid* this )
+{
+    unsigned int i;
+
+    for( i=0; i<GRID_BUCKETS; ++i )
+        sgui_internal_free( this->buckets[i].w, SGUI_ALLOC_BUFFER );
+
+    sgui_internal_free( this->large.w, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+}
+
+int sgui_internal_grid_insert( sgui_grid* this, sgui_widget* w )
+{
+    int cx, cy, x0, y0, x1, y1;
+
+    w->grid_area = w->area;
+
+    x0 = grid_cell( this, w->area.left );
+    y0 = grid_cell( this, w->area.top );
+    x1 = grid_cell( this, w->area.right );
+    y1 = grid_cell( this, w->area.bottom );
+
+    if( (x1-x0+1)*(y1-y0+1) > GRID_MAX_CELLS )
+        return bucket_add( &this->large, w );
+
+    for( cy=y0; cy<=y1; ++cy )
+    {
+        for( cx=x0; cx<=x1; ++cx )
+        {
+            if( !bucket_add( grid_bucket_at( this, cx, cy ), w ) )
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+void sgui_internal_grid_remove( sgui_grid* this, sgui_widget* w )
+{
+    int cx, cy, x0, y0, x1, y1;
+
+    x0 = grid_cell( this, w->grid_area.left );
+    y0 = grid_cell( this, w->grid_area.top );
+    x1 = grid_cell( this, w->grid_area.right );
+    y1 = grid_cell( this, w->grid_area.bottom );
+
+    if( (x1-x0+1)*(y1-y0+1) > GRID_MAX_CELLS )
+    {
+        bucket_remove( &this->large, w );
+        return;
+    }
+
+    for( cy=y0; cy<=y1; ++cy )
+    {
+        for( cx=x0; cx<=x1; ++cx )
+            bucket_remove( grid_bucket_at( this, cx, cy ), w );
+    }
+}
+
+sgui_widget* sgui_internal_grid_find( sgui_grid* this, int x, int y,
+                                      int sx, int sy )
+{
+    sgui_widget* best;
+
+    best = bucket_find( &this->large, NULL, x, y, sx, sy );
+
+    best = bucket_find( grid_bucket_at( this, grid_cell( this, x ),
+                                              grid_cell( this, y ) ),
+                        best, x, y, sx, sy );
+
+    if( sx || sy )
+    {
+        best = bucket_find( grid_bucket_at( this, grid_cell( this, x+sx ),
+                                                  grid_cell( this, y+sy ) ),
+                            best, x, y, sx, sy );
+    }
+
+    return best;
+}
@@ -92,6 +92,19 @@ static sgui_icon* tree_balance( sgui_icon* this )
 
 void sgui_icon_cache_destroy( sgui_icon_cache* this )
 {
+    long bytes = (long)this->width * this->height;
+
+    /* icon maps create their own pixmap, font caches get an A8 one */
+    if( this->owner )
+    {
+        bytes *= this->format==SGUI_RGBA8 ? 4 : 3;
+        sgui_internal_memory_account( SGUI_MEMORY_ICONS, -bytes, 0 );
+    }
+    else
+    {
+        sgui_internal_memory_account( SGUI_MEMORY_GLYPHS, -bytes, 0 );
+    }
+
     tree_destroy( this, this->root );
     sgui_pixmap_destroy( this->pixmap );
 
@@ -142,7 +155,7 @@ int sgui_icon_cache_alloc_area( sgui_icon_cache* this,
     if( !width || !height )
         return 0;
 
-    sgui_internal_lock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_ICON_CACHE );
 
     /* check if there is enought space for the icon */
     if( (this->next_x + width) > this->width )
@@ -169,10 +182,10 @@ int sgui_icon_cache_alloc_area( sgui_icon_cache* this,
     this->next_x += width;
     this->row_height = height>this->row_height ? height : this->row_height;
 
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return 1;
 fail:
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return 0;
 }
 
@@ -182,7 +195,7 @@ sgui_icon* sgui_icon_cache_find( const sgui_icon_cache* this,
     sgui_icon* node;
     int val;
 
-    sgui_internal_lock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_ICON_CACHE );
 
     for( node=this->root; node; node=val<0 ? node->left : node->right )
     {
@@ -192,7 +205,7 @@ sgui_icon* sgui_icon_cache_find( const sgui_icon_cache* this,
             break;
     }
 
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return node;
 }
 
@@ -211,6 +224,16 @@ static int compare_ids( const sgui_icon* left, const sgui_icon* right )
     return l->id==r->id ? 0 : (l->id < r->id ? -1 : 1);
 }
 
+static void map_destroy( sgui_icon_cache* this )
+{
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+}
+
+static void map_icon_destroy( sgui_icon* icon )
+{
+    sgui_internal_pool_free( SGUI_POOL_ICON, icon );
+}
+
 sgui_icon_cache* sgui_icon_map_create( sgui_canvas* canvas,
                                        unsigned int width,
                                        unsigned int height,
@@ -223,13 +246,16 @@ sgui_icon_cache* sgui_icon_map_create( sgui_canvas* canvas,
         return NULL;
 
     /* allocate structure */
-    this = calloc( 1, sizeof(sgui_icon_cache) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_icon_cache),
+                                 SGUI_MEM(ICONS,OBJECT) );
 
     if( !this )
         return NULL;
 
     /* initialize */
     this->icon_compare = compare_ids;
+    this->icon_destroy = map_icon_destroy;
+    this->destroy = map_destroy;
     this->owner = canvas;
     this->width = width;
     this->height = height;
@@ -239,10 +265,12 @@ sgui_icon_cache* sgui_icon_map_create( sgui_canvas* canvas,
 
     if( !this->pixmap )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
+    sgui_internal_memory_account( SGUI_MEMORY_ICONS, (long)width * height *
+                                  (alpha ? 4 : 3), 0 );
     return this;
 }
 
@@ -255,10 +283,12 @@ int sgui_icon_map_add_icon( sgui_icon_cache* this, unsigned int id,
     if( !width || !height || sgui_icon_map_find( this, id ) )
         return 0;
 
-    sgui_internal_lock_mutex( );
+    sgui_internal_lock( SGUI_LOCK_ICON_CACHE );
 
     /* create icon */
-    if( !(i = calloc( 1, sizeof(sgui_map_icon) )) )
+    i = sgui_internal_pool_alloc( SGUI_POOL_ICON, sizeof(sgui_map_icon) );
+
+    if( !i )
         goto fail;
 
     i->super.red = 1;
@@ -266,7 +296,7 @@ int sgui_icon_map_add_icon( sgui_icon_cache* this, unsigned int id,
 
     if( !sgui_icon_cache_alloc_area( this, width, height, &i->super.area ) )
     {
-        free( i );
+        sgui_internal_pool_free( SGUI_POOL_ICON, i );
         goto fail;
     }
 
@@ -274,10 +304,10 @@ int sgui_icon_map_add_icon( sgui_icon_cache* this, unsigned int id,
     this->root = sgui_icon_cache_tree_insert(this, this->root, (sgui_icon*)i);
     this->root->red = 0;
 
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return 1;
 fail:
-    sgui_internal_unlock_mutex( );
+    sgui_internal_unlock( SGUI_LOCK_ICON_CACHE );
     return 0;
 }
 
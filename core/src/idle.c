@@ -0,0 +1,205 @@
+/*
+ * idle.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_event.h"
+#include "sgui_loop.h"
+
+#include <stdlib.h>
+
+
+
+struct sgui_idle
+{
+    sgui_idle_callback callback;
+    void* user;
+
+    int running;                    /* non-zero while calling callback */
+    int destroyed;                  /* destroyed from within the callback */
+
+    sgui_idle* next;
+};
+
+
+
+static sgui_idle* idles = NULL;     /* list of idle tasks */
+static sgui_idle* cursor = NULL;    /* idle task to run next */
+static unsigned long deadline = 0;  /* end of the current time budget */
+
+
+
+static void remove_idle( sgui_idle* t )
+{
+    sgui_idle** i;
+
+    for( i=&idles; *i && *i!=t; i=&((*i)->next) );
+
+    if( *i )
+        *i = t->next;
+
+    if( cursor == t )
+        cursor = t->next;
+}
+
+/****************************************************************************/
+
+int sgui_internal_idle_pending( void )
+{
+    int pending;
+
+    sgui_internal_lock( SGUI_LOCK_IDLE );
+    pending = idles!=NULL;
+    sgui_internal_unlock( SGUI_LOCK_IDLE );
+
+    return pending;
+}
+
+void sgui_internal_idle_run( void )
+{
+    sgui_idle* t;
+    int more;
+
+    deadline = sgui_internal_get_time_ms( ) + SGUI_IDLE_TIME_BUDGET;
+
+    while( !sgui_idle_should_yield( ) )
+    {
+        sgui_internal_lock( SGUI_LOCK_IDLE );
+
+        if( !idles )
+        {
+            sgui_internal_unlock( SGUI_LOCK_IDLE );
+            break;
+        }
+
+        /* round robin, so one long task doesn't starve the others */
+        t = cursor ? cursor : idles;
+        cursor = t->next;
+
+        /* call the callback without holding a lock */
+        t->running = 1;
+        sgui_internal_unlock( SGUI_LOCK_IDLE );
+        more = t->callback( t, t->user );
+        sgui_internal_lock( SGUI_LOCK_IDLE );
+        t->running = 0;
+
+        if( t->destroyed )
+        {
+            sgui_internal_free( t, SGUI_ALLOC_OBJECT );
+        }
+        else if( !more )
+        {
+            remove_idle( t );
+            sgui_internal_free( t, SGUI_ALLOC_OBJECT );
+        }
+
+        sgui_internal_unlock( SGUI_LOCK_IDLE );
+    }
+
+    /* outside of sgui_internal_idle_run, callers always have to yield */
+    deadline = sgui_internal_get_time_ms( );
+}
+
+void sgui_internal_idle_reset( void )
+{
+    sgui_idle* t;
+
+    sgui_internal_lock( SGUI_LOCK_IDLE );
+
+    while( idles )
+    {
+        t = idles;
+        idles = t->next;
+        sgui_internal_free( t, SGUI_ALLOC_OBJECT );
+    }
+
+    cursor = NULL;
+    sgui_internal_unlock( SGUI_LOCK_IDLE );
+}
+
+/****************************************************************************/
+
+sgui_idle* sgui_idle_create( sgui_idle_callback callback, void* user )
+{
+    sgui_idle* this;
+
+    if( !callback || !(this = sgui_internal_calloc( 1, sizeof(sgui_idle),
+                                                    SGUI_ALLOC_OBJECT )) )
+        return NULL;
+
+    this->callback = callback;
+    this->user = user;
+
+    sgui_internal_lock( SGUI_LOCK_IDLE );
+    this->next = idles;
+    idles = this;
+    sgui_internal_unlock( SGUI_LOCK_IDLE );
+
+    /* the main loop must not go to sleep */
+    sgui_internal_wake_main_loop( );
+    return this;
+}
+
+void sgui_idle_destroy( sgui_idle* this )
+{
+    if( !this )
+        return;
+
+    sgui_internal_lock( SGUI_LOCK_IDLE );
+
+    remove_idle( this );
+
+    if( this->running )
+        this->destroyed = 1;
+    else
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+
+    sgui_internal_unlock( SGUI_LOCK_IDLE );
+}
+
+int sgui_idle_is_destroyed( sgui_idle* this )
+{
+    int destroyed;
+
+    sgui_internal_lock( SGUI_LOCK_IDLE );
+    destroyed = this->destroyed;
+    sgui_internal_unlock( SGUI_LOCK_IDLE );
+
+    return destroyed;
+}
+
+int sgui_idle_should_yield( void )
+{
+    long frame;
+
+    if( (long)(sgui_internal_get_time_ms( ) - deadline) >= 0 )
+        return 1;
+
+    if( sgui_event_queued( ) || sgui_internal_input_pending( ) )
+        return 1;
+
+    frame = sgui_internal_frame_timeout( );
+    return frame == 0;
+}
+
@@ -0,0 +1,301 @@
+/*
+ * layer.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_canvas.h"
+#include "sgui_widget.h"
+#include "sgui_pixmap.h"
+#include "sgui_skin.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* estimated memory use of a layer pixmap */
+#define PIXMAP_BYTES( w, h ) ((unsigned long)(w) * (h) * 4)
+
+
+
+struct sgui_layer
+{
+    sgui_pixmap* pixmap;    /* rendered image of the widget subtree */
+    sgui_rect area;         /* canvas area the image was rendered for */
+    unsigned long size;     /* estimated memory use of the pixmap */
+    unsigned long last_use; /* canvas layer clock value at last draw */
+    int valid;              /* non-zero if the image can be used */
+    int damaged;            /* non-zero if parts have to be rendered again */
+    sgui_rect damage;       /* widget relative area to render again */
+
+    sgui_layer* next;
+};
+
+
+
+/* memory held by the pixmap pool of a canvas, counted against the limit */
+static unsigned long pooled_bytes( const sgui_canvas* cv )
+{
+    unsigned long size = 0;
+    unsigned int i;
+
+    for( i=0; i<cv->num_pooled; ++i )
+    {
+        size += PIXMAP_BYTES( cv->pixmap_pool[i]->width,
+                              cv->pixmap_pool[i]->height );
+    }
+
+    return size;
+}
+
+/*
+    Pool the pixmap for reuse unless it is dropped to free memory, or
+    pooling it would keep more memory around than the layer limit allows.
+ */
+static void layer_drop_pixmap( sgui_canvas* cv, sgui_layer* this, int pool )
+{
+    if( this->pixmap )
+    {
+        if( pool && (cv->layer_bytes + pooled_bytes( cv )) <= cv->layer_limit )
+            sgui_canvas_release_pixmap( cv, this->pixmap );
+        else
+            sgui_pixmap_destroy( this->pixmap );
+
+        cv->layer_bytes -= this->size;
+        this->pixmap = NULL;
+        this->size = 0;
+    }
+
+    this->valid = 0;
+    this->damaged = 0;
+}
+
+/*
+    Discard pooled pixmaps, oldest first, and then the least recently used
+    layer pixmaps until size bytes fit.
+ */
+static int layer_make_room( sgui_canvas* cv, sgui_layer* keep,
+                            unsigned long size )
+{
+    sgui_layer *i, *lru;
+
+    while( cv->num_pooled &&
+           (cv->layer_bytes + pooled_bytes( cv ) + size) > cv->layer_limit )
+    {
+        sgui_pixmap_destroy( cv->pixmap_pool[0] );
+        --cv->num_pooled;
+        memmove( cv->pixmap_pool, cv->pixmap_pool + 1,
+                 cv->num_pooled * sizeof(sgui_pixmap*) );
+    }
+
+    while( (cv->layer_bytes + size) > cv->layer_limit )
+    {
+        for( lru=NULL, i=cv->layers; i!=NULL; i=i->next )
+        {
+            if( i!=keep && i->pixmap &&
+                (!lru || i->last_use < lru->last_use) )
+            {
+                lru = i;
+            }
+        }
+
+        if( !lru )
+            return 0;
+
+        layer_drop_pixmap( cv, lru, 0 );
+    }
+
+    return 1;
+}
+
+/****************************************************************************/
+
+void sgui_internal_layer_invalidate( sgui_canvas* cv, const sgui_rect* r )
+{
+    sgui_layer* i;
+
+    for( i=cv->layers; i!=NULL; i=i->next )
+    {
+        if( i->valid && sgui_rect_get_intersection( NULL, &i->area, r ) )
+            i->valid = 0;
+    }
+}
+
+void sgui_internal_layer_damage( sgui_widget* w, const sgui_rect* r )
+{
+    sgui_layer* this;
+    sgui_rect a, d;
+    int x, y;
+
+    for( ; w!=NULL; w=w->parent )
+    {
+        this = w->layer;
+
+        if( !this || !this->valid )
+            continue;
+
+        sgui_widget_get_absolute_position( w, &x, &y );
+        sgui_rect_set_size( &a, x, y, SGUI_RECT_WIDTH( w->area ),
+                            SGUI_RECT_HEIGHT( w->area ) );
+
+        if( !sgui_rect_get_intersection( &d, &a, r ) )
+            continue;
+
+        sgui_rect_add_offset( &d, -x, -y );
+
+        if( this->damaged )
+            sgui_rect_join( &this->damage, &d, 0 );
+        else
+            this->damage = d;
+
+        this->damaged = 1;
+    }
+}
+
+void sgui_internal_layer_release( sgui_widget* w )
+{
+    sgui_layer* i = NULL;
+    unsigned int n;
+
+    if( w->layer )
+    {
+        SGUI_REMOVE_FROM_LIST( w->canvas->layers, i, w->layer );
+        layer_drop_pixmap( w->canvas, w->layer, 1 );
+        sgui_internal_free( w->layer, SGUI_ALLOC_OBJECT );
+        w->layer = NULL;
+    }
+
+    for( n=0; n<w->num_children; ++n )
+        sgui_internal_layer_release( w->children[n] );
+}
+
+void sgui_internal_layer_destroy_all( sgui_canvas* cv )
+{
+    sgui_layer* old;
+
+    while( cv->layers )
+    {
+        old = cv->layers;
+        cv->layers = cv->layers->next;
+        layer_drop_pixmap( cv, old, 0 );
+        sgui_internal_free( old, SGUI_ALLOC_OBJECT );
+    }
+}
+
+int sgui_internal_layer_draw( sgui_widget* w, sgui_widget* focus )
+{
+    unsigned int width = SGUI_RECT_WIDTH( w->area );
+    unsigned int height = SGUI_RECT_HEIGHT( w->area );
+    sgui_canvas* cv = w->canvas;
+    sgui_layer* this = w->layer;
+    unsigned long size;
+    sgui_rect r, old_sc, bounds;
+    int ox, oy;
+
+    if( !cv->set_target )
+        return 0;
+
+    if( !this )
+    {
+        if( !(this = sgui_internal_calloc( 1, sizeof(sgui_layer),
+                                           SGUI_ALLOC_OBJECT )) )
+            return 0;
+
+        SGUI_ADD_TO_LIST( cv->layers, this );
+        w->layer = this;
+    }
+
+    this->last_use = ++cv->layer_clock;
+
+    r = w->area;
+    sgui_rect_add_offset( &r, cv->ox, cv->oy );
+
+    /* (re)create the pixmap if required */
+    if( this->pixmap && (SGUI_RECT_WIDTH(this->area)!=(int)width ||
+                         SGUI_RECT_HEIGHT(this->area)!=(int)height) )
+    {
+        layer_drop_pixmap( cv, this, 1 );
+    }
+
+    /* the image does not depend on where the widget is */
+    this->area = r;
+
+    if( this->valid && !this->damaged )
+        goto blit;
+
+    if( !this->pixmap )
+    {
+        size = PIXMAP_BYTES( width, height );
+
+        if( !layer_make_room( cv, this, size ) )
+            return 0;
+
+        this->pixmap = sgui_canvas_create_pixmap( cv, width, height,
+                                                  SGUI_RGB8 );
+
+        if( !this->pixmap )
+            return 0;
+
+        this->size = size;
+        cv->layer_bytes += size;
+    }
+
+    /* render the subtree, or only the damaged part of it, into the pixmap */
+    sgui_rect_set_size( &bounds, 0, 0, width, height );
+
+    if( this->valid &&
+        !sgui_rect_get_intersection( &bounds, &bounds, &this->damage ) )
+    {
+        goto done;
+    }
+
+    if( !cv->set_target( cv, this->pixmap ) )
+        return 0;
+
+    ox = cv->ox;
+    oy = cv->oy;
+    old_sc = cv->sc;
+
+    cv->ox = -w->area.left;
+    cv->oy = -w->area.top;
+    cv->sc = bounds;
+    cv->flags |= SGUI_CANVAS_LAYER;
+
+    cv->draw_box( cv, &cv->sc, sgui_skin_get( )->window_color, SGUI_RGB8 );
+    sgui_widget_draw( w, &bounds, focus );
+
+    cv->flags &= ~SGUI_CANVAS_LAYER;
+    cv->ox = ox;
+    cv->oy = oy;
+    cv->sc = old_sc;
+
+    cv->set_target( cv, NULL );
+done:
+    this->valid = 1;
+    this->damaged = 0;
+blit:
+    sgui_canvas_draw_pixmap( cv, w->area.left, w->area.top,
+                             this->pixmap, NULL, 0 );
+    return 1;
+}
@@ -457,6 +457,11 @@ static int canvas_mem_draw_string( sgui_canvas* super, int x, int y,
     return x - oldx;
 }
 
+static void canvas_mem_destroy( sgui_canvas* this )
+{
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+}
+
 static sgui_pixmap* canvas_mem_create_pixmap( sgui_canvas* this,
                                               unsigned int width,
                                               unsigned int height,
@@ -466,6 +471,13 @@ static sgui_pixmap* canvas_mem_create_pixmap( sgui_canvas* this,
                                             ((sgui_mem_canvas*)this)->swaprb);
 }
 
+static int canvas_mem_adopt_pixmap( sgui_canvas* super, sgui_pixmap* pixmap )
+{
+    sgui_mem_canvas* this = (sgui_mem_canvas*)super;
+
+    return sgui_internal_mem_pixmap_compatible( pixmap, this->swaprb );
+}
+
 /****************************************************************************/
 
 sgui_canvas* sgui_memory_canvas_create( unsigned char* buffer,
@@ -473,7 +485,8 @@ sgui_canvas* sgui_memory_canvas_create( unsigned char* buffer,
                                         unsigned int height,
                                         int format, int swaprb )
 {
-    sgui_mem_canvas* this = calloc( 1, sizeof(sgui_mem_canvas) );
+    sgui_mem_canvas* this = sgui_internal_calloc( 1, sizeof(sgui_mem_canvas),
+                                                  SGUI_ALLOC_OBJECT );
     sgui_canvas* super = (sgui_canvas*)this;
 
     if( !this )
@@ -481,7 +494,7 @@ sgui_canvas* sgui_memory_canvas_create( unsigned char* buffer,
 
     if( !sgui_memory_canvas_init(super,buffer,width,height,format,swaprb) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         this = NULL;
     }
     return (sgui_canvas*)this;
@@ -523,11 +536,12 @@ int sgui_memory_canvas_init( sgui_canvas* super, unsigned char* buffer,
         this->blend_stencil = canvas_mem_blend_stencil_rgb;
     }
 
-    super->destroy = (void(*)(sgui_canvas*))free;
+    super->destroy = canvas_mem_destroy;
     super->resize = canvas_mem_resize;
     super->clear = canvas_mem_clear;
     super->draw_string = canvas_mem_draw_string;
     super->create_pixmap = canvas_mem_create_pixmap;
+    super->adopt_pixmap = canvas_mem_adopt_pixmap;
     return 1;
 }
 
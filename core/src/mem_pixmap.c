@@ -218,8 +218,8 @@ static void mem_pixmap_destroy( sgui_pixmap* super )
 {
     mem_pixmap* this = (mem_pixmap*)super;
 
-    free( this->buffer );
-    free( this );
+    sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -234,18 +234,20 @@ sgui_pixmap* sgui_internal_mem_pixmap_create( unsigned int width,
     if( !width || !height )
         return NULL;
 
-    this = calloc( 1, sizeof(mem_pixmap) );
+    this = sgui_internal_calloc( 1, sizeof(mem_pixmap),
+                                 SGUI_MEM(MEM_PIXMAPS,OBJECT) );
     super = (sgui_pixmap*)this;
 
     if( !this )
         return NULL;
 
-    this->buffer = malloc( width*height*(format==SGUI_RGB8 ? 3 : 
-                                         format==SGUI_RGBA8 ? 4 : 1) );
+    this->buffer = sgui_internal_malloc( width*height*(format==SGUI_RGB8 ? 3 :
+                                         format==SGUI_RGBA8 ? 4 : 1),
+                                         SGUI_MEM(MEM_PIXMAPS,PIXELS) );
 
     if( !this->buffer )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -270,5 +272,11 @@ int sgui_internal_mem_pixmap_format( sgui_pixmap* this )
 {
     return ((mem_pixmap*)this)->format;
 }
+
+int sgui_internal_mem_pixmap_compatible( sgui_pixmap* this, int swaprb )
+{
+    return this->destroy==mem_pixmap_destroy &&
+           ((mem_pixmap*)this)->swaprb==swaprb;
+}
 #endif
 
@@ -52,50 +52,135 @@ const sgui_icon* sgui_item_icon( const sgui_model* this,
     return NULL;
 }
 
+unsigned int sgui_model_fetch_items( const sgui_model* this,
+                                     const sgui_item* parent,
+                                     unsigned int start, unsigned int count,
+                                     const sgui_item** items )
+{
+    const sgui_item* list;
+    unsigned int i;
+
+    if( !count )
+        return 0;
+
+    if( this->fetch_items )
+        return this->fetch_items( this, parent, start, count, items );
+
+    list = this->query_items( this, parent, start, count );
+
+    for( i=0; list && i<count; ++i, list=list->next )
+        items[i] = list;
+
+    return i;
+}
+
 /****************************************************************************/
 
+#define MIN_BLOCK_ITEMS 16
+#define MAX_BLOCK_ITEMS 1024
+
 typedef struct
 {
     sgui_item super;
 
-    sgui_item* children;
+    /*
+        The children, oldest first, so adding one is an append. The item
+        at list position i is children[num_children - 1 - i].
+     */
+    sgui_item** children;
+    unsigned int num_children;
+    unsigned int max_children;
 }
 sgui_simple_item;
 
+/* a block of items, the items follow the header */
+typedef struct item_block
+{
+    struct item_block* next;
+    unsigned int count;             /* number of items in the block */
+    unsigned int used;              /* number of items handed out */
+}
+item_block;
+
 typedef struct
 {
     sgui_model super;
 
-    sgui_item* items;
+    sgui_simple_item root;          /* parent of the top level items */
+    unsigned int item_size;         /* item header plus column data */
+    item_block* blocks;             /* block to allocate from first */
 }
 sgui_simple_model;
 
 
 
-static void destroy_itemlist( sgui_simple_model* this, sgui_item* list )
+#define ITEM_FROM_INDEX( parent, i ) \
+        ((parent)->children[ (parent)->num_children - 1 - (i) ])
+
+static sgui_simple_item* get_parent( const sgui_simple_model* this,
+                                     const sgui_item* parent )
+{
+    return parent ? (sgui_simple_item*)parent :
+                    (sgui_simple_item*)&this->root;
+}
+
+static void destroy_item( sgui_simple_model* this, sgui_simple_item* item )
 {
-    unsigned char* text;
+    unsigned char* text = (unsigned char*)item + sizeof(sgui_simple_item);
     unsigned int col;
-    sgui_item* old;
 
-    while( list )
-    {
-        destroy_itemlist( this, ((sgui_simple_item*)list)->children );
+    for( col=0; col<this->super.cols; ++col, text+=sizeof(void*)*2 )
+        sgui_internal_free( *((char**)text), SGUI_ALLOC_BUFFER );
+
+    sgui_internal_free( item->children, SGUI_ALLOC_BUFFER );
+}
 
-        old = list;
-        list = list->next;
+static sgui_simple_item* alloc_item( sgui_simple_model* this )
+{
+    item_block* block = this->blocks;
+    unsigned int count;
+    unsigned char* ptr;
 
-        text  = (unsigned char*)old;
-        text += sizeof(sgui_simple_item);
+    if( !block || block->used==block->count )
+    {
+        count = block ? block->count*2 : MIN_BLOCK_ITEMS;
+        count = count > MAX_BLOCK_ITEMS ? MAX_BLOCK_ITEMS : count;
 
-        for( col=0; col<this->super.cols; ++col )
-        {
-            free( *((char**)text) );
-            text += sizeof(void*)*2;
-        }
+        block = sgui_internal_calloc( 1, sizeof(item_block) +
+                                         count * this->item_size,
+                                      SGUI_MEM(MODEL,BUFFER) );
 
-        free( old );
+        if( !block )
+            return NULL;
+
+        block->count = count;
+        block->next = this->blocks;
+        this->blocks = block;
     }
+
+    ptr = (unsigned char*)(block + 1) + block->used++ * this->item_size;
+    sgui_internal_memory_account( SGUI_MEMORY_MODEL, 0, 1 );
+    return (sgui_simple_item*)ptr;
+}
+
+static int grow_children( sgui_simple_item* parent )
+{
+    sgui_item** new;
+    unsigned int size;
+
+    if( parent->num_children < parent->max_children )
+        return 1;
+
+    size = parent->max_children ? parent->max_children*2 : 8;
+    new = sgui_internal_realloc( parent->children, size*sizeof(sgui_item*),
+                                 SGUI_MEM(MODEL,BUFFER) );
+
+    if( !new )
+        return 0;
+
+    parent->children = new;
+    parent->max_children = size;
+    return 1;
 }
 
 
@@ -103,9 +188,27 @@ static void destroy_itemlist( sgui_simple_model* this, sgui_item* list )
 static void simple_destroy( sgui_model* super )
 {
     sgui_simple_model* this = (sgui_simple_model*)super;
+    item_block* block;
+    unsigned char* ptr;
+    unsigned int i;
+
+    while( this->blocks )
+    {
+        block = this->blocks;
+        this->blocks = block->next;
+
+        ptr = (unsigned char*)(block + 1);
+
+        for( i=0; i<block->used; ++i, ptr+=this->item_size )
+            destroy_item( this, (sgui_simple_item*)ptr );
+
+        sgui_internal_memory_account( SGUI_MEMORY_MODEL, 0,
+                                      -(long)block->used );
+        sgui_internal_free( block, SGUI_ALLOC_BUFFER );
+    }
 
-    destroy_itemlist( this, this->items );
-    free( this );
+    sgui_internal_free( this->root.children, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static const sgui_item* simple_query_items( const sgui_model* super,
@@ -114,20 +217,45 @@ static const sgui_item* simple_query_items( const sgui_model* super,
                                             unsigned int count )
 {
     const sgui_simple_model* this = (sgui_simple_model*)super;
-    const sgui_simple_item* item = (sgui_simple_item*)parent;
-    const sgui_item* list = item ? item->children : this->items;
-    unsigned int i;
+    const sgui_item* list = NULL;
+    sgui_simple_item* p;
     (void)count;
 
     sgui_internal_lock_mutex( );
+    p = get_parent( this, parent );
 
-    for( i=0; list && i<start; ++i )
-        list = list->next;
+    if( start < p->num_children )
+        list = ITEM_FROM_INDEX( p, start );
 
     sgui_internal_unlock_mutex( );
     return list;
 }
 
+static unsigned int simple_fetch_items( const sgui_model* super,
+                                        const sgui_item* parent,
+                                        unsigned int start,
+                                        unsigned int count,
+                                        const sgui_item** items )
+{
+    const sgui_simple_model* this = (sgui_simple_model*)super;
+    sgui_simple_item* p;
+    unsigned int i;
+
+    sgui_internal_lock_mutex( );
+    p = get_parent( this, parent );
+
+    if( start >= p->num_children )
+        count = 0;
+    else if( count > (p->num_children - start) )
+        count = p->num_children - start;
+
+    for( i=0; i<count; ++i )
+        items[i] = ITEM_FROM_INDEX( p, start + i );
+
+    sgui_internal_unlock_mutex( );
+    return count;
+}
+
 static unsigned int simple_item_children_count( const sgui_model* super,
                                                 const sgui_item* item )
 {
@@ -135,11 +263,7 @@ static unsigned int simple_item_children_count( const sgui_model* super,
     unsigned int count;
 
     sgui_internal_lock_mutex( );
-    item = item ? ((sgui_simple_item*)item)->children : this->items;
-
-    for( count=0; item; ++count )
-        item = item->next;
-
+    count = get_parent( this, item )->num_children;
     sgui_internal_unlock_mutex( );
 
     return count;
@@ -182,12 +306,15 @@ sgui_model* sgui_simple_model_create( unsigned int columns,
     if( !columns )
         return NULL;
 
-    this = calloc( 1, sizeof(sgui_simple_model) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_simple_model),
+                                 SGUI_MEM(MODEL,OBJECT) );
     super = (sgui_model*)this;
     
     if( !this )
         return NULL;
 
+    this->item_size = sizeof(sgui_simple_item) + sizeof(void*)*2*columns;
+
     super->cache               = cache;
     super->cols                = columns;
     super->destroy             = simple_destroy;
@@ -195,6 +322,7 @@ sgui_model* sgui_simple_model_create( unsigned int columns,
     super->item_children_count = simple_item_children_count;
     super->item_text           = simple_item_text;
     super->item_icon           = simple_item_icon;
+    super->fetch_items         = simple_fetch_items;
 
     return super;
 }
@@ -202,34 +330,26 @@ sgui_model* sgui_simple_model_create( unsigned int columns,
 sgui_item* sgui_simple_model_add_item( sgui_model* super, sgui_item* parent )
 {
     sgui_simple_model* this = (sgui_simple_model*)super;
-    sgui_item* item = NULL;
-    unsigned int size;
+    sgui_simple_item *p, *item = NULL;
 
     if( this )
     {
-        size = sizeof(sgui_simple_item) + sizeof(void*)*2*super->cols;
-        item = calloc( 1, size );
+        sgui_internal_lock_mutex( );
+        p = get_parent( this, parent );
 
-        if( item )
+        if( grow_children( p ) && (item = alloc_item( this )) )
         {
-            sgui_internal_lock_mutex( );
-
-            if( parent )
-            {
-                item->next = ((sgui_simple_item*)parent)->children;
-                ((sgui_simple_item*)parent)->children = item;
-            }
-            else
-            {
-                item->next = this->items;
-                this->items = item;
-            }
-
-            sgui_internal_unlock_mutex( );
+            /* new items go to the front of the list */
+            if( p->num_children )
+                item->super.next = ITEM_FROM_INDEX( p, 0 );
+
+            p->children[ p->num_children++ ] = (sgui_item*)item;
         }
+
+        sgui_internal_unlock_mutex( );
     }
 
-    return item;
+    return (sgui_item*)item;
 }
 
 void sgui_simple_item_set_icon( sgui_model* this, sgui_item* item,
@@ -262,10 +382,10 @@ void sgui_simple_item_set_text( sgui_model* this, sgui_item* item,
         ptr += sizeof(sgui_simple_item);
         ptr += sizeof(void*)*2*column;
 
-        free( *((char**)ptr) );
+        sgui_internal_free( *((char**)ptr), SGUI_ALLOC_BUFFER );
 
         if( text )
-            *((char**)ptr) = sgui_strdup( text );
+            *((char**)ptr) = sgui_internal_strdup( text, SGUI_MEMORY_MODEL );
 
         sgui_internal_unlock_mutex( );
     }
@@ -284,6 +404,14 @@ const sgui_icon* sgui_item_icon( const sgui_model* model,
     (void)model; (void)item; (void)column;
     return NULL;
 }
+unsigned int sgui_model_fetch_items( const sgui_model* model,
+                                     const sgui_item* parent,
+                                     unsigned int start, unsigned int count,
+                                     const sgui_item** items )
+{
+    (void)model; (void)parent; (void)start; (void)count; (void)items;
+    return 0;
+}
 sgui_model* sgui_simple_model_create( unsigned int columns,
                                       sgui_icon_cache* cache )
 {
@@ -0,0 +1,254 @@
+/*
+ * pool.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* alignment of pool objects and scratch allocations */
+typedef union
+{
+    long l;
+    void* p;
+#ifndef SGUI_NO_FLOAT
+    double d;
+#endif
+}
+align_t;
+
+#define ALIGN( size ) (((size) + sizeof(align_t) - 1) & ~(sizeof(align_t)-1))
+
+
+
+/* a slab of objects, the objects follow the header */
+typedef struct slab
+{
+    struct slab* next;
+    align_t pad;
+}
+slab;
+
+typedef struct
+{
+    unsigned int size;          /* object size, zero until first use */
+    void* free_list;            /* free objects, linked through their data */
+    slab* slabs;
+    unsigned long used;         /* bytes in allocated objects */
+}
+pool;
+
+/* a chunk of the scratch arena, the memory follows the header */
+typedef struct chunk
+{
+    struct chunk* next;
+    unsigned long size;
+    unsigned long top;
+    align_t pad;
+}
+chunk;
+
+
+
+static pool pools[ SGUI_NUM_POOLS ];
+
+/* memory category that slabs and objects of each pool are accounted to */
+static const int categories[ SGUI_NUM_POOLS ] =
+{
+    SGUI_MEMORY_EVENTS,         /* SGUI_POOL_LISTENER */
+    SGUI_MEMORY_GLYPHS,         /* SGUI_POOL_GLYPH */
+    SGUI_MEMORY_ICONS,          /* SGUI_POOL_ICON */
+    SGUI_MEMORY_OTHER,          /* SGUI_POOL_DIRTY */
+    SGUI_MEMORY_OTHER,          /* SGUI_POOL_TIMER */
+    SGUI_MEMORY_OTHER           /* SGUI_POOL_TASK */
+};
+
+static chunk* chunks = NULL;            /* current chunk first */
+static unsigned int outstanding = 0;    /* live scratch allocations */
+
+
+
+static int new_slab( pool* p, int category )
+{
+    unsigned int i, count;
+    char* obj;
+    slab* s;
+
+    count = (SGUI_POOL_SLAB_SIZE - sizeof(slab)) / p->size;
+    count = count ? count : 1;
+
+    if( !(s = sgui_internal_malloc( sizeof(slab) + count * p->size,
+                                    (category << 4) | SGUI_ALLOC_BUFFER )) )
+        return 0;
+
+    s->next = p->slabs;
+    p->slabs = s;
+
+    for( obj=(char*)(s + 1), i=0; i<count; ++i, obj+=p->size )
+    {
+        *((void**)obj) = p->free_list;
+        p->free_list = obj;
+    }
+    return 1;
+}
+
+static void free_chunks( chunk* c )
+{
+    chunk* next;
+
+    for( ; c!=NULL; c=next )
+    {
+        next = c->next;
+        sgui_internal_free( c, SGUI_ALLOC_BUFFER );
+    }
+}
+
+/****************************************************************************/
+
+void* sgui_internal_pool_alloc( int type, unsigned int size )
+{
+    pool* p = pools + type;
+    void* obj = NULL;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    if( !p->size )
+        p->size = size < sizeof(void*) ? ALIGN(sizeof(void*)) : ALIGN(size);
+
+    if( p->free_list || new_slab( p, categories[type] ) )
+    {
+        obj = p->free_list;
+        p->free_list = *((void**)obj);
+        p->used += p->size;
+        memset( obj, 0, p->size );
+        sgui_internal_memory_account( categories[type], 0, 1 );
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+    return obj;
+}
+
+void sgui_internal_pool_free( int type, void* obj )
+{
+    pool* p = pools + type;
+
+    if( !obj )
+        return;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+    *((void**)obj) = p->free_list;
+    p->free_list = obj;
+    p->used -= p->size;
+    sgui_internal_memory_account( categories[type], 0, -1 );
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+}
+
+void* sgui_internal_scratch_alloc( unsigned long size )
+{
+    unsigned long chunk_size;
+    void* ptr = NULL;
+    chunk* c;
+
+    size = ALIGN( size );
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    if( !chunks || (chunks->size - chunks->top) < size )
+    {
+        chunk_size = size > SGUI_SCRATCH_CHUNK_SIZE ?
+                     size : SGUI_SCRATCH_CHUNK_SIZE;
+
+        if( !(c = sgui_internal_malloc( sizeof(chunk) + chunk_size,
+                                       SGUI_ALLOC_BUFFER )) )
+            goto out;
+
+        c->size = chunk_size;
+        c->top = 0;
+        c->next = chunks;
+        chunks = c;
+    }
+
+    ptr = (char*)(chunks + 1) + chunks->top;
+    chunks->top += size;
+    ++outstanding;
+out:
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+    return ptr;
+}
+
+void sgui_internal_scratch_free( void* ptr )
+{
+    if( !ptr )
+        return;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    /*
+        Nothing is given back until all outstanding scratch memory is
+        freed. Then the arena starts over in the newest chunk, which is
+        kept around for the next allocation.
+     */
+    if( --outstanding == 0 )
+    {
+        free_chunks( chunks->next );
+        chunks->next = NULL;
+        chunks->top = 0;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+}
+
+void sgui_internal_pool_reset( void )
+{
+    slab *s, *next;
+    int i;
+
+    sgui_internal_lock( SGUI_LOCK_POOL );
+
+    /* objects that are still in use are leaked rather than freed */
+    for( i=0; i<SGUI_NUM_POOLS; ++i )
+    {
+        if( pools[i].used )
+            continue;
+
+        for( s=pools[i].slabs; s!=NULL; s=next )
+        {
+            next = s->next;
+            sgui_internal_free( s, SGUI_ALLOC_BUFFER );
+        }
+
+        memset( pools + i, 0, sizeof(pools[i]) );
+    }
+
+    if( !outstanding )
+    {
+        free_chunks( chunks );
+        chunks = NULL;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_POOL );
+}
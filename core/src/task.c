@@ -0,0 +1,284 @@
+/*
+ * task.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_event.h"
+#include "sgui_task.h"
+
+#include <stdlib.h>
+
+
+
+typedef enum
+{
+    TASK_QUEUED = 0,                /* waiting for a worker thread */
+    TASK_RUNNING = 1,               /* work function is being called */
+    TASK_FINISHED = 2               /* completion event posted */
+}
+TASK_STATE;
+
+struct sgui_task
+{
+    sgui_task_function work;
+    sgui_task_callback done;
+    void* data;
+
+    int state;
+    volatile int canceled;
+
+    sgui_task* next;
+};
+
+
+
+static void* workers[ SGUI_TASK_THREADS ];
+static unsigned int num_workers = 0;
+static void* sem = NULL;            /* counts queued tasks */
+static int stopping = 0;            /* set by sgui_internal_task_deinit */
+
+static sgui_task* queue_head = NULL;    /* queued, oldest first */
+static sgui_task* queue_tail = NULL;
+static sgui_task* finished = NULL;      /* completion event not handled */
+
+
+
+/* called with the task lock held */
+static void finish( sgui_task* t )
+{
+    sgui_event ev;
+
+    t->state = TASK_FINISHED;
+    t->next = finished;
+    finished = t;
+
+    ev.src.other = t;
+    ev.type = SGUI_TASK_DONE_EVENT;
+    sgui_event_post( &ev );
+}
+
+static void worker( void* arg )
+{
+    sgui_task* t;
+    (void)arg;
+
+    while( 1 )
+    {
+        sgui_internal_semaphore_wait( sem );
+        sgui_internal_lock( SGUI_LOCK_TASK );
+
+        if( stopping )
+            break;
+
+        /* a canceled task may have left the queue already */
+        if( !(t = queue_head) )
+        {
+            sgui_internal_unlock( SGUI_LOCK_TASK );
+            continue;
+        }
+
+        queue_head = t->next;
+        if( !queue_head )
+            queue_tail = NULL;
+
+        t->state = TASK_RUNNING;
+        sgui_internal_unlock( SGUI_LOCK_TASK );
+
+        t->work( t, t->data );
+
+        sgui_internal_lock( SGUI_LOCK_TASK );
+        finish( t );
+        sgui_internal_unlock( SGUI_LOCK_TASK );
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+}
+
+/* event listener, called on the main loop thread */
+static void task_done( void* receiver, const sgui_event* e )
+{
+    sgui_task *t = e->src.other, *i;
+    (void)receiver;
+
+    sgui_internal_lock( SGUI_LOCK_TASK );
+    SGUI_REMOVE_FROM_LIST( finished, i, t );
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+
+    if( t->done )
+    {
+        t->done( t, t->canceled ? SGUI_TASK_CANCELED : SGUI_TASK_DONE,
+                 t->data );
+    }
+
+    sgui_internal_pool_free( SGUI_POOL_TASK, t );
+}
+
+/* called with the task lock held */
+static int start_workers( void )
+{
+    if( !(sem = sgui_internal_semaphore_create( )) )
+        return 0;
+
+    for( ; num_workers<SGUI_TASK_THREADS; ++num_workers )
+    {
+        workers[ num_workers ] = sgui_internal_thread_create( worker, NULL );
+
+        if( !workers[ num_workers ] )
+            break;
+    }
+
+    if( !num_workers )
+    {
+        sgui_internal_semaphore_destroy( sem );
+        sem = NULL;
+        return 0;
+    }
+
+    return 1;
+}
+
+int sgui_internal_task_init( void )
+{
+    return sgui_event_connect_event( NULL, SGUI_TASK_DONE_EVENT,
+                                     task_done, NULL );
+}
+
+void sgui_internal_task_deinit( void )
+{
+    sgui_task* t;
+    unsigned int i;
+
+    sgui_internal_lock( SGUI_LOCK_TASK );
+    stopping = 1;
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+
+    for( i=0; i<num_workers; ++i )
+        sgui_internal_semaphore_post( sem );
+
+    for( i=0; i<num_workers; ++i )
+        sgui_internal_thread_join( workers[ i ] );
+
+    if( sem )
+        sgui_internal_semaphore_destroy( sem );
+
+    sgui_internal_lock( SGUI_LOCK_TASK );
+
+    while( queue_head )
+    {
+        t = queue_head;
+        queue_head = t->next;
+        sgui_internal_pool_free( SGUI_POOL_TASK, t );
+    }
+
+    while( finished )
+    {
+        t = finished;
+        finished = t->next;
+        sgui_internal_pool_free( SGUI_POOL_TASK, t );
+    }
+
+    queue_tail = NULL;
+    num_workers = 0;
+    stopping = 0;
+    sem = NULL;
+
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+}
+
+/****************************************************************************/
+
+sgui_task* sgui_task_submit( sgui_task_function work,
+                             sgui_task_callback done, void* data )
+{
+    sgui_task* this;
+
+    if( !work )
+        return NULL;
+
+    this = sgui_internal_pool_alloc( SGUI_POOL_TASK, sizeof(sgui_task) );
+
+    if( !this )
+        return NULL;
+
+    this->work = work;
+    this->done = done;
+    this->data = data;
+    this->state = TASK_QUEUED;
+
+    sgui_internal_lock( SGUI_LOCK_TASK );
+
+    if( !num_workers && !start_workers( ) )
+    {
+        sgui_internal_unlock( SGUI_LOCK_TASK );
+        sgui_internal_pool_free( SGUI_POOL_TASK, this );
+        return NULL;
+    }
+
+    if( queue_tail )
+        queue_tail->next = this;
+    else
+        queue_head = this;
+
+    queue_tail = this;
+
+    sgui_internal_semaphore_post( sem );
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+    return this;
+}
+
+int sgui_task_cancel( sgui_task* this )
+{
+    sgui_task *i, *prev;
+    int ret = 0;
+
+    sgui_internal_lock( SGUI_LOCK_TASK );
+
+    if( this->state != TASK_FINISHED )
+        this->canceled = 1;
+
+    if( this->state == TASK_QUEUED )
+    {
+        for( prev=NULL, i=queue_head; i && i!=this; prev=i, i=i->next );
+
+        if( prev )
+            prev->next = this->next;
+        else
+            queue_head = this->next;
+
+        if( queue_tail == this )
+            queue_tail = prev;
+
+        finish( this );
+        ret = 1;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_TASK );
+    return ret;
+}
+
+int sgui_task_is_canceled( sgui_task* this )
+{
+    return this->canceled;
+}
+
@@ -0,0 +1,286 @@
+/*
+ * timer.c
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_internal.h"
+#include "sgui_loop.h"
+
+#include <stdlib.h>
+
+
+
+/* heap index of a timer that is not waiting to expire */
+#define NOT_QUEUED ((unsigned int)-1)
+
+/* non-zero if time stamp a is before or equal to b, handles wrap around */
+#define NOT_AFTER( a, b ) ((long)((a) - (b)) <= 0)
+
+
+
+struct sgui_timer
+{
+    unsigned long deadline;         /* time stamp when the timer expires */
+    unsigned long interval;         /* period of a periodic timer in ms */
+    int periodic;
+
+    sgui_timer_callback callback;
+    void* user;
+
+    unsigned int index;             /* position in the heap */
+    int running;                    /* non-zero while calling callback */
+    int destroyed;                  /* destroyed from within the callback */
+};
+
+
+
+/* binary min-heap of the timers, ordered by deadline */
+static sgui_timer** heap = NULL;
+static unsigned int num_timers = 0;
+static unsigned int max_timers = 0;
+
+
+
+static void heap_set( unsigned int i, sgui_timer* t )
+{
+    heap[ i ] = t;
+    t->index = i;
+}
+
+static void sift_up( unsigned int i )
+{
+    sgui_timer* t = heap[ i ];
+    unsigned int parent;
+
+    while( i )
+    {
+        parent = (i - 1) / 2;
+
+        if( NOT_AFTER( heap[ parent ]->deadline, t->deadline ) )
+            break;
+
+        heap_set( i, heap[ parent ] );
+        i = parent;
+    }
+
+    heap_set( i, t );
+}
+
+static void sift_down( unsigned int i )
+{
+    sgui_timer* t = heap[ i ];
+    unsigned int child;
+
+    while( (child = 2*i + 1) < num_timers )
+    {
+        if( child+1 < num_timers &&
+            !NOT_AFTER( heap[ child ]->deadline, heap[ child+1 ]->deadline ) )
+        {
+            ++child;
+        }
+
+        if( NOT_AFTER( t->deadline, heap[ child ]->deadline ) )
+            break;
+
+        heap_set( i, heap[ child ] );
+        i = child;
+    }
+
+    heap_set( i, t );
+}
+
+static int heap_insert( sgui_timer* t )
+{
+    sgui_timer** new_heap;
+    unsigned int new_max;
+
+    if( num_timers == max_timers )
+    {
+        new_max = max_timers ? max_timers*2 : 16;
+        new_heap = sgui_internal_realloc( heap, sizeof(sgui_timer*) * new_max,
+                                          SGUI_ALLOC_BUFFER );
+
+        if( !new_heap )
+            return 0;
+
+        heap = new_heap;
+        max_timers = new_max;
+    }
+
+    heap_set( num_timers++, t );
+    sift_up( t->index );
+    return 1;
+}
+
+static void heap_remove( sgui_timer* t )
+{
+    unsigned int i = t->index;
+    sgui_timer* last;
+
+    t->index = NOT_QUEUED;
+
+    if( i != --num_timers )
+    {
+        last = heap[ num_timers ];
+        heap_set( i, last );
+        sift_up( i );
+        sift_down( last->index );
+    }
+}
+
+/****************************************************************************/
+
+long sgui_internal_timer_timeout( void )
+{
+    unsigned long now;
+    long timeout = -1;
+
+    sgui_internal_lock( SGUI_LOCK_TIMER );
+
+    if( num_timers )
+    {
+        now = sgui_internal_get_time_ms( );
+
+        if( !NOT_AFTER( heap[0]->deadline, now ) )
+            timeout = (long)(heap[0]->deadline - now);
+        else
+            timeout = 0;
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_TIMER );
+    return timeout;
+}
+
+void sgui_internal_timer_run( void )
+{
+    unsigned long now;
+    sgui_timer* t;
+
+    sgui_internal_lock( SGUI_LOCK_TIMER );
+
+    now = sgui_internal_get_time_ms( );
+
+    while( num_timers && NOT_AFTER( heap[0]->deadline, now ) )
+    {
+        t = heap[0];
+        heap_remove( t );
+
+        /* call the callback without holding a lock */
+        t->running = 1;
+        sgui_internal_unlock( SGUI_LOCK_TIMER );
+        t->callback( t, t->user );
+        sgui_internal_lock( SGUI_LOCK_TIMER );
+        t->running = 0;
+
+        if( t->destroyed )
+        {
+            sgui_internal_pool_free( SGUI_POOL_TIMER, t );
+            continue;
+        }
+
+        if( t->periodic && t->index == NOT_QUEUED )
+        {
+            /* skip missed periods instead of firing in a burst */
+            t->deadline += t->interval;
+
+            if( NOT_AFTER( t->deadline, now ) )
+                t->deadline = now + t->interval;
+
+            heap_insert( t );
+        }
+    }
+
+    sgui_internal_unlock( SGUI_LOCK_TIMER );
+}
+
+void sgui_internal_timer_reset( void )
+{
+    unsigned int i;
+
+    sgui_internal_lock( SGUI_LOCK_TIMER );
+
+    for( i=0; i<num_timers; ++i )
+        sgui_internal_pool_free( SGUI_POOL_TIMER, heap[ i ] );
+
+    sgui_internal_free( heap, SGUI_ALLOC_BUFFER );
+    heap = NULL;
+    num_timers = max_timers = 0;
+
+    sgui_internal_unlock( SGUI_LOCK_TIMER );
+}
+
+/****************************************************************************/
+
+sgui_timer* sgui_timer_create( unsigned long ms, int periodic,
+                               sgui_timer_callback callback, void* user )
+{
+    sgui_timer* this;
+
+    if( !callback )
+        return NULL;
+
+    this = sgui_internal_pool_alloc( SGUI_POOL_TIMER, sizeof(sgui_timer) );
+
+    if( !this )
+        return NULL;
+
+    this->interval = ms ? ms : 1;
+    this->periodic = periodic;
+    this->callback = callback;
+    this->user = user;
+
+    sgui_internal_lock( SGUI_LOCK_TIMER );
+    this->deadline = sgui_internal_get_time_ms( ) + ms;
+
+    if( !heap_insert( this ) )
+    {
+        sgui_internal_pool_free( SGUI_POOL_TIMER, this );
+        this = NULL;
+    }
+    sgui_internal_unlock( SGUI_LOCK_TIMER );
+
+    /* the main loop has to recompute how long it may sleep */
+    if( this )
+        sgui_internal_wake_main_loop( );
+
+    return this;
+}
+
+void sgui_timer_destroy( sgui_timer* this )
+{
+    if( !this )
+        return;
+
+    sgui_internal_lock( SGUI_LOCK_TIMER );
+
+    if( this->index != NOT_QUEUED )
+        heap_remove( this );
+
+    if( this->running )
+        this->destroyed = 1;
+    else
+        sgui_internal_pool_free( SGUI_POOL_TIMER, this );
+
+    sgui_internal_unlock( SGUI_LOCK_TIMER );
+}
+
@@ -28,36 +28,260 @@
 #include "sgui_internal.h"
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 
-static void propagate_canvas( sgui_widget* i )
+/* horizontal/vertical content offset that applies to a widget */
+#define SCROLL_X( w ) (((w)->parent && !((w)->flags & SGUI_WIDGET_FIXED)) ?\
+                       (w)->parent->scroll_x : 0)
+
+#define SCROLL_Y( w ) (((w)->parent && !((w)->flags & SGUI_WIDGET_FIXED)) ?\
+                       (w)->parent->scroll_y : 0)
+
+
+
+/* deferred changes of the current widget tree transaction */
+static struct
+{
+    unsigned int depth;     /* nesting depth of begin/commit calls */
+    sgui_widget** list;     /* widgets with deferred changes */
+    unsigned int used;      /* number of entries in the list */
+    unsigned int size;      /* maximum number of entries in the list */
+    unsigned int next;      /* next entry to flush when committing */
+}
+transaction;
+
+
+
+/* add a widget to the transaction list, returns zero if not deferred */
+static int defer( sgui_widget* this )
+{
+    sgui_widget** new;
+    unsigned int size;
+
+    if( !transaction.depth )
+        return 0;
+
+    if( this->pending.listed )
+        return 1;
+
+    if( transaction.used == transaction.size )
+    {
+        size = transaction.size ? transaction.size*2 : 16;
+        new = sgui_internal_realloc( transaction.list,
+                                     size*sizeof(sgui_widget*),
+                                     SGUI_MEM(WIDGETS,BUFFER) );
+
+        if( !new )
+            return 0;
+
+        transaction.list = new;
+        transaction.size = size;
+    }
+
+    transaction.list[ transaction.used++ ] = this;
+    this->pending.listed = 1;
+    return 1;
+}
+
+/* flag the area of a widget as dirty if it is visible */
+static void damage( sgui_widget* this )
+{
+    sgui_rect r;
+
+    if( defer( this ) )
+    {
+        /* remember where the widget was before the transaction */
+        if( !this->pending.damaged )
+        {
+            this->pending.damaged = 1;
+            this->pending.canvas = NULL;
+
+            if( this->canvas && sgui_widget_is_absolute_visible( this ) )
+            {
+                sgui_widget_get_absolute_rect( this, &this->pending.area );
+                this->pending.canvas = this->canvas;
+            }
+        }
+    }
+    else if( this->canvas && sgui_widget_is_absolute_visible( this ) )
+    {
+        sgui_widget_get_absolute_rect( this, &r );
+
+        /* moving or showing a widget does not change its own layer */
+        if( this->parent )
+            sgui_internal_layer_damage( this->parent, &r );
+
+        sgui_internal_canvas_add_dirty_rect( this->canvas, &r );
+    }
+}
+
+/* call the state change callback of a widget */
+static void notify( sgui_widget* this, int change )
+{
+    if( !this->state_change_event )
+        return;
+
+    if( defer( this ) )
+        this->pending.changes |= change;
+    else
+        this->state_change_event( this, change );
+}
+
+/* apply the deferred changes of a widget */
+static void flush( sgui_widget* this )
+{
+    int changes = this->pending.changes;
+    sgui_canvas* old = this->pending.canvas;
+    int damaged = this->pending.damaged;
+    sgui_rect r = this->pending.area;
+
+    memset( &this->pending, 0, sizeof(this->pending) );
+
+    if( damaged )
+    {
+        /* the widget may have left the layers it was drawn into */
+        if( old )
+            sgui_canvas_add_dirty_rect( old, &r );
+
+        damage( this );
+    }
+
+    if( changes && this->state_change_event )
+        this->state_change_event( this, changes );
+}
+
+/* drop the spatial index of a widget, e.g. if running out of memory */
+static void drop_grid( sgui_widget* this )
+{
+    if( this->grid )
+    {
+        sgui_internal_grid_destroy( this->grid );
+        this->grid = NULL;
+    }
+}
+
+/* free the resources managed by the widget base and destroy a widget */
+static void destroy_widget( sgui_widget* this )
+{
+    sgui_widget** children = this->children;
+    unsigned int i;
+
+    drop_grid( this );
+
+    if( this->pending.listed )
+    {
+        for( i=transaction.next; i<transaction.used; ++i )
+        {
+            if( transaction.list[i]==this )
+                transaction.list[i] = NULL;
+        }
+    }
+
+    /* the destroy callback may still look at its children */
+    this->destroy( this );
+    sgui_internal_free( children, SGUI_ALLOC_BUFFER );
+}
+
+/* make room for at least one more entry in the children array */
+static int grow_children( sgui_widget* this )
+{
+    sgui_widget** new;
+    unsigned int size;
+
+    if( this->num_children < this->max_children )
+        return 1;
+
+    size = this->max_children ? this->max_children*2 : 4;
+    new = sgui_internal_realloc( this->children, size*sizeof(sgui_widget*),
+                                 SGUI_MEM(WIDGETS,BUFFER) );
+
+    if( !new )
+        return 0;
+
+    this->children = new;
+    this->max_children = size;
+    return 1;
+}
+
+/* update the stacking order of all children, starting at a given index */
+static void renumber_children( sgui_widget* this, unsigned int i )
+{
+    for( ; i<this->num_children; ++i )
+        this->children[i]->index = i;
+}
+
+static sgui_widget* next_sibling( const sgui_widget* this )
+{
+    const sgui_widget* p = this ? this->parent : NULL;
+
+    if( !p || (this->index + 1) >= p->num_children )
+        return NULL;
+
+    return p->children[ this->index + 1 ];
+}
+
+static void propagate_canvas( sgui_widget* this )
 {
-    for( ; i!=NULL; i=i->next )
+    unsigned int i;
+
+    for( i=0; i<this->num_children; ++i )
     {
-        i->canvas = i->parent->canvas;
-        propagate_canvas( i->children );
+        this->children[i]->canvas = this->canvas;
+        propagate_canvas( this->children[i] );
     }
 }
 
-static void propagat_state_change( sgui_widget* i, int change )
+static void propagat_state_change( sgui_widget* this, int change )
 {
-    for( ; i!=NULL; i=i->next )
+    sgui_widget* w;
+    unsigned int i;
+
+    for( i=0; i<this->num_children; ++i )
     {
-        if( i->state_change_event )
-            i->state_change_event( i, change );
+        w = this->children[i];
+        notify( w, change );
+        propagat_state_change( w, change );
+    }
+}
+
+/* move a widget to a different position in the stacking order */
+static void restack( sgui_widget* this, unsigned int to )
+{
+    sgui_widget* p = this->parent;
+    unsigned int from = this->index;
 
-        propagat_state_change( i->children, change );
+    if( !p || from==to )
+        return;
+
+    if( from < to )
+    {
+        memmove( p->children + from, p->children + from + 1,
+                 (to - from) * sizeof(sgui_widget*) );
+    }
+    else
+    {
+        memmove( p->children + to + 1, p->children + to,
+                 (from - to) * sizeof(sgui_widget*) );
     }
+
+    p->children[ to ] = this;
+    renumber_children( p, from < to ? from : to );
+    damage( this );
 }
 
 static sgui_widget* find_child_focus( const sgui_widget* this )
 {
     sgui_widget* candidate = NULL;
     sgui_widget* w;
+    unsigned int i;
 
-    for( w=this->children; w!=NULL; w=w->next )
+    for( i=0; i<this->num_children; ++i )
     {
+        w = this->children[i];
+
         if( w->flags & SGUI_WIDGET_VISIBLE )
         {
             if( w->flags & SGUI_FOCUS_ACCEPT )
@@ -70,6 +294,85 @@ static sgui_widget* find_child_focus( const sgui_widget* this )
     return candidate;
 }
 
+/*
+    Returns the last child of a widget at absolute position x,y whose subtree
+    paints every pixel of the absolute rectangle r, i.e. the child from which
+    drawing has to start to fill r.
+ */
+static const sgui_widget* find_opaque_cover( const sgui_widget* this,
+                                             int x, int y,
+                                             const sgui_rect* r )
+{
+    const sgui_widget* i;
+    unsigned int j;
+    sgui_rect a;
+
+    for( j=this->num_children; j-- > 0; )
+    {
+        i = this->children[j];
+
+        if( !(i->flags & SGUI_WIDGET_VISIBLE) )
+            continue;
+
+        a = i->area;
+        sgui_rect_add_offset( &a, x - SCROLL_X( i ), y - SCROLL_Y( i ) );
+
+        if( r->left < a.left || r->right  > a.right ||
+            r->top  < a.top  || r->bottom > a.bottom )
+        {
+            continue;
+        }
+
+        if( (i->flags & SGUI_WIDGET_OPAQUE) ||
+            find_opaque_cover( i, a.left, a.top, r ) )
+        {
+            return i;
+        }
+    }
+
+    return NULL;
+}
+
+int sgui_internal_widget_covers( const sgui_widget* this, const sgui_rect* r )
+{
+    const sgui_widget* i;
+    sgui_rect a;
+    int x, y;
+
+    sgui_internal_lock_mutex( );
+
+    for( i=this; i!=NULL; i=i->parent )
+    {
+        if( !(i->flags & SGUI_WIDGET_VISIBLE) )
+            break;
+    }
+
+    if( i )
+    {
+        x = 0;
+    }
+    else
+    {
+        sgui_widget_get_absolute_position( this, &x, &y );
+        a = this->area;
+        sgui_rect_set_position( &a, x, y );
+
+        if( r->left < a.left || r->right  > a.right ||
+            r->top  < a.top  || r->bottom > a.bottom )
+        {
+            x = 0;
+        }
+        else
+        {
+            x = (this->flags & SGUI_WIDGET_OPAQUE) ||
+                find_opaque_cover( this, x, y, r )!=NULL;
+        }
+    }
+
+    sgui_internal_unlock_mutex( );
+    return x;
+}
+
 /****************************************************************************/
 
 void sgui_widget_init( sgui_widget* this, int x, int y,
@@ -81,17 +384,30 @@ void sgui_widget_init( sgui_widget* this, int x, int y,
                   SGUI_FOCUS_DROP_ESC|SGUI_FOCUS_DROP_TAB|SGUI_WIDGET_VISIBLE;
 }
 
+void sgui_widget_destroy( sgui_widget* this )
+{
+    sgui_internal_lock_mutex( );
+    destroy_widget( this );
+    sgui_internal_unlock_mutex( );
+}
+
 void sgui_widget_destroy_children( sgui_widget* this )
 {
     sgui_widget* old;
 
     sgui_internal_lock_mutex( );
 
-    while( this->children!=NULL )
+    while( this->num_children )
     {
-        old = this->children;
-        this->children = this->children->next;
-        old->destroy( old );
+        old = this->children[ --this->num_children ];
+
+        if( this->grid )
+            sgui_internal_grid_remove( this->grid, old );
+
+        if( old->canvas )
+            sgui_internal_layer_release( old );
+
+        destroy_widget( old );
     }
 
     sgui_internal_unlock_mutex( );
@@ -99,11 +415,11 @@ void sgui_widget_destroy_children( sgui_widget* this )
 
 void sgui_widget_destroy_all_children( sgui_widget* this )
 {
-    sgui_widget* i;
+    unsigned int i;
 
     sgui_internal_lock_mutex( );
-    for( i=this->children; i!=NULL; i=i->next )
-        sgui_widget_destroy_all_children( i );
+    for( i=0; i<this->num_children; ++i )
+        sgui_widget_destroy_all_children( this->children[i] );
 
     sgui_widget_destroy_children( this );
     sgui_internal_unlock_mutex( );
@@ -111,29 +427,152 @@ void sgui_widget_destroy_all_children( sgui_widget* this )
 
 void sgui_widget_set_position( sgui_widget* this, int x, int y )
 {
-    sgui_rect r;
-    int visible;
+    sgui_internal_lock_mutex( );
+
+    damage( this );
+    sgui_rect_set_position( &this->area, x, y );
+    sgui_internal_widget_update_index( this );
+    damage( this );
+
+    notify( this, SGUI_WIDGET_POSITION_CHANGED );
+
+    sgui_internal_unlock_mutex( );
+}
+
+void sgui_widget_set_content_offset( sgui_widget* this, int x, int y,
+                                     const sgui_rect* view )
+{
+    const sgui_widget *i, *j;
+    sgui_widget* w;
+    sgui_rect r, v, s;
+    unsigned int k;
+    int dx, dy;
 
     sgui_internal_lock_mutex( );
 
-    visible = sgui_widget_is_absolute_visible( this );
+    dx = x - this->scroll_x;
+    dy = y - this->scroll_y;
 
-    if( visible && this->canvas )
+    if( !dx && !dy )
+        goto out;
+
+    this->scroll_x = x;
+    this->scroll_y = y;
+
+    if( this->canvas && sgui_widget_is_absolute_visible( this ) )
     {
         sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
+
+        if( !view )
+            goto redraw;
+
+        sgui_widget_get_absolute_position( this, &x, &y );
+        v = *view;
+        sgui_rect_add_offset( &v, x, y );
+
+        if( !sgui_rect_get_intersection( &v, &v, &r ) )
+            goto redraw;
+
+        /* can't move pixels if something is drawn on top of the view */
+        for( i=this; i->parent!=NULL; i=i->parent )
+        {
+            for( j=next_sibling( i ); j!=NULL; j=next_sibling( j ) )
+            {
+                if( !(j->flags & SGUI_WIDGET_VISIBLE) )
+                    continue;
+
+                sgui_widget_get_absolute_rect( j, &s );
+
+                if( sgui_rect_get_intersection( NULL, &s, &v ) )
+                    goto redraw;
+            }
+        }
+
+        sgui_canvas_scroll_area( this->canvas, &v, -dx, -dy );
+        sgui_internal_layer_damage( this, &v );
+
+        /* redraw everything around the view */
+        if( v.top > r.top )
+        {
+            SGUI_RECT_SET( s, r.left, r.top, r.right, v.top-1 );
+            sgui_widget_add_dirty_rect( this, &s );
+        }
+        if( v.bottom < r.bottom )
+        {
+            SGUI_RECT_SET( s, r.left, v.bottom+1, r.right, r.bottom );
+            sgui_widget_add_dirty_rect( this, &s );
+        }
+        if( v.left > r.left )
+        {
+            SGUI_RECT_SET( s, r.left, v.top, v.left-1, v.bottom );
+            sgui_widget_add_dirty_rect( this, &s );
+        }
+        if( v.right < r.right )
+        {
+            SGUI_RECT_SET( s, v.right+1, v.top, r.right, v.bottom );
+            sgui_widget_add_dirty_rect( this, &s );
+        }
     }
 
-    sgui_rect_set_position( &this->area, x, y );
+    goto notify;
+redraw:
+    sgui_widget_add_dirty_rect( this, &r );
+notify:
+    /* tell the scrolled children that depend on their absolute position */
+    for( k=0; k<this->num_children; ++k )
+    {
+        w = this->children[k];
 
-    if( visible && this->canvas )
+        if( (w->flags & (SGUI_WIDGET_FIXED|SGUI_WIDGET_TRACK_POSITION)) ==
+            SGUI_WIDGET_TRACK_POSITION )
+        {
+            notify( w, SGUI_WIDGET_POSITION_CHANGED );
+        }
+    }
+out:
+    sgui_internal_unlock_mutex( );
+}
+
+int sgui_widget_set_spatial_index( sgui_widget* this,
+                                   unsigned int cell_size )
+{
+    unsigned int i;
+    int ret = 1;
+
+    sgui_internal_lock_mutex( );
+
+    drop_grid( this );
+
+    if( cell_size )
     {
-        sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
+        this->grid = sgui_internal_grid_create( cell_size );
+
+        for( i=0; i<this->num_children && this->grid; ++i )
+        {
+            if( !sgui_internal_grid_insert( this->grid, this->children[i] ) )
+                drop_grid( this );
+        }
+
+        ret = (this->grid != NULL);
     }
 
-    if( this->state_change_event )
-        this->state_change_event( this, SGUI_WIDGET_POSITION_CHANGED );
+    sgui_internal_unlock_mutex( );
+    return ret;
+}
+
+void sgui_internal_widget_update_index( sgui_widget* this )
+{
+    sgui_grid* grid;
+
+    sgui_internal_lock_mutex( );
+
+    if( this->parent && (grid = this->parent->grid) )
+    {
+        sgui_internal_grid_remove( grid, this );
+
+        if( !sgui_internal_grid_insert( grid, this ) )
+            drop_grid( this->parent );
+    }
 
     sgui_internal_unlock_mutex( );
 }
@@ -147,13 +586,29 @@ void sgui_widget_get_absolute_position( const sgui_widget* this,
 
     for( *x=0, *y=0, i=this; i!=NULL; i=i->parent )
     {
-        *x += i->area.left;
-        *y += i->area.top;
+        *x += i->area.left - SCROLL_X( i );
+        *y += i->area.top  - SCROLL_Y( i );
     }
 
     sgui_internal_unlock_mutex( );
 }
 
+void sgui_widget_set_size( sgui_widget* this, unsigned int width,
+                           unsigned int height )
+{
+    sgui_internal_lock_mutex( );
+
+    damage( this );
+    sgui_rect_set_size( &this->area, this->area.left, this->area.top,
+                        width, height );
+    sgui_internal_widget_update_index( this );
+    damage( this );
+
+    notify( this, SGUI_WIDGET_SIZE_CHANGED );
+
+    sgui_internal_unlock_mutex( );
+}
+
 void sgui_widget_get_size( const sgui_widget* this,
                            unsigned int* width, unsigned int* height )
 {
@@ -179,23 +634,16 @@ int sgui_widget_is_absolute_visible( const sgui_widget* this )
 
 void sgui_widget_set_visible( sgui_widget* this, int visible )
 {
-    sgui_rect r;
-
     sgui_internal_lock_mutex( );
     if( ((this->flags & SGUI_WIDGET_VISIBLE)!=0) ^ (visible!=0) )
     {
+        damage( this );
         this->flags ^= SGUI_WIDGET_VISIBLE;
 
-        if( this->state_change_event )
-            this->state_change_event(this,SGUI_WIDGET_VISIBILLITY_CHANGED);
-
-        propagat_state_change(this->children,SGUI_WIDGET_VISIBILLITY_CHANGED);
+        notify( this, SGUI_WIDGET_VISIBILLITY_CHANGED );
+        propagat_state_change( this, SGUI_WIDGET_VISIBILLITY_CHANGED );
 
-        if( this->canvas )
-        {
-            sgui_widget_get_absolute_rect( this, &r );
-            sgui_canvas_add_dirty_rect( this->canvas, &r );
-        }
+        damage( this );
     }
     sgui_internal_unlock_mutex( );
 }
@@ -207,9 +655,10 @@ void sgui_widget_get_absolute_rect( const sgui_widget* this, sgui_rect* r )
     sgui_internal_lock_mutex( );
     *r = this->area;
 
-    for( i=this->parent; i!=NULL; i=i->parent )
+    for( i=this->parent; i!=NULL; this=i, i=i->parent )
     {
-        sgui_rect_add_offset( r, i->area.left, i->area.top );
+        sgui_rect_add_offset( r, i->area.left - SCROLL_X( this ),
+                                 i->area.top  - SCROLL_Y( this ) );
 
         if( !sgui_rect_get_intersection( r, r, &i->area ) )
             break;
@@ -218,10 +667,43 @@ void sgui_widget_get_absolute_rect( const sgui_widget* this, sgui_rect* r )
     sgui_internal_unlock_mutex( );
 }
 
+void sgui_widget_add_dirty_rect( sgui_widget* this, sgui_rect* r )
+{
+    sgui_internal_lock_mutex( );
+
+    if( this->canvas )
+    {
+        sgui_internal_layer_damage( this, r );
+        sgui_internal_canvas_add_dirty_rect( this->canvas, r );
+    }
+
+    sgui_internal_unlock_mutex( );
+}
+
+void sgui_widget_set_cached( sgui_widget* this, int cached )
+{
+    sgui_internal_lock_mutex( );
+
+    if( cached )
+    {
+        this->flags |= SGUI_WIDGET_CACHED;
+    }
+    else
+    {
+        this->flags &= ~SGUI_WIDGET_CACHED;
+
+        if( this->canvas )
+            sgui_internal_layer_release( this );
+    }
+
+    sgui_internal_unlock_mutex( );
+}
+
 void sgui_widget_send_event( sgui_widget* this, const sgui_event* event,
                              int propagate )
 {
     sgui_widget* i;
+    unsigned int j;
 
     sgui_internal_lock_mutex( );
 
@@ -262,8 +744,8 @@ void sgui_widget_send_event( sgui_widget* this, const sgui_event* event,
 
     if( propagate )
     {
-        for( i=this->children; i!=NULL; i=i->next )
-            sgui_widget_send_event( i, event, 1 );
+        for( j=0; j<this->num_children; ++j )
+            sgui_widget_send_event( this->children[j], event, 1 );
     }
 out:
     sgui_internal_unlock_mutex( );
@@ -271,90 +753,144 @@ out:
 
 void sgui_widget_remove_from_parent( sgui_widget* this )
 {
-    sgui_rect r;
-    sgui_widget* i = NULL;
+    sgui_widget *i, *p;
 
     sgui_internal_lock_mutex( );
 
-    if( this->parent )
+    if( (p = this->parent) )
     {
-        SGUI_REMOVE_FROM_LIST( this->parent->children, i, this );
+        damage( this );
+
+        --p->num_children;
+        memmove( p->children + this->index, p->children + this->index + 1,
+                 (p->num_children - this->index) * sizeof(sgui_widget*) );
+        renumber_children( p, this->index );
 
-        if( this->canvas && sgui_widget_is_absolute_visible( this ) )
+        if( this->parent->grid )
+            sgui_internal_grid_remove( this->parent->grid, this );
+
+        /* drop the pointer capture if it is inside the removed subtree */
+        for( i=this->canvas ? this->canvas->capture : NULL; i; i=i->parent )
         {
-            sgui_widget_get_absolute_rect( this, &r );
-            sgui_canvas_add_dirty_rect( this->canvas, &r );
+            if( i==this )
+            {
+                this->canvas->capture = NULL;
+                break;
+            }
         }
 
         /* tell old parent */
-        i = this->parent;
-
-        if( i && i->state_change_event )
-            i->state_change_event( i, SGUI_WIDGET_CHILD_REMOVED );
+        notify( p, SGUI_WIDGET_CHILD_REMOVED );
 
         /* update links, canvas and tell widget */
         this->parent = NULL;
-        this->next = NULL;
+        this->index = 0;
 
         if( this->canvas )
         {
+            sgui_internal_layer_release( this );
             this->canvas = NULL;
-            propagate_canvas( this->children );
+            propagate_canvas( this );
+            notify( this, SGUI_WIDGET_CANVAS_CHANGED );
             propagat_state_change( this, SGUI_WIDGET_CANVAS_CHANGED );
         }
 
-        if( this->state_change_event )
-            this->state_change_event( this, SGUI_WIDGET_PARENT_CHANGED );
+        notify( this, SGUI_WIDGET_PARENT_CHANGED );
     }
     sgui_internal_unlock_mutex( );
 }
 
-void sgui_widget_add_child( sgui_widget* this, sgui_widget* child )
+int sgui_widget_add_child( sgui_widget* this, sgui_widget* child )
 {
-    sgui_rect r;
-    sgui_widget* i;
     int change = SGUI_WIDGET_PARENT_CHANGED;
 
     sgui_internal_lock_mutex( );
 
+    if( !grow_children( this ) )
+    {
+        sgui_internal_unlock_mutex( );
+        return 0;
+    }
+
     /* add canvas change flag if the widget had a different canvas before */
     if( child->canvas != this->canvas )
+    {
         change |= SGUI_WIDGET_CANVAS_CHANGED;
 
+        if( child->canvas )
+            sgui_internal_layer_release( child );
+    }
+
     /* add widget */
     child->parent = this;
-    child->next = NULL;
     child->canvas = this->canvas;
+    child->index = this->num_children;
+    this->children[ this->num_children++ ] = child;
 
-    if( this->children )
-    {
-        for( i=this->children; i->next; i=i->next ) { } /* find end of list */
-        i->next = child;
-    }
-    else
-    {
-        this->children = child;
-    }
+    if( this->grid && !sgui_internal_grid_insert( this->grid, child ) )
+        drop_grid( this );
 
-    propagate_canvas( child->children );
+    propagate_canvas( child );
 
     /* flag coresponding area as dirty */
-    if( this->canvas && sgui_widget_is_absolute_visible( child ) )
+    damage( child );
+
+    /* call state change callbacks */
+    notify( this, SGUI_WIDGET_CHILD_ADDED );
+    notify( child, change );
+
+    if( change & SGUI_WIDGET_CANVAS_CHANGED )
+        propagat_state_change( child, SGUI_WIDGET_CANVAS_CHANGED );
+
+    sgui_internal_unlock_mutex( );
+    return 1;
+}
+
+void sgui_widget_begin_transaction( void )
+{
+    sgui_internal_lock_mutex( );
+    ++transaction.depth;
+}
+
+void sgui_widget_commit_transaction( void )
+{
+    sgui_widget* w;
+
+    if( !transaction.depth )
+        return;
+
+    if( !(--transaction.depth) )
     {
-        sgui_widget_get_absolute_rect( child, &r );
-        sgui_canvas_add_dirty_rect( child->canvas, &r );
+        /* callbacks may start and commit nested transactions */
+        while( transaction.next < transaction.used )
+        {
+            w = transaction.list[ transaction.next++ ];
+
+            if( w )
+                flush( w );
+        }
+
+        sgui_internal_free( transaction.list, SGUI_ALLOC_BUFFER );
+        memset( &transaction, 0, sizeof(transaction) );
     }
 
-    /* call state change callbacks */
-    if( this->state_change_event )
-        this->state_change_event( this, SGUI_WIDGET_CHILD_ADDED );
+    sgui_internal_unlock_mutex( );
+}
 
-    if( child->state_change_event )
-        child->state_change_event( child, change );
+void sgui_widget_raise( sgui_widget* this )
+{
+    sgui_internal_lock_mutex( );
 
-    if( change & SGUI_WIDGET_CANVAS_CHANGED )
-        propagat_state_change( child->children, SGUI_WIDGET_CANVAS_CHANGED );
+    if( this->parent )
+        restack( this, this->parent->num_children - 1 );
+
+    sgui_internal_unlock_mutex( );
+}
 
+void sgui_widget_lower( sgui_widget* this )
+{
+    sgui_internal_lock_mutex( );
+    restack( this, 0 );
     sgui_internal_unlock_mutex( );
 }
 
@@ -363,25 +899,45 @@ sgui_widget* sgui_widget_get_child_from_point( const sgui_widget* this,
 {
     const sgui_widget* old = NULL;
     sgui_widget* it;
+    unsigned int i;
+    int cx, cy;
 
     sgui_internal_lock_mutex( );
 
     if( sgui_rect_is_point_inside( &this->area, x, y ) )
     {
-        while( this->children && old!=this )
+        while( this->num_children && old!=this )
         {
             x -= this->area.left;
             y -= this->area.top;
+            old = this;
 
-            /* find last child at position */
-            for( old=this, it=this->children; it!=NULL; it=it->next )
+            if( old->grid )
+            {
+                it = sgui_internal_grid_find( old->grid, x, y,
+                                              old->scroll_x, old->scroll_y );
+                this = it ? it : old;
+            }
+            else
             {
-                if( (it->flags & SGUI_WIDGET_VISIBLE) &&
-                    sgui_rect_is_point_inside( &it->area, x, y ) )
+                /* find topmost child at position */
+                for( i=old->num_children; i-- > 0; )
                 {
-                    this = it;
+                    it = old->children[i];
+                    cx = x + SCROLL_X( it );
+                    cy = y + SCROLL_Y( it );
+
+                    if( (it->flags & SGUI_WIDGET_VISIBLE) &&
+                        sgui_rect_is_point_inside( &it->area, cx, cy ) )
+                    {
+                        this = it;
+                        break;
+                    }
                 }
             }
+
+            x += SCROLL_X( this );
+            y += SCROLL_Y( this );
         }
     }
     else
@@ -405,7 +961,7 @@ sgui_widget* sgui_widget_find_next_focus( const sgui_widget* this )
             goto outw;
 
         /* check right neighbours and their children */
-        for( w=this->next; w!=NULL; w=w->next )
+        for( w=next_sibling( this ); w!=NULL; w=next_sibling( w ) )
         {
             if( w->flags & SGUI_WIDGET_VISIBLE )
             {
@@ -417,10 +973,10 @@ sgui_widget* sgui_widget_find_next_focus( const sgui_widget* this )
         }
 
         /* find first visible right uncle */
-        this = this->parent ? this->parent->next : NULL;
+        this = next_sibling( this->parent );
 
         while( this && !(this->flags & SGUI_WIDGET_VISIBLE) )
-            this = this->next;
+            this = next_sibling( this );
     }
     while( this && !(this->flags & SGUI_FOCUS_ACCEPT) );
 
@@ -437,15 +993,18 @@ void sgui_widget_draw( sgui_widget* this, sgui_rect* bounds,
                        sgui_widget* focus )
 {
     sgui_rect wr, old_sc;
+    const sgui_widget* first;
+    unsigned int i, start;
     sgui_skin* skin;
-    sgui_widget* i;
-    int fbw;
+    sgui_widget* w;
+    int fbw, ox, oy;
 
     sgui_internal_lock_mutex( );
 
     if( this->flags & SGUI_WIDGET_VISIBLE )
     {
-        sgui_widget_get_absolute_rect( this, &wr );
+        wr = this->area;
+        sgui_rect_add_offset( &wr, this->canvas->ox, this->canvas->oy );
 
         if( wr.left>=wr.right || wr.top>=wr.bottom )
             goto out;
@@ -458,24 +1017,51 @@ void sgui_widget_draw( sgui_widget* this, sgui_rect* bounds,
         if( !sgui_rect_get_intersection( &this->canvas->sc, &old_sc, &wr ) )
             goto out;
 
-        if( this->draw )
-            this->draw( this );
+        if( (this->flags & SGUI_WIDGET_CACHED) &&
+            !(this->canvas->flags & SGUI_CANVAS_LAYER) &&
+            sgui_internal_layer_draw( this, focus ) )
+        {
+            goto draw_focus;
+        }
 
-        this->canvas->ox += this->area.left;
-        this->canvas->oy += this->area.top;
+        /* skip everything hidden below the topmost covering child */
+        first = find_opaque_cover( this, this->canvas->ox + this->area.left,
+                                   this->canvas->oy + this->area.top,
+                                   &this->canvas->sc );
 
-        for( i=this->children; i!=NULL; i=i->next )
-            sgui_widget_draw( i, bounds ? &wr : NULL, focus );
+        if( first )
+        {
+            start = first->index;
+        }
+        else
+        {
+            start = 0;
 
-        this->canvas->ox -= this->area.left;
-        this->canvas->oy -= this->area.top;
+            if( this->draw )
+                this->draw( this );
+        }
+
+        ox = this->canvas->ox;
+        oy = this->canvas->oy;
+
+        for( i=start; i<this->num_children; ++i )
+        {
+            w = this->children[i];
+            this->canvas->ox = ox + this->area.left - SCROLL_X( w );
+            this->canvas->oy = oy + this->area.top  - SCROLL_Y( w );
+            sgui_widget_draw( w, bounds ? &wr : NULL, focus );
+        }
 
+        this->canvas->ox = ox;
+        this->canvas->oy = oy;
+draw_focus:
         if( this==focus && (this->flags & SGUI_FOCUS_DRAW) )
         {
             skin = sgui_skin_get( );
             fbw = skin->get_focus_box_width( skin );
 
-            sgui_widget_get_absolute_rect( this, &wr );
+            wr = this->area;
+            sgui_rect_add_offset( &wr, this->canvas->ox, this->canvas->oy );
             sgui_rect_extend( &wr, fbw, fbw );
 
             if( sgui_rect_get_intersection(&this->canvas->sc, &old_sc, &wr) )
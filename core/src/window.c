@@ -283,22 +283,25 @@ void sgui_window_pack( sgui_window* this )
 {
     unsigned int width, height;
     sgui_rect r, acc;
-    sgui_widget* w;
+    sgui_widget* root;
+    unsigned int i;
 
     sgui_internal_lock_mutex( );
 
     if( this->backend != SGUI_NATIVE )
         goto done;
 
-    if( !(w = this->ctx.canvas->root.children) )
+    root = &this->ctx.canvas->root;
+
+    if( !root->num_children )
         goto done;
 
     /* get bounding rectangle for all widgets */
-    acc = w->area;
+    acc = root->children[0]->area;
 
-    for( w=w->next; w!=NULL; w=w->next )
+    for( i=1; i<root->num_children; ++i )
     {
-        r = w->area;
+        r = root->children[i]->area;
         sgui_rect_join( &acc, &r, 0 );
     }
 
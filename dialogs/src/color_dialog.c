@@ -32,6 +32,7 @@
 #include "sgui_label.h"
 #include "sgui_event.h"
 #include "sgui_skin.h"
+#include "sgui_internal.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -57,8 +58,9 @@ sgui_color_dialog;
 
 
 
-static void update_hsv_from_spinbox( sgui_color_dialog* this )
+static void update_hsv_from_spinbox( void* dialog )
 {
+    sgui_color_dialog* this = dialog;
     unsigned char hsva[4];
 
     hsva[0] = sgui_numeric_edit_get_value( this->spin_h );
@@ -68,8 +70,9 @@ static void update_hsv_from_spinbox( sgui_color_dialog* this )
     sgui_color_dialog_set_hsva( (sgui_dialog*)this, hsva );
 }
 
-static void update_rgb_from_spinbox( sgui_color_dialog* this )
+static void update_rgb_from_spinbox( void* dialog )
 {
+    sgui_color_dialog* this = dialog;
     unsigned char rgba[4];
 
     rgba[0] = sgui_numeric_edit_get_value( this->spin_r );
@@ -79,6 +82,16 @@ static void update_rgb_from_spinbox( sgui_color_dialog* this )
     sgui_color_dialog_set_rgba( (sgui_dialog*)this, rgba );
 }
 
+static void picker_hsva_changed( void* dialog, const sgui_event* e )
+{
+    sgui_color_dialog_set_hsva( dialog, e->arg.color );
+}
+
+static void picker_rgba_changed( void* dialog, const sgui_event* e )
+{
+    sgui_color_dialog_set_rgba( dialog, e->arg.color );
+}
+
 static int add_spinbox( sgui_widget** box, sgui_widget** label,
                         unsigned int width, unsigned int* height,
                         int x, int y, const char* caption )
@@ -143,9 +156,9 @@ static void sgui_color_dialog_destroy( sgui_dialog* super )
     sgui_color_dialog* this = (sgui_color_dialog*)super;
 
     sgui_event_disconnect(this->picker, SGUI_HSVA_CHANGED_EVENT,
-                          (sgui_function)sgui_color_dialog_set_hsva,this);
+                          (sgui_function)picker_hsva_changed,this);
     sgui_event_disconnect(this->picker, SGUI_RGBA_CHANGED_EVENT,
-                          (sgui_function)sgui_color_dialog_set_rgba,this);
+                          (sgui_function)picker_rgba_changed,this);
     sgui_event_disconnect(this->spin_h, SGUI_EDIT_VALUE_CHANGED,
                           (sgui_function)update_hsv_from_spinbox,this);
     sgui_event_disconnect(this->spin_s, SGUI_EDIT_VALUE_CHANGED,
@@ -176,7 +189,7 @@ static void sgui_color_dialog_destroy( sgui_dialog* super )
     sgui_widget_destroy( this->label_b );
     sgui_widget_destroy( this->spin_a );
     sgui_widget_destroy( this->label_a );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -185,7 +198,9 @@ sgui_dialog* sgui_color_dialog_create( const char* caption,
                                        const char* accept,
                                        const char* reject )
 {
-    sgui_color_dialog* this = calloc( 1, sizeof(sgui_color_dialog) );
+    sgui_color_dialog* this = sgui_internal_calloc( 1,
+                                                    sizeof(sgui_color_dialog),
+                                                    SGUI_ALLOC_OBJECT );
     sgui_dialog* super = (sgui_dialog*)this;
     unsigned int x, y, w, h, ws;
     unsigned char color[4];
@@ -261,26 +276,24 @@ sgui_dialog* sgui_color_dialog_create( const char* caption,
     sgui_window_add_widget( super->window, this->label_a );
 
     /* events */
-    sgui_event_connect( this->picker, SGUI_HSVA_CHANGED_EVENT,
-                        sgui_color_dialog_set_hsva, this,
-                        SGUI_FROM_EVENT, SGUI_COLOR );
-    sgui_event_connect( this->picker, SGUI_RGBA_CHANGED_EVENT,
-                        sgui_color_dialog_set_rgba, this,
-                        SGUI_FROM_EVENT, SGUI_COLOR );
-    sgui_event_connect( this->spin_h, SGUI_EDIT_VALUE_CHANGED,
-                        update_hsv_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_s, SGUI_EDIT_VALUE_CHANGED,
-                        update_hsv_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_v, SGUI_EDIT_VALUE_CHANGED,
-                        update_hsv_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_a, SGUI_EDIT_VALUE_CHANGED,
-                        update_hsv_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_r, SGUI_EDIT_VALUE_CHANGED,
-                        update_rgb_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_g, SGUI_EDIT_VALUE_CHANGED,
-                        update_rgb_from_spinbox, this, SGUI_VOID );
-    sgui_event_connect( this->spin_b, SGUI_EDIT_VALUE_CHANGED,
-                        update_rgb_from_spinbox, this, SGUI_VOID );
+    sgui_event_connect_event( this->picker, SGUI_HSVA_CHANGED_EVENT,
+                              picker_hsva_changed, this );
+    sgui_event_connect_event( this->picker, SGUI_RGBA_CHANGED_EVENT,
+                              picker_rgba_changed, this );
+    sgui_event_connect_void( this->spin_h, SGUI_EDIT_VALUE_CHANGED,
+                             update_hsv_from_spinbox, this );
+    sgui_event_connect_void( this->spin_s, SGUI_EDIT_VALUE_CHANGED,
+                             update_hsv_from_spinbox, this );
+    sgui_event_connect_void( this->spin_v, SGUI_EDIT_VALUE_CHANGED,
+                             update_hsv_from_spinbox, this );
+    sgui_event_connect_void( this->spin_a, SGUI_EDIT_VALUE_CHANGED,
+                             update_hsv_from_spinbox, this );
+    sgui_event_connect_void( this->spin_r, SGUI_EDIT_VALUE_CHANGED,
+                             update_rgb_from_spinbox, this );
+    sgui_event_connect_void( this->spin_g, SGUI_EDIT_VALUE_CHANGED,
+                             update_rgb_from_spinbox, this );
+    sgui_event_connect_void( this->spin_b, SGUI_EDIT_VALUE_CHANGED,
+                             update_rgb_from_spinbox, this );
 
     /* init */
     sgui_color_picker_get_hsv( this->picker, color );
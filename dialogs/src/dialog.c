@@ -34,32 +34,42 @@
 
 
 
+/* connected to the buttons and the window, with the button index */
+static void dialog_button( void* dialog, int idx )
+{
+    sgui_dialog* this = dialog;
+
+    this->handle_button( this, idx );
+}
+
+/****************************************************************************/
+
 void sgui_dialog_destroy( sgui_dialog* this )
 {
     if( this->b0 )
     {
         sgui_event_disconnect( this->b0, SGUI_BUTTON_OUT_EVENT,
-                               (sgui_function)this->handle_button, this );
+                               (sgui_function)dialog_button, this );
         sgui_widget_remove_from_parent( this->b0 );
         sgui_widget_destroy( this->b0 );
     }
     if( this->b1 )
     {
         sgui_event_disconnect( this->b1, SGUI_BUTTON_OUT_EVENT,
-                               (sgui_function)this->handle_button, this );
+                               (sgui_function)dialog_button, this );
         sgui_widget_remove_from_parent( this->b1 );
         sgui_widget_destroy( this->b1 );
     }
     if( this->b2 )
     {
         sgui_event_disconnect( this->b2, SGUI_BUTTON_OUT_EVENT,
-                               (sgui_function)this->handle_button, this );
+                               (sgui_function)dialog_button, this );
         sgui_widget_remove_from_parent( this->b2 );
         sgui_widget_destroy( this->b2 );
     }
 
     sgui_event_disconnect( this->window, SGUI_USER_CLOSED_EVENT,
-                           (sgui_function)this->handle_button, this );
+                           (sgui_function)dialog_button, this );
 
     sgui_window_destroy( this->window );
     this->b0 = this->b1 = this->b2 = 0;
@@ -169,28 +179,28 @@ int sgui_dialog_init( sgui_dialog* this,
         sgui_widget_set_position( this->b0, x, y );
         sgui_window_add_widget( this->window, this->b0 );
         x += SGUI_RECT_WIDTH(r0) + 15;
-        sgui_event_connect( this->b0, SGUI_BUTTON_OUT_EVENT,
-                            this->handle_button, this, SGUI_INT, 0 );
+        sgui_event_connect_int( this->b0, SGUI_BUTTON_OUT_EVENT,
+                                dialog_button, this, 0 );
     }
     if( button1 )
     {
         sgui_widget_set_position( this->b1, x, y );
         sgui_window_add_widget( this->window, this->b1 );
         x += SGUI_RECT_WIDTH(r1) + 15;
-        sgui_event_connect( this->b1, SGUI_BUTTON_OUT_EVENT,
-                            this->handle_button, this, SGUI_INT, 1 );
+        sgui_event_connect_int( this->b1, SGUI_BUTTON_OUT_EVENT,
+                                dialog_button, this, 1 );
     }
     if( button2 )
     {
         sgui_widget_set_position( this->b2, x, y );
         sgui_window_add_widget( this->window, this->b2 );
-        sgui_event_connect( this->b2, SGUI_BUTTON_OUT_EVENT,
-                            this->handle_button, this, SGUI_INT, 2 );
+        sgui_event_connect_int( this->b2, SGUI_BUTTON_OUT_EVENT,
+                                dialog_button, this, 2 );
     }
 
     /* connect window closing event */
-    sgui_event_connect( this->window, SGUI_USER_CLOSED_EVENT,
-                        this->handle_button, this, SGUI_INT, -1 );
+    sgui_event_connect_int( this->window, SGUI_USER_CLOSED_EVENT,
+                            dialog_button, this, -1 );
     return 1;
 }
 
@@ -171,7 +171,7 @@ static void sgui_message_box_destroy( sgui_dialog* super )
     sgui_message_box* this = (sgui_message_box*)super;
     sgui_widget_destroy( this->text );
     sgui_widget_destroy( this->icon );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -204,7 +204,8 @@ sgui_dialog* sgui_message_box_create( int icon, const char* caption,
         return NULL;
 
     /* create dialog structure */
-    this = calloc( 1, sizeof(sgui_message_box) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_message_box),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_dialog*)this;
 
     if( !this )
@@ -14,7 +14,7 @@
 
 
 
-void read_clipboard( sgui_window* wnd )
+void read_clipboard( void* wnd )
 {
     const char* text = sgui_window_read_clipboard( wnd );
 
@@ -22,7 +22,7 @@ void read_clipboard( sgui_window* wnd )
         puts( text );
 }
 
-void write_clipboard( sgui_window* wnd, sgui_widget* editbox )
+void write_clipboard( void* wnd, void* editbox )
 {
     const char* text = sgui_edit_box_get_text( editbox );
 
@@ -56,11 +56,11 @@ int main( void )
     sgui_window_add_widget( wnd, eb );
 
     /* hook event callbacks */
-    sgui_event_connect( rb, SGUI_BUTTON_OUT_EVENT,
-                        read_clipboard, wnd, SGUI_VOID );
+    sgui_event_connect_void( rb, SGUI_BUTTON_OUT_EVENT,
+                             read_clipboard, wnd );
 
-    sgui_event_connect( wb, SGUI_BUTTON_OUT_EVENT,
-                        write_clipboard, wnd, SGUI_POINTER, eb );
+    sgui_event_connect_pointer( wb, SGUI_BUTTON_OUT_EVENT,
+                                write_clipboard, wnd, eb );
 
     /* main loop */
     sgui_main_loop( );
@@ -48,7 +48,7 @@ float vertices[] =
 
 
 
-void draw_callback( sgui_window* window )
+void draw_callback( void* window )
 {
     sgui_d3d11_context* ctx;
     FLOAT bg[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
@@ -68,6 +68,11 @@ void draw_callback( sgui_window* window )
     sgui_window_swap_buffers( window );
 }
 
+void print_message( void* message )
+{
+    puts( message );
+}
+
 
 
 
@@ -164,11 +169,11 @@ int main( void )
     ID3D11DeviceContext_PSSetShader( ctx->ctx, ps, NULL, 0 );
 
     /* hook event callbacks. See gl0.c for further explanation */
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        draw_callback, wnd, SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             draw_callback, wnd );
 
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        puts, "Redraw!", SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             print_message, (void*)"Redraw!" );
 
     /* main loop */
     sgui_main_loop( );
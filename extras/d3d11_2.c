@@ -70,6 +70,11 @@ void d3dview_on_draw( sgui_widget* subview )
     ID3D11DeviceContext_Draw( ctx->ctx, 3, 0 );
 }
 
+void refresh_view( void* view )
+{
+    sgui_subview_refresh( view );
+}
+
 int main( void )
 {
     D3D11_SUBRESOURCE_DATA InitData;
@@ -160,8 +165,8 @@ int main( void )
 
     /* hook callbacks. See gl2.c for further explanation */
     sgui_subview_set_draw_callback( subview, d3dview_on_draw );
-    sgui_event_connect( button, SGUI_BUTTON_OUT_EVENT,
-                        sgui_subview_refresh, subview, SGUI_VOID );
+    sgui_event_connect_void( button, SGUI_BUTTON_OUT_EVENT,
+                             refresh_view, subview );
 
     /* add widgets to the window */
     sgui_window_add_widget( wnd, text );
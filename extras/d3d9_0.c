@@ -36,7 +36,7 @@ LPDIRECT3DVERTEXBUFFER9 v_buffer;
 
 
 
-void draw_callback( sgui_window* window )
+void draw_callback( void* window )
 {
     /* get the context from the window */
     sgui_d3d9_context* ctx =
@@ -61,6 +61,11 @@ void draw_callback( sgui_window* window )
     sgui_window_swap_buffers( window );
 }
 
+void print_message( void* message )
+{
+    puts( message );
+}
+
 
 
 int main( void )
@@ -106,11 +111,11 @@ int main( void )
     IDirect3DVertexBuffer9_Unlock( v_buffer );
 
     /* hook event callbacks. See gl0.c for furhter explanation */
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        draw_callback, wnd, SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             draw_callback, wnd );
 
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        puts, "Readraw!", SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             print_message, (void*)"Readraw!" );
 
     /* main loop */
     sgui_main_loop( );
@@ -56,6 +56,11 @@ void d3dview_on_draw( sgui_widget* subview )
     IDirect3DDevice9_EndScene( dev );
 }
 
+void refresh_view( void* view )
+{
+    sgui_subview_refresh( view );
+}
+
 int main( void )
 {
     sgui_window* subwindow;
@@ -102,8 +107,8 @@ int main( void )
 
     /* hook callbacks. See gl2.c for further explanation */
     sgui_subview_set_draw_callback( subview, d3dview_on_draw );
-    sgui_event_connect( button, SGUI_BUTTON_OUT_EVENT,
-                        sgui_subview_refresh, subview, SGUI_VOID );
+    sgui_event_connect_void( button, SGUI_BUTTON_OUT_EVENT,
+                             refresh_view, subview );
 
     /* add widgets to the window */
     sgui_window_add_widget( wnd, text );
@@ -119,15 +119,36 @@ return_type THREADCALL gl_drawing_thread( arg_type arg )
 }
 
 /* callback for password box, so we can see the text */
-void print_password( sgui_widget* e )
+void print_password( void* e )
 {
     puts( sgui_pass_box_get_text( e ) );
 }
 
 /* callback for sliders to print out the new value */
-void print_slider( const char* name, int value )
+void print_slider( void* name, const sgui_event* e )
 {
-    printf( "%s: %d%%\n", name, value );
+    printf( "%s: %d%%\n", (const char*)name, e->arg.i );
+}
+
+/* callbacks for the icons and the window at the bottom */
+void print_message( void* message )
+{
+    puts( message );
+}
+
+void snap_icons( void* view )
+{
+    sgui_icon_view_snap_to_grid( view );
+}
+
+void sort_icons( void* view )
+{
+    sgui_icon_view_sort( view, NULL );
+}
+
+void make_topmost( void* wnd )
+{
+    sgui_window_make_topmost( wnd );
 }
 
 
@@ -188,8 +209,8 @@ int main( int argc, char** argv )
     item2 = sgui_simple_model_add_item( model, NULL );
     sgui_simple_item_set_text( model, item2, 0, "bar" );
     sgui_simple_item_set_icon( model, item2, 0, sgui_icon_map_find(ic,1) );
-    sgui_event_connect( item2, SGUI_ICON_SELECTED_EVENT,
-                        puts, "Icon 2 selected -> sort icons", SGUI_VOID );
+    sgui_event_connect_void( item2, SGUI_ICON_SELECTED_EVENT, print_message,
+                             (void*)"Icon 2 selected -> sort icons" );
 
     item3 = sgui_simple_model_add_item( model, NULL );
     sgui_simple_item_set_text( model, item3, 0, "baz" );
@@ -375,31 +396,30 @@ int main( int argc, char** argv )
     sgui_window_add_widget( a, tab );
 
     /* hook callbacks */
-    sgui_event_connect( butt, SGUI_BUTTON_OUT_EVENT,
-                        print_password, ebp, SGUI_VOID );
-    sgui_event_connect( ebp, SGUI_EDIT_BOX_TEXT_ENTERED,
-                        print_password, ebp, SGUI_VOID );
-
-    sgui_event_connect( s1, SGUI_SLIDER_CHANGED_EVENT,
-                        print_slider, "slider 1", SGUI_FROM_EVENT, SGUI_I );
-    sgui_event_connect( s2, SGUI_SLIDER_CHANGED_EVENT,
-                        print_slider, "slider 2", SGUI_FROM_EVENT, SGUI_I );
-    sgui_event_connect( s3, SGUI_SLIDER_CHANGED_EVENT,
-                        print_slider, "slider 3", SGUI_FROM_EVENT, SGUI_I );
-    sgui_event_connect( s4, SGUI_SLIDER_CHANGED_EVENT,
-                        print_slider, "slider 4", SGUI_FROM_EVENT, SGUI_I );
-
-    sgui_event_connect( item1, SGUI_ICON_SELECTED_EVENT,
-                        puts, "Icon 1 selected -> snap to grid", SGUI_VOID );
-    sgui_event_connect( item1, SGUI_ICON_SELECTED_EVENT,
-                        sgui_icon_view_snap_to_grid, iv, SGUI_VOID );
-    sgui_event_connect( item2, SGUI_ICON_SELECTED_EVENT,
-                        sgui_icon_view_sort, iv, SGUI_POINTER, NULL );
-    sgui_event_connect( item3, SGUI_ICON_SELECTED_EVENT,
-                        puts, "Icon 3 selected", SGUI_VOID );
-
-    sgui_event_connect( b, SGUI_MOUSE_MOVE_EVENT,
-                        sgui_window_make_topmost, b, SGUI_VOID );
+    sgui_event_connect_void( butt, SGUI_BUTTON_OUT_EVENT,
+                             print_password, ebp );
+    sgui_event_connect_void( ebp, SGUI_EDIT_BOX_TEXT_ENTERED,
+                             print_password, ebp );
+
+    sgui_event_connect_event( s1, SGUI_SLIDER_CHANGED_EVENT,
+                              print_slider, (void*)"slider 1" );
+    sgui_event_connect_event( s2, SGUI_SLIDER_CHANGED_EVENT,
+                              print_slider, (void*)"slider 2" );
+    sgui_event_connect_event( s3, SGUI_SLIDER_CHANGED_EVENT,
+                              print_slider, (void*)"slider 3" );
+    sgui_event_connect_event( s4, SGUI_SLIDER_CHANGED_EVENT,
+                              print_slider, (void*)"slider 4" );
+
+    sgui_event_connect_void( item1, SGUI_ICON_SELECTED_EVENT, print_message,
+                             (void*)"Icon 1 selected -> snap to grid" );
+    sgui_event_connect_void( item1, SGUI_ICON_SELECTED_EVENT,
+                             snap_icons, iv );
+    sgui_event_connect_void( item2, SGUI_ICON_SELECTED_EVENT,
+                             sort_icons, iv );
+    sgui_event_connect_void( item3, SGUI_ICON_SELECTED_EVENT, print_message,
+                             (void*)"Icon 3 selected" );
+
+    sgui_event_connect_void( b, SGUI_MOUSE_MOVE_EVENT, make_topmost, b );
 
     /* enter main loop */
     sgui_main_loop( );
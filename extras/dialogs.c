@@ -22,9 +22,17 @@ const char* emtext =
 "even if the sgui_init( ) function fails and uses low-level\n"
 "system functions to draw a simple message box.";
 
-static void print_color( const char* space, unsigned char* c )
+static void print_color( void* space, const sgui_event* e )
 {
-    printf( "%s: %d, %d, %d, %d\n", space, c[0], c[1], c[2], c[3] );
+    const unsigned char* c = e->arg.color;
+
+    printf( "%s: %d, %d, %d, %d\n", (const char*)space,
+            c[0], c[1], c[2], c[3] );
+}
+
+static void print_message( void* message )
+{
+    puts( message );
 }
 
 int main( void )
@@ -72,11 +80,11 @@ int main( void )
         If the message box window gets closed without the user pressing
         a button, an SGUI_DIALOG_REJECTED is generated.
      */
-    sgui_event_connect( mb, SGUI_MESSAGE_BOX_BUTTON1_EVENT,
-                        puts, "Okay", SGUI_VOID );
+    sgui_event_connect_void( mb, SGUI_MESSAGE_BOX_BUTTON1_EVENT,
+                             print_message, (void*)"Okay" );
 
-    sgui_event_connect( mb, SGUI_MESSAGE_BOX_BUTTON2_EVENT,
-                        puts, "Foobar", SGUI_VOID );
+    sgui_event_connect_void( mb, SGUI_MESSAGE_BOX_BUTTON2_EVENT,
+                             print_message, (void*)"Foobar" );
 
     /*
         When the reject button of a color selection dialog gets clicked,
@@ -86,14 +94,14 @@ int main( void )
         an SGUI_COLOR_SELECTED_RGBA_EVENT with an RGBA color argument, and
         an SGUI_COLOR_SELECTED_HSVA_EVENT with an HSVA color argument.
      */
-    sgui_event_connect( cp, SGUI_DIALOG_REJECTED,
-                        puts, "Color dialog rejected", SGUI_VOID );
+    sgui_event_connect_void( cp, SGUI_DIALOG_REJECTED,
+                             print_message, (void*)"Color dialog rejected" );
 
-    sgui_event_connect( cp, SGUI_COLOR_SELECTED_RGBA_EVENT,
-                        print_color, "RGBA", SGUI_FROM_EVENT, SGUI_COLOR );
+    sgui_event_connect_event( cp, SGUI_COLOR_SELECTED_RGBA_EVENT,
+                              print_color, (void*)"RGBA" );
 
-    sgui_event_connect( cp, SGUI_COLOR_SELECTED_HSVA_EVENT,
-                        print_color, "HSVA", SGUI_FROM_EVENT, SGUI_COLOR );
+    sgui_event_connect_event( cp, SGUI_COLOR_SELECTED_HSVA_EVENT,
+                              print_color, (void*)"HSVA" );
 
     /* display dialogs and enter main loop */
     sgui_dialog_display( mb );
@@ -14,6 +14,38 @@
 
 
 
+/*
+    Callbacks that are connected to events. The first argument is always
+    the receiver object that was passed when connecting, followed by the
+    arguments of the typed connect function that was used.
+ */
+static void set_image_visible( void* img, int visible )
+{
+    sgui_widget_set_visible( img, visible );
+}
+
+static void set_window_visible( void* wnd, int visible )
+{
+    sgui_window_set_visible( wnd, visible );
+}
+
+static void move_window( void* wnd, int x, int y )
+{
+    sgui_window_move( wnd, x, y );
+}
+
+static void print_message( void* message )
+{
+    puts( message );
+}
+
+static void print_char( void* format, const sgui_event* e )
+{
+    printf( format, e->arg.utf8 );
+}
+
+
+
 int main( void )
 {
     unsigned char image[ 64*64*3 ], *ptr;
@@ -57,63 +89,54 @@ int main( void )
 
     /*
         when the object "b1" triggers an event of type SGUI_BUTTON_OUT_EVENT,
-        the function "sgui_widget_set_visible" is called on the object "img",
+        the function "set_image_visible" is called on the object "img",
         i.e. the pointer "img" is passed as first argument to the callback.
-        The second argument to the callback is of type int (SGUI_INT) and set
-        to value 1
+        The second argument to the callback is the int passed to
+        sgui_event_connect_int, in this case 1.
 
         Simply put, when b1 sends an SGUI_BUTTON_OUT_EVENT event,
-        the event system calls "sgui_widget_set_visible( img, 1 )"
+        the event system calls "set_image_visible( img, 1 )"
      */
-    sgui_event_connect( b1, SGUI_BUTTON_OUT_EVENT,
-                        sgui_widget_set_visible, img, SGUI_INT, 1 );
+    sgui_event_connect_int( b1, SGUI_BUTTON_OUT_EVENT,
+                            set_image_visible, img, 1 );
 
-    sgui_event_connect( b2, SGUI_BUTTON_OUT_EVENT,
-                        sgui_widget_set_visible, img, SGUI_INT, 0 );
+    sgui_event_connect_int( b2, SGUI_BUTTON_OUT_EVENT,
+                            set_image_visible, img, 0 );
 
     /*
-        Similar to the two above, but with argument type SGUI_INT2, which is
-        decomposed to two integer arguments.
+        Similar to the two above, but with two integer arguments.
 
         Simply put, when b3 sends an SGUI_BUTTON_OUT_EVENT event,
-        the event system calls "sgui_widget_move( wnd, 50, 100 )"
+        the event system calls "move_window( wnd, 50, 100 )"
      */
-    sgui_event_connect( b3, SGUI_BUTTON_OUT_EVENT,
-                        sgui_window_move, wnd, SGUI_INT2, 50, 100 );
+    sgui_event_connect_int2( b3, SGUI_BUTTON_OUT_EVENT,
+                             move_window, wnd, 50, 100 );
 
-    sgui_event_connect( b4, SGUI_BUTTON_OUT_EVENT,
-                        sgui_window_set_visible, wnd, SGUI_INT, 0 );
+    sgui_event_connect_int( b4, SGUI_BUTTON_OUT_EVENT,
+                            set_window_visible, wnd, 0 );
 
     /*
-        When b4 triggers an SGUI_BUTTON_OUT_EVENT, call the function "puts".
-
-        HACK: The object pointer passed as first argument to puts is a pointer
-        to a string.
-
-        The value SGUI_VOID indicates that there is no further argument to the
-        callback function.
+        When b4 triggers an SGUI_BUTTON_OUT_EVENT, call "print_message".
+        The receiver object is the string to print, there are no further
+        arguments to the callback function.
      */
-    sgui_event_connect( b4, SGUI_BUTTON_OUT_EVENT,
-                        puts, "Hello World!", SGUI_VOID );
+    sgui_event_connect_void( b4, SGUI_BUTTON_OUT_EVENT,
+                             print_message, (void*)"Hello World!" );
 
     /*
         Whenever the object "wnd", which is our window, triggers an event
-        of type SGUI_CHAR_EVENT, call the printf function.
-
-        HACK: The object pointer, our first argument to printf is a pointer
-        to a format string.
-
-        The value SGUI_FROM_EVENT tells the event system that the second
-        argument for printf is from the event structure received from "wnd".
+        of type SGUI_CHAR_EVENT, call "print_char".
 
-        More precisely, SGUI_UTF8 tells the system to use the utf8 argument
-        from the event structure.
+        The receiver object is a format string. Callbacks connected through
+        sgui_event_connect_event get the event structure received from "wnd"
+        as second argument and can pick whatever they need from it, in this
+        case the utf8 argument.
 
         Simply put, when "wnd" sends an SGUI_CHAR_EVENT, the event system
-        calls printf( "%s\n", event->arg.utf8 );
+        calls print_char( "%s\n", event ), which prints event->arg.utf8.
      */
-    sgui_event_connect( wnd, SGUI_CHAR_EVENT,
-                        printf, "%s\n", SGUI_FROM_EVENT, SGUI_UTF8 );
+    sgui_event_connect_event( wnd, SGUI_CHAR_EVENT, print_char,
+                              (void*)"%s\n" );
 
     /* enter main loop */
     sgui_main_loop( );
@@ -17,7 +17,7 @@
 
 
 
-void draw_callback( sgui_window* window )
+void draw_callback( void* window )
 {
     unsigned int w, h;
 
@@ -54,6 +54,11 @@ void draw_callback( sgui_window* window )
     sgui_window_release_current( window );
 }
 
+void print_message( void* message )
+{
+    puts( message );
+}
+
 
 
 int main( void )
@@ -96,11 +101,11 @@ int main( void )
         Redirect the redraw request to our redraw callback
         and print a string to show that we are redrawing.
      */
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        draw_callback, wnd, SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             draw_callback, wnd );
 
-    sgui_event_connect( wnd, SGUI_EXPOSE_EVENT,
-                        puts, "Readraw!", SGUI_VOID );
+    sgui_event_connect_void( wnd, SGUI_EXPOSE_EVENT,
+                             print_message, (void*)"Readraw!" );
 
     /* main loop */
     sgui_main_loop( );
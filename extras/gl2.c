@@ -40,6 +40,11 @@ void glview_on_draw( sgui_widget* glview )
     glEnd( );
 }
 
+void refresh_view( void* view )
+{
+    sgui_subview_refresh( view );
+}
+
 int main( void )
 {
     sgui_window* wnd;
@@ -84,11 +89,11 @@ int main( void )
     sgui_subview_set_draw_callback( gl_view, glview_on_draw );
 
     /*
-        The functon sgui_subview_refresh forces the window of the
-        sub-view to redraw itself.
+        The functon sgui_subview_refresh, called by refresh_view, forces
+        the window of the sub-view to redraw itself.
      */
-    sgui_event_connect( button, SGUI_BUTTON_OUT_EVENT,
-                        sgui_subview_refresh, gl_view, SGUI_VOID );
+    sgui_event_connect_void( button, SGUI_BUTTON_OUT_EVENT,
+                             refresh_view, gl_view );
 
     /* add widgets to the window */
     sgui_window_add_widget( wnd, text );
@@ -31,6 +31,15 @@ void window_callback( void* user, const sgui_event* event )
     }
 }
 
+/*
+    An event callback, connected to the button below. Gets the receiver
+    object and the value passed when connecting.
+ */
+void set_window_visible( void* wnd, int visible )
+{
+    sgui_window_set_visible( wnd, visible );
+}
+
 
 
 int main( )
@@ -92,18 +101,16 @@ int main( )
         Connect an event to a callback.
 
         When the object "button" triggers an SGUI_BUTTON_OUT_EVENT, call the
-        function "sgui_window_set_visible" on the object "wnd" (first
-        argument).
+        function "set_window_visible" on the object "wnd" (first argument).
 
         The second argument to the function is an integer with the value of
         SGUI_INVISIBLE.
 
         In short, when "button" sends an SGUI_BUTTON_OUT_EVENT, the event
-        system calls "sgui_window_set_visible( wnd, SGUI_INVISIBLE )"
+        system calls "set_window_visible( wnd, SGUI_INVISIBLE )"
      */
-    sgui_event_connect( button, SGUI_BUTTON_OUT_EVENT,
-                        sgui_window_set_visible, wnd,
-                        SGUI_INT, SGUI_INVISIBLE );
+    sgui_event_connect_int( button, SGUI_BUTTON_OUT_EVENT,
+                            set_window_visible, wnd, SGUI_INVISIBLE );
 
     /*
         Register a window event callback.
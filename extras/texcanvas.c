@@ -98,6 +98,12 @@ static void gl_perspective( float fov_deg, float aspectratio,
     glLoadMatrixf( m );
 }
 
+/* forward keyboard events of the window to the texture canvas */
+static void forward_event( void* canvas, const sgui_event* e )
+{
+    sgui_canvas_send_window_event( canvas, e );
+}
+
 /****************************************************************************/
 
 int main( void )
@@ -173,17 +179,14 @@ int main( void )
     texture = sgui_tex_canvas_get_texture( texcanvas );
 
     /****** redirect keyboard events to the texture canvas ******/
-    sgui_event_connect( wnd, SGUI_KEY_PRESSED_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_KEY_PRESSED_EVENT,
+                              forward_event, texcanvas );
 
-    sgui_event_connect( wnd, SGUI_KEY_RELEASED_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_KEY_RELEASED_EVENT,
+                              forward_event, texcanvas );
 
-    sgui_event_connect( wnd, SGUI_CHAR_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_CHAR_EVENT,
+                              forward_event, texcanvas );
 
     /************************ main loop ************************/
     while( sgui_main_loop_step( ) )
@@ -129,6 +129,12 @@ static void transform( float* m, float a )
     m[3]=0.0f; m[7]=0.0f; m[11]=0.0f; m[15]=  1.0f;
 }
 
+/* forward keyboard events of the window to the texture canvas */
+static void forward_event( void* canvas, const sgui_event* e )
+{
+    sgui_canvas_send_window_event( canvas, e );
+}
+
 
 
 
@@ -287,17 +293,14 @@ int main( void )
     sgui_widget_add_child( &texcanvas->root, check2 );
 
     /* redirect keyboard events to the texture canvas */
-    sgui_event_connect( wnd, SGUI_KEY_PRESSED_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_KEY_PRESSED_EVENT,
+                              forward_event, texcanvas );
 
-    sgui_event_connect( wnd, SGUI_KEY_RELEASED_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_KEY_RELEASED_EVENT,
+                              forward_event, texcanvas );
 
-    sgui_event_connect( wnd, SGUI_CHAR_EVENT,
-                        sgui_canvas_send_window_event, texcanvas,
-                        SGUI_FROM_EVENT, SGUI_EVENT );
+    sgui_event_connect_event( wnd, SGUI_CHAR_EVENT,
+                              forward_event, texcanvas );
 
     /*************** create resource view and sampler ***************/
     tex = sgui_tex_canvas_get_texture( texcanvas );
@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "d3d11_canvas.h"
+#include "sgui_internal.h"
 
 
 
@@ -37,8 +38,11 @@ void d3d11_canvas_destroy( sgui_canvas* super )
     sgui_d3d11_canvas* this = (sgui_d3d11_canvas*)super;
 
     IUnknown_Release( (IUnknown*)this->tex );
-    free( this->buffer );
-    free( this );
+    sgui_internal_memory_account( SGUI_MEMORY_D3D_TEXTURES,
+                                  -4L*super->width*super->height, -1 );
+
+    sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 int d3d11_canvas_begin( sgui_canvas* this, sgui_rect* r )
@@ -70,7 +74,9 @@ void d3d11_canvas_end( sgui_canvas* super )
 sgui_canvas* sgui_d3d11_canvas_create( sgui_context* ctx,
                                        unsigned width, unsigned int height )
 {
-    sgui_d3d11_canvas* this = calloc( 1, sizeof(sgui_d3d11_canvas) );
+    sgui_d3d11_canvas* this = sgui_internal_calloc( 1,
+                                                    sizeof(sgui_d3d11_canvas),
+                                                    SGUI_ALLOC_OBJECT );
     sgui_d3d11_context* ctx11 = (sgui_d3d11_context*)ctx;
     D3D11_TEXTURE2D_DESC desc;
     HRESULT status;
@@ -79,11 +85,12 @@ sgui_canvas* sgui_d3d11_canvas_create( sgui_context* ctx,
         return NULL;
 
     /* create in-memory drawing buffer */
-    this->buffer = malloc( width*height*4 );
+    this->buffer = sgui_internal_malloc( width*height*4,
+                                         SGUI_MEM(D3D_PIXMAPS,PIXELS) );
 
     if( !this->buffer )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -91,8 +98,8 @@ sgui_canvas* sgui_d3d11_canvas_create( sgui_context* ctx,
     if( !sgui_memory_canvas_init( (sgui_canvas*)this, this->buffer,
                                   width, height, SGUI_RGBA8, 0 ) )
     {
-        free( this->buffer );
-        free( this );
+        sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -113,11 +120,14 @@ sgui_canvas* sgui_d3d11_canvas_create( sgui_context* ctx,
 
     if( status != S_OK )
     {
-        free( this->buffer );
-        free( this );
+        sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
+    sgui_internal_memory_account( SGUI_MEMORY_D3D_TEXTURES,
+                                  4L*width*height, 1 );
+
     /* hook callbacks */
     ((sgui_tex_canvas*)this)->get_texture = d3d11_canvas_get_texture;
     ((sgui_canvas*)this)->destroy = d3d11_canvas_destroy;
@@ -25,6 +25,7 @@
 #include "d3d11_wm.h"
 #include "../ctx_mesh.h"
 #include "sgui_subwm_skin.h"
+#include "sgui_internal.h"
 
 
 
@@ -42,7 +43,7 @@ static void d3d11_wm_destroy( sgui_ctx_wm* super )
     ID3D11SamplerState_Release( this->sampler );
     ID3D11ShaderResourceView_Release( this->view );
     ID3D11Texture2D_Release( this->skintex );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 
@@ -65,7 +66,7 @@ sgui_ctx_wm* d3d11_wm_create( sgui_window* wnd )
     if( !ctx )
         return NULL;
 
-    this = calloc( 1, sizeof(sgui_d3d11_wm) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_d3d11_wm), SGUI_ALLOC_OBJECT );
     super = (sgui_ctx_wm*)this;
 
     if( !this )
@@ -130,7 +131,7 @@ failview:
 failtex:
     ID3D11Texture2D_Release( this->skintex );
 fail:
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
 #endif /* SGUI_WINDOWS && !SGUI_NO_D3D11 */
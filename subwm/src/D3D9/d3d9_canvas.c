@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "d3d9_canvas.h"
+#include "sgui_internal.h"
 
 
 
@@ -35,7 +36,10 @@ void* d3d9_canvas_get_texture( sgui_canvas* this )
 void d3d9_canvas_destroy( sgui_canvas* this )
 {
     IDirect3DTexture9_Release( ((sgui_d3d9_canvas*)this)->tex );
-    free( this );
+    sgui_internal_memory_account( SGUI_MEMORY_D3D_TEXTURES,
+                                  -4L*this->width*this->height, -1 );
+
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 int d3d9_canvas_begin( sgui_canvas* super, sgui_rect* r )
@@ -74,7 +78,8 @@ void d3d9_canvas_end( sgui_canvas* super )
 sgui_canvas* sgui_d3d9_canvas_create( sgui_context* ctx,
                                       unsigned width, unsigned int height )
 {
-    sgui_d3d9_canvas* this = calloc( 1, sizeof(sgui_d3d9_canvas) );
+    sgui_d3d9_canvas* this = sgui_internal_calloc( 1, sizeof(sgui_d3d9_canvas),
+                                                   SGUI_ALLOC_OBJECT );
     sgui_d3d9_context* ctx9 = (sgui_d3d9_context*)ctx;
     HRESULT status;
 
@@ -85,7 +90,7 @@ sgui_canvas* sgui_d3d9_canvas_create( sgui_context* ctx,
     if( !sgui_memory_canvas_init( (sgui_canvas*)this, NULL,
                                   width, height, SGUI_RGBA8, 1 ) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -98,10 +103,13 @@ sgui_canvas* sgui_d3d9_canvas_create( sgui_context* ctx,
 
     if( status != D3D_OK )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
+    sgui_internal_memory_account( SGUI_MEMORY_D3D_TEXTURES,
+                                  4L*width*height, 1 );
+
     /* hook callbacks */
     ((sgui_tex_canvas*)this)->get_texture = d3d9_canvas_get_texture;
     ((sgui_canvas*)this)->destroy = d3d9_canvas_destroy;
@@ -25,6 +25,7 @@
 #include "d3d9_wm.h"
 #include "../ctx_mesh.h"
 #include "sgui_subwm_skin.h"
+#include "sgui_internal.h"
 
 
 
@@ -151,14 +152,15 @@ static void d3d9_wm_destroy( sgui_ctx_wm* super )
 {
     sgui_d3d9_wm* this = (sgui_d3d9_wm*)super;
     IDirect3DBaseTexture9_Release( this->skintex );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 
 
 sgui_ctx_wm* d3d9_wm_create( sgui_window* wnd )
 {
-    sgui_d3d9_wm* this = calloc( 1, sizeof(sgui_d3d9_wm) );
+    sgui_d3d9_wm* this = sgui_internal_calloc( 1, sizeof(sgui_d3d9_wm),
+                                               SGUI_ALLOC_OBJECT );
     sgui_ctx_wm* super = (sgui_ctx_wm*)this;
     unsigned int width, height;
     sgui_d3d9_context* ctx;
@@ -186,7 +188,7 @@ sgui_ctx_wm* d3d9_wm_create( sgui_window* wnd )
 
     if( status!=D3D_OK || !this->skintex )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -196,7 +198,7 @@ sgui_ctx_wm* d3d9_wm_create( sgui_window* wnd )
     if( status != D3D_OK )
     {
         IDirect3DTexture9_Release( this->skintex );
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
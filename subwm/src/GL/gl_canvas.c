@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "gl_canvas.h"
+#include "sgui_internal.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -35,9 +36,11 @@ static void gl_canvas_destroy( sgui_canvas* super )
     sgui_gl_canvas* this = (sgui_gl_canvas*)super;
 
     glDeleteTextures( 1, &this->tex );
+    sgui_internal_memory_account( SGUI_MEMORY_GL_TEXTURES,
+                                  -4L*super->width*super->height, -1 );
 
-    free( this->buffer );
-    free( this );
+    sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static int gl_canvas_begin( sgui_canvas* this, sgui_rect* r )
@@ -89,17 +92,19 @@ sgui_canvas* sgui_gl_canvas_create( unsigned width, unsigned int height )
     sgui_gl_canvas* this;
     GLuint old;
 
-    this = calloc( 1, sizeof(sgui_gl_canvas) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_gl_canvas),
+                                 SGUI_ALLOC_OBJECT );
 
     if( !this )
         return NULL;
 
     /* create in-memory drawing buffer */
-    this->buffer = malloc( width*height*4 );
+    this->buffer = sgui_internal_malloc( width*height*4,
+                                         SGUI_MEM(GL_PIXMAPS,PIXELS) );
 
     if( !this->buffer )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -107,8 +112,8 @@ sgui_canvas* sgui_gl_canvas_create( unsigned width, unsigned int height )
     if( !sgui_memory_canvas_init( (sgui_canvas*)this, this->buffer,
                                   width, height, SGUI_RGBA8, 0 ) )
     {
-        free( this->buffer );
-        free( this );
+        sgui_internal_free( this->buffer, SGUI_ALLOC_PIXELS );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -127,6 +132,9 @@ sgui_canvas* sgui_gl_canvas_create( unsigned width, unsigned int height )
 
     glBindTexture( GL_TEXTURE_2D, old );
 
+    sgui_internal_memory_account( SGUI_MEMORY_GL_TEXTURES,
+                                  4L*width*height, 1 );
+
     /* hook callbacks */
     ((sgui_tex_canvas*)this)->get_texture = gl_canvas_get_texture;
     ((sgui_canvas*)this)->destroy = gl_canvas_destroy;
@@ -238,7 +238,7 @@ static int sgui_gl_functions_load( sgui_gl_functions* this,
 static void gl_wm_destroy( sgui_ctx_wm* this )
 {
     glDeleteTextures( 1, &(((sgui_gl_wm*)this)->wndtex) );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void gl_wm_draw_gui( sgui_ctx_wm* super )
@@ -312,7 +312,8 @@ static void gl_wm_draw_gui( sgui_ctx_wm* super )
 
 sgui_ctx_wm* gl_wm_create( sgui_window* wnd )
 {
-    sgui_gl_wm* this = calloc( 1, sizeof(sgui_gl_wm) );
+    sgui_gl_wm* this = sgui_internal_calloc( 1, sizeof(sgui_gl_wm),
+                                             SGUI_ALLOC_OBJECT );
     sgui_ctx_wm* super = (sgui_ctx_wm*)this;
 
     if( this )
@@ -352,7 +353,7 @@ static void gl_wm_core_destroy( sgui_ctx_wm* super )
     DeleteVertexArrays( 1, &this->vao );
     DeleteBuffers( 2, this->buffers );
     glDeleteTextures( 1, &(((sgui_gl_wm*)super)->wndtex) );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void gl_wm_core_draw_gui( sgui_ctx_wm* super )
@@ -456,7 +457,8 @@ sgui_ctx_wm* gl_wm_create_core( sgui_window* wnd )
         return gl_wm_create( wnd );
 
     /* create object */
-    this = calloc( 1, sizeof(sgui_gl_core_wm) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_gl_core_wm),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_gl_wm*)this;
 
     if( !this )
@@ -468,7 +470,7 @@ sgui_ctx_wm* gl_wm_create_core( sgui_window* wnd )
     gl = &(this->gl);
     if( !sgui_gl_functions_load( gl, wnd->ctx.ctx ) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -504,7 +506,7 @@ sgui_ctx_wm* gl_wm_create_core( sgui_window* wnd )
        !BindFragDataLocation||!BindAttribLocation||!VertexAttribPointer||
        !EnableVertexAttribArray)
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -27,6 +27,7 @@
 #include "sgui_subwm_skin.h"
 #include "sgui_ctx_wm.h"
 #include "sgui_event.h"
+#include "sgui_internal.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -99,7 +100,7 @@ static void destroy( sgui_window* super )
         sgui_ctx_wm_remove_window( this->wm, super );
 
     sgui_canvas_destroy( super->ctx.canvas );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void force_redraw( sgui_window* super, sgui_rect* r )
@@ -154,7 +155,8 @@ sgui_window* sgui_ctx_window_create( sgui_window* parent,
         return NULL;
 
     /* create structure */
-    this = calloc( 1, sizeof(sgui_ctx_window) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_ctx_window),
+                                 SGUI_ALLOC_OBJECT );
     super = (sgui_window*)this;
 
     if( !this )
@@ -166,7 +168,7 @@ sgui_window* sgui_ctx_window_create( sgui_window* parent,
 
     if( !super->ctx.canvas )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
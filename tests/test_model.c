@@ -88,6 +88,33 @@ static void add_items( sgui_model* model, sgui_item* parent, int level,
     }
 }
 
+static void check_fetch( sgui_model* model, sgui_item* parent )
+{
+    const sgui_item *items[25], *list;
+    unsigned int i, j, count;
+
+    for( i=0; i<22; ++i )
+    {
+        count = sgui_model_fetch_items( model, parent, i, 25, items );
+
+        if( count!=(i<20 ? 20-i : 0) )
+            fail( "[check_fetch] wrong number of items fetched\n" );
+
+        list = sgui_model_query_items( model, parent, i, 0 );
+
+        for( j=0; j<count; ++j, list=list->next )
+        {
+            if( items[j]!=list )
+                fail( "[check_fetch] fetched items differ from list\n" );
+        }
+    }
+
+    if( sgui_model_fetch_items( model, parent, 3, 5, items )!=5 )
+        fail( "[check_fetch] fetched more items than requested\n" );
+    if( sgui_model_fetch_items( model, parent, 0, 0, items ) )
+        fail( "[check_fetch] fetched items with zero count\n" );
+}
+
 static void check_items( sgui_model* model, sgui_item* parent, int level,
                          int withicon )
 {
@@ -95,6 +122,8 @@ static void check_items( sgui_model* model, sgui_item* parent, int level,
     unsigned int i, j, k;
     char buffer[32];
 
+    check_fetch( model, parent );
+
     for( i=0; i<20; ++i )
     {
         if( !(list = sgui_model_query_items( model, parent, i, 20-i )) )
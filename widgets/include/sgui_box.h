@@ -0,0 +1,126 @@
+/*
+ * sgui_box.h
+ * This file is part of sgui
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file sgui_box.h
+ *
+ * \brief Contains the declarations of the sgui_box layout widget
+ */
+#ifndef SGUI_BOX_H
+#define SGUI_BOX_H
+
+
+
+#include "sgui_predef.h"
+
+
+
+/**
+ * \struct sgui_box
+ *
+ * \extends sgui_widget
+ *
+ * \brief An invisible container widget that arranges its children in rows
+ *        and columns
+ *
+ * Children are placed in the order in which they are added, from left to
+ * right and from top to bottom. The width of a column is the width of its
+ * widest child and the height of a row is the height of its tallest child.
+ * Children keep their size and are placed at the top left corner of their
+ * cell. If a box is larger than its content, the remaining space is split
+ * evenly among the rows and columns, and boxes inside a box are resized to
+ * the size of their cell.
+ *
+ * The measured sizes are cached. A box is measured again only if children
+ * are added or removed, or if sgui_box_invalidate is called, and only the
+ * children that end up at a different position or size are changed. All
+ * changes are made in a single widget transaction. If a box grows, its
+ * parent box is updated as well. A box that is not inside another box grows
+ * to fit its content.
+ */
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Create a box that arranges its children in a single row or column
+ *
+ * \memberof sgui_box
+ *
+ * \param x        The horizontal component of the box position
+ * \param y        The vertical component of the box position
+ * \param width    The initial width of the box
+ * \param height   The initial height of the box
+ * \param vertical Non-zero to stack the children vertically, zero to place
+ *                 them next to each other horizontally
+ * \param spacing  The gap between two children in pixels
+ *
+ * \return A pointer to a new box widget
+ */
+SGUI_DLL sgui_widget* sgui_box_create( int x, int y, unsigned int width,
+                                       unsigned int height, int vertical,
+                                       unsigned int spacing );
+
+/**
+ * \brief Create a box that arranges its children in a grid
+ *
+ * \memberof sgui_box
+ *
+ * \param x       The horizontal component of the box position
+ * \param y       The vertical component of the box position
+ * \param width   The initial width of the box
+ * \param height  The initial height of the box
+ * \param columns The number of columns of the grid
+ * \param spacing The gap between two rows or columns in pixels
+ *
+ * \return A pointer to a new box widget
+ */
+SGUI_DLL sgui_widget* sgui_grid_box_create( int x, int y,
+                                            unsigned int width,
+                                            unsigned int height,
+                                            unsigned int columns,
+                                            unsigned int spacing );
+
+/**
+ * \brief Measure and arrange the children of a box again
+ *
+ * \memberof sgui_box
+ *
+ * Has to be called if the size of a child widget changed, e.g. after
+ * changing the text of a button.
+ *
+ * \param box A pointer to a box widget
+ */
+SGUI_DLL void sgui_box_invalidate( sgui_widget* box );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGUI_BOX_H */
+
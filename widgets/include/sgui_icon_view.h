@@ -93,6 +93,11 @@ SGUI_DLL sgui_widget* sgui_icon_view_create( int x, int y, unsigned width,
  *
  * \memberof sgui_icon_view
  *
+ * The icons are loaded incrementally by an idle task of the main loop (see
+ * sgui_idle_create), so populating a view with a huge number of items does
+ * not block input. Sorting the view or snapping it to a grid loads the
+ * remaining icons right away.
+ *
  * \param view A pointer to an icon view widget
  * \param root The model item to load the children from
  */
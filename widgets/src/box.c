@@ -0,0 +1,339 @@
+/*
+ * box.c
+ * This file is part of sgio
+ *
+ * Copyright (C) 2012 - David Oberhollenzer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#define SGUI_BUILDING_DLL
+#include "sgui_box.h"
+#include "sgui_internal.h"
+#include "sgui_widget.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+#ifndef SGUI_NO_BOX
+#define BOX_MEASURE 0x01
+#define BOX_PLACE   0x02
+
+#define IS_BOX( w ) ((w)->state_change_event==box_on_state_change)
+
+typedef struct
+{
+    sgui_widget super;
+
+    unsigned int columns;   /* number of columns, zero for a single row */
+    unsigned int spacing;   /* gap between two rows or columns */
+    int dirty;              /* combination of BOX_MEASURE and BOX_PLACE */
+
+    unsigned int width, height; /* cached size of the content */
+
+    unsigned int* col;      /* cached width of each column */
+    unsigned int* row;      /* cached height of each row */
+    unsigned int num_cols, num_rows, max_cols, max_rows;
+}
+sgui_box;
+
+
+
+static void box_on_state_change( sgui_widget* super, int change );
+
+static int reserve( unsigned int** array, unsigned int* size,
+                    unsigned int count )
+{
+    unsigned int* new;
+
+    if( count > *size )
+    {
+        new = sgui_internal_realloc( *array, count*sizeof(unsigned int),
+                                     SGUI_MEM(WIDGETS,BUFFER) );
+
+        if( !new )
+            return 0;
+
+        *array = new;
+        *size = count;
+    }
+
+    if( count )
+        memset( *array, 0, count*sizeof(unsigned int) );
+    return 1;
+}
+
+static int box_measure( sgui_box* this )
+{
+    sgui_widget* super = (sgui_widget*)this;
+    unsigned int i, n, w, h, cols, rows;
+    sgui_widget* c;
+    sgui_box* b;
+
+    n = super->num_children;
+    cols = this->columns ? MIN( this->columns, n ) : n;
+    rows = cols ? (n + cols - 1) / cols : 0;
+
+    if( !reserve( &this->col, &this->max_cols, cols ) ||
+        !reserve( &this->row, &this->max_rows, rows ) )
+    {
+        return 0;
+    }
+
+    for( i=0; i<n; ++i )
+    {
+        c = super->children[i];
+
+        /* nested boxes are measured by content, not by their cell */
+        if( IS_BOX( c ) )
+        {
+            b = (sgui_box*)c;
+
+            if( (b->dirty & BOX_MEASURE) && box_measure( b ) )
+                b->dirty = (b->dirty & ~BOX_MEASURE) | BOX_PLACE;
+
+            w = b->width;
+            h = b->height;
+        }
+        else
+        {
+            w = SGUI_RECT_WIDTH( c->area );
+            h = SGUI_RECT_HEIGHT( c->area );
+        }
+
+        this->col[ i % cols ] = MAX( this->col[ i % cols ], w );
+        this->row[ i / cols ] = MAX( this->row[ i / cols ], h );
+    }
+
+    this->num_cols = cols;
+    this->num_rows = rows;
+    this->width = cols ? (cols - 1) * this->spacing : 0;
+    this->height = rows ? (rows - 1) * this->spacing : 0;
+
+    for( i=0; i<cols; ++i )
+        this->width += this->col[ i ];
+
+    for( i=0; i<rows; ++i )
+        this->height += this->row[ i ];
+
+    return 1;
+}
+
+static void box_update( sgui_box* this );
+
+static void box_place( sgui_box* this )
+{
+    sgui_widget* super = (sgui_widget*)this;
+    unsigned int i, cx, cy, cw, ch = 0, ew = 0, eh = 0;
+    int x = 0, y = 0;
+    sgui_widget* c;
+
+    if( !this->num_cols || !this->num_rows )
+        return;
+
+    /* space that is left over is split among the rows and columns */
+    if( (unsigned int)SGUI_RECT_WIDTH( super->area ) > this->width )
+        ew = SGUI_RECT_WIDTH( super->area ) - this->width;
+
+    if( (unsigned int)SGUI_RECT_HEIGHT( super->area ) > this->height )
+        eh = SGUI_RECT_HEIGHT( super->area ) - this->height;
+
+    for( i=0; i<super->num_children; ++i )
+    {
+        c = super->children[i];
+        cx = i % this->num_cols;
+        cy = i / this->num_cols;
+
+        if( !cx )
+        {
+            if( i )
+            {
+                x = 0;
+                y += ch + this->spacing;
+            }
+
+            ch = this->row[ cy ] + eh / this->num_rows +
+                 (cy < eh % this->num_rows);
+        }
+
+        cw = this->col[ cx ] + ew / this->num_cols +
+             (cx < ew % this->num_cols);
+
+        if( c->area.left!=x || c->area.top!=y )
+            sgui_widget_set_position( c, x, y );
+
+        if( IS_BOX( c ) )
+        {
+            if( (unsigned int)SGUI_RECT_WIDTH( c->area )!=cw ||
+                (unsigned int)SGUI_RECT_HEIGHT( c->area )!=ch )
+            {
+                sgui_widget_set_size( c, cw, ch );
+                ((sgui_box*)c)->dirty |= BOX_PLACE;
+            }
+
+            if( ((sgui_box*)c)->dirty )
+                box_update( (sgui_box*)c );
+        }
+
+        x += cw + this->spacing;
+    }
+}
+
+static void box_update( sgui_box* this )
+{
+    sgui_widget* super = (sgui_widget*)this;
+    unsigned int w, h, aw, ah;
+
+    sgui_widget_begin_transaction( );
+
+    if( this->dirty & BOX_MEASURE )
+    {
+        w = this->width;
+        h = this->height;
+        aw = SGUI_RECT_WIDTH( super->area );
+        ah = SGUI_RECT_HEIGHT( super->area );
+
+        if( box_measure( this ) )
+            this->dirty = (this->dirty & ~BOX_MEASURE) | BOX_PLACE;
+
+        if( w!=this->width || h!=this->height )
+        {
+            if( super->parent && IS_BOX( super->parent ) )
+            {
+                ((sgui_box*)super->parent)->dirty |= BOX_MEASURE;
+                box_update( (sgui_box*)super->parent );
+            }
+            else if( this->width > aw || this->height > ah )
+            {
+                /* a box that is not in a box grows to fit its content */
+                sgui_widget_set_size( super, MAX( this->width, aw ),
+                                             MAX( this->height, ah ) );
+            }
+        }
+    }
+
+    if( this->dirty & BOX_PLACE )
+    {
+        this->dirty &= ~BOX_PLACE;
+        box_place( this );
+    }
+
+    sgui_widget_commit_transaction( );
+}
+
+static void box_on_state_change( sgui_widget* super, int change )
+{
+    sgui_box* this = (sgui_box*)super;
+
+    if( change & (SGUI_WIDGET_CHILD_ADDED|SGUI_WIDGET_CHILD_REMOVED) )
+        this->dirty |= BOX_MEASURE;
+
+    if( change & SGUI_WIDGET_SIZE_CHANGED )
+        this->dirty |= BOX_PLACE;
+
+    if( this->dirty )
+        box_update( this );
+}
+
+static void box_destroy( sgui_widget* super )
+{
+    sgui_box* this = (sgui_box*)super;
+
+    sgui_internal_free( this->col, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this->row, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
+}
+
+static sgui_widget* box_create( int x, int y, unsigned int width,
+                                unsigned int height, unsigned int columns,
+                                unsigned int spacing )
+{
+    sgui_box* this = sgui_internal_calloc( 1, sizeof(sgui_box),
+                                           SGUI_MEM(WIDGETS,OBJECT) );
+    sgui_widget* super = (sgui_widget*)this;
+
+    if( !this )
+        return NULL;
+
+    sgui_widget_init( super, x, y, width, height );
+
+    this->columns = columns;
+    this->spacing = spacing;
+
+    super->state_change_event = box_on_state_change;
+    super->destroy = box_destroy;
+    super->flags = SGUI_WIDGET_VISIBLE;
+
+    return super;
+}
+
+/****************************************************************************/
+
+sgui_widget* sgui_box_create( int x, int y, unsigned int width,
+                              unsigned int height, int vertical,
+                              unsigned int spacing )
+{
+    return box_create( x, y, width, height, vertical ? 1 : 0, spacing );
+}
+
+sgui_widget* sgui_grid_box_create( int x, int y, unsigned int width,
+                                   unsigned int height, unsigned int columns,
+                                   unsigned int spacing )
+{
+    return box_create( x, y, width, height, columns ? columns : 1, spacing );
+}
+
+void sgui_box_invalidate( sgui_widget* super )
+{
+    sgui_internal_lock_mutex( );
+
+    if( IS_BOX( super ) )
+    {
+        ((sgui_box*)super)->dirty |= BOX_MEASURE;
+        box_update( (sgui_box*)super );
+    }
+
+    sgui_internal_unlock_mutex( );
+}
+#elif defined(SGUI_NOP_IMPLEMENTATIONS)
+sgui_widget* sgui_box_create( int x, int y, unsigned int width,
+                              unsigned int height, int vertical,
+                              unsigned int spacing )
+{
+    (void)x; (void)y; (void)width; (void)height; (void)vertical;
+    (void)spacing;
+    return NULL;
+}
+
+sgui_widget* sgui_grid_box_create( int x, int y, unsigned int width,
+                                   unsigned int height, unsigned int columns,
+                                   unsigned int spacing )
+{
+    (void)x; (void)y; (void)width; (void)height; (void)columns;
+    (void)spacing;
+    return NULL;
+}
+
+void sgui_box_invalidate( sgui_widget* box )
+{
+    (void)box;
+}
+#endif /* !SGUI_NO_BOX */
+
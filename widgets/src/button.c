@@ -95,7 +95,7 @@ static void button_select( sgui_button* this, int selected, int postevent )
     if( this->super.canvas )
     {
         sgui_widget_get_absolute_rect( &(this->super), &r );
-        sgui_canvas_add_dirty_rect( this->super.canvas, &r );
+        sgui_widget_add_dirty_rect( &this->super, &r );
     }
 
     if( postevent )
@@ -118,7 +118,7 @@ static void button_select( sgui_button* this, int selected, int postevent )
             if( i->super.canvas )
             {
                 sgui_widget_get_absolute_rect( &(i->super), &r );
-                sgui_canvas_add_dirty_rect( i->super.canvas, &r );
+                sgui_widget_add_dirty_rect( &i->super, &r );
             }
             goto done;
         }
@@ -133,7 +133,7 @@ static void button_select( sgui_button* this, int selected, int postevent )
             if( i->super.canvas )
             {
                 sgui_widget_get_absolute_rect( &(i->super), &r );
-                sgui_canvas_add_dirty_rect( i->super.canvas, &r );
+                sgui_widget_add_dirty_rect( &i->super, &r );
             }
             goto done;
         }
@@ -264,9 +264,9 @@ static void button_destroy( sgui_widget* super )
 
     /* free memory of text buffer and button */
     if( !(this->flags & HAVE_ICON) )
-        free( this->dpy.text );
+        sgui_internal_free( this->dpy.text, SGUI_ALLOC_BUFFER );
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static sgui_widget* button_create_common( int x, int y, unsigned int width,
@@ -281,7 +281,8 @@ static sgui_widget* button_create_common( int x, int y, unsigned int width,
     sgui_skin* skin;
     sgui_rect r;
 
-    this = calloc( 1, sizeof(sgui_button) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_button),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
     if( !this )
@@ -298,9 +299,11 @@ static sgui_widget* button_create_common( int x, int y, unsigned int width,
     else
 #endif
     {
-        if( !(this->dpy.text = sgui_strdup( text )) )
+        this->dpy.text = sgui_internal_strdup( text, SGUI_MEMORY_WIDGETS );
+
+        if( !this->dpy.text )
         {
-            free( this );
+            sgui_internal_free( this, SGUI_ALLOC_OBJECT );
             return NULL;
         }
 
@@ -428,10 +431,10 @@ void sgui_button_set_text( sgui_widget* super, const char* text )
 
     /* adjust buffer size and copy */
     if( !(this->flags & HAVE_ICON) )
-        free( this->dpy.text );
+        sgui_internal_free( this->dpy.text, SGUI_ALLOC_BUFFER );
 
     this->flags &= ~HAVE_ICON;
-    this->dpy.text = sgui_strdup( text );
+    this->dpy.text = sgui_internal_strdup( text, SGUI_MEMORY_WIDGETS );
 
     /* determine text position */
     if( (this->flags & 0x03)==BUTTON || (this->flags & 0x03)==TOGGLE_BUTTON )
@@ -442,6 +445,7 @@ void sgui_button_set_text( sgui_widget* super, const char* text )
     else
     {
         super->area.right = super->area.left + this->cx + text_width;
+        sgui_internal_widget_update_index( super );
     }
 
     sgui_internal_unlock_mutex( );
@@ -461,7 +465,7 @@ void sgui_button_set_icon( sgui_widget* super, sgui_icon_cache* cache,
 
     /* copy display data */
     if( !(this->flags & HAVE_ICON) )
-        free( this->dpy.text );
+        sgui_internal_free( this->dpy.text, SGUI_ALLOC_BUFFER );
 
     this->flags |= HAVE_ICON;
     this->dpy.icon.cache = cache;
@@ -496,6 +500,7 @@ void sgui_button_set_icon( sgui_widget* super, sgui_icon_cache* cache,
         sgui_rect_set_size( &(super->area),
                             super->area.left, super->area.right,
                             width, height );
+        sgui_internal_widget_update_index( super );
     }
 
     sgui_internal_unlock_mutex( );
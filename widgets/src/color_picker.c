@@ -231,16 +231,16 @@ static void color_picker_destroy( sgui_widget* super )
 {
     sgui_color_picker* this = (sgui_color_picker*)super;
 
-    free( this->vbardata );
-    free( this->abardata );
-    free( this->hsdata );
+    sgui_internal_free( this->vbardata, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this->abardata, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this->hsdata, SGUI_ALLOC_PIXELS );
     if( this->hs )
         sgui_pixmap_destroy( this->hs );
     if( this->vbar )
         sgui_pixmap_destroy( this->vbar );
     if( this->abar )
         sgui_pixmap_destroy( this->abar );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void color_picker_on_event( sgui_widget* super, const sgui_event* e )
@@ -426,7 +426,9 @@ static void color_picker_on_state_change( sgui_widget* super, int change )
 
 sgui_widget* sgui_color_picker_create( int x, int y )
 {
-    sgui_color_picker* this = calloc( 1, sizeof(sgui_color_picker) );
+    sgui_color_picker* this = sgui_internal_calloc( 1,
+                                                    sizeof(sgui_color_picker),
+                                                    SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
     unsigned char* ptr;
     int i, j, h, s;
@@ -438,13 +440,16 @@ sgui_widget* sgui_color_picker_create( int x, int y )
                                    IMAGE_H + DISP_H + DISP_GAP );
 
     /* allocate image data */
-    if( !(this->hsdata = malloc( IMAGE_W*IMAGE_H*3 )) )
+    if( !(this->hsdata = sgui_internal_malloc( IMAGE_W*IMAGE_H*3,
+                                               SGUI_MEM(WIDGETS,PIXELS) )) )
         goto fail;
 
-    if( !(this->vbardata = malloc( IMAGE_H*BAR_W*3 )) )
+    if( !(this->vbardata = sgui_internal_malloc( IMAGE_H*BAR_W*3,
+                                                 SGUI_MEM(WIDGETS,PIXELS) )) )
         goto fail;
 
-    if( !(this->abardata = malloc( IMAGE_H*BAR_W*3 )) )
+    if( !(this->abardata = sgui_internal_malloc( IMAGE_H*BAR_W*3,
+                                                 SGUI_MEM(WIDGETS,PIXELS) )) )
         goto fail;
 
     /* fill images */
@@ -471,9 +476,9 @@ sgui_widget* sgui_color_picker_create( int x, int y )
                                 SGUI_FOCUS_DROP_TAB|SGUI_WIDGET_VISIBLE;
     return super;
 fail:
-    free( this->vbardata );
-    free( this->hsdata );
-    free( this );
+    sgui_internal_free( this->vbardata, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this->hsdata, SGUI_ALLOC_PIXELS );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
     return NULL;
 }
 
@@ -530,17 +535,17 @@ void sgui_color_picker_set_hsv( sgui_widget* super,
                 this->last_changed = CHANGED_V;
             }
 
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
 
             sgui_widget_get_absolute_rect( super, &r );
             r.right = r.left + 2*DISP_W + DISP_GAP_H - 1;
             r.top   = r.bottom - DISP_H - 1;
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
         else
         {
             this->last_changed = CHANGED_HS;
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
     }
 
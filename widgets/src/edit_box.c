@@ -403,15 +403,15 @@ static void edit_box_on_event( sgui_widget* super, const sgui_event* e )
     if( update )
     {
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
     }
     sgui_internal_unlock_mutex( );
 }
 
 static void edit_box_destroy( sgui_widget* this )
 {
-    free( ((sgui_edit_box*)this)->buffer );
-    free( this );
+    sgui_internal_free( ((sgui_edit_box*)this)->buffer, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -419,7 +419,8 @@ static void edit_box_destroy( sgui_widget* this )
 sgui_widget* sgui_edit_box_create( int x, int y, unsigned int width,
                                    unsigned int max_chars )
 {
-    sgui_edit_box* this = calloc( 1, sizeof(sgui_edit_box) );
+    sgui_edit_box* this = sgui_internal_calloc( 1, sizeof(sgui_edit_box),
+                                                SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
 
     if( !this )
@@ -427,7 +428,7 @@ sgui_widget* sgui_edit_box_create( int x, int y, unsigned int width,
 
     if( !sgui_edit_box_init( this, x, y, width, max_chars ) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -440,7 +441,8 @@ int sgui_edit_box_init( sgui_edit_box* this, int x, int y, unsigned int width,
     sgui_widget* super = (sgui_widget*)this;
     sgui_skin* skin;
 
-    this->buffer = malloc( max_chars * 6 + 1 );
+    this->buffer = sgui_internal_malloc( max_chars * 6 + 1,
+                                         SGUI_MEM(WIDGETS,BUFFER) );
 
     if( !this->buffer )
         return 0;
@@ -498,7 +500,7 @@ void sgui_edit_box_set_text( sgui_widget* super, const char* text )
     if( super->canvas )
     {
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
     }
     sgui_internal_unlock_mutex( );
 }
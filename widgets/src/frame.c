@@ -54,59 +54,44 @@ sgui_frame;
 
 
 
+/* get the frame relative area that displays the scrolled children */
+static void frame_get_view( sgui_frame* this, sgui_rect* r )
+{
+    sgui_widget* super = (sgui_widget*)this;
+
+    r->left   = this->h_border;
+    r->top    = this->v_border;
+    r->right  = SGUI_RECT_WIDTH( super->area ) - this->h_border - 1;
+    r->bottom = SGUI_RECT_HEIGHT( super->area ) - this->v_border - 1;
+
+    if( this->v_bar->flags & SGUI_WIDGET_VISIBLE )
+        r->right = this->v_bar_dist - 1;
+
+    if( this->h_bar->flags & SGUI_WIDGET_VISIBLE )
+        r->bottom = this->h_bar_dist - 1;
+}
+
 static void frame_on_scroll_v( void* userptr, int new_offset, int delta )
 {
     sgui_widget* this = userptr;
-    sgui_widget* i;
     sgui_rect r;
-    int x, y;
-    (void)new_offset;
+    (void)delta;
 
     sgui_internal_lock_mutex( );
-    if( this->canvas )
-    {
-        sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
-    }
-
-    for( i=this->children; i!=NULL; i=i->next )
-    {
-        if( i!=((sgui_frame*)this)->v_bar && i!=((sgui_frame*)this)->h_bar )
-        {
-            sgui_widget_get_position( i, &x, &y );
-            y -= delta;
-            sgui_widget_set_position( i, x, y );
-        }
-    }
-
+    frame_get_view( (sgui_frame*)this, &r );
+    sgui_widget_set_content_offset( this, this->scroll_x, new_offset, &r );
     sgui_internal_unlock_mutex( );
 }
 
 static void frame_on_scroll_h( void* userptr, int new_offset, int delta )
 {
     sgui_widget* this = userptr;
-    sgui_widget* i;
     sgui_rect r;
-    int x, y;
-    (void)new_offset;
+    (void)delta;
 
     sgui_internal_lock_mutex( );
-    if( this->canvas )
-    {
-        sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
-    }
-
-    for( i=this->children; i!=NULL; i=i->next )
-    {
-        if( i!=((sgui_frame*)this)->v_bar && i!=((sgui_frame*)this)->h_bar )
-        {
-            sgui_widget_get_position( i, &x, &y );
-            x -= delta;
-            sgui_widget_set_position( i, x, y );
-        }
-    }
-
+    frame_get_view( (sgui_frame*)this, &r );
+    sgui_widget_set_content_offset( this, new_offset, this->scroll_y, &r );
     sgui_internal_unlock_mutex( );
 }
 
@@ -119,39 +104,25 @@ static void frame_draw( sgui_widget* this )
 static void frame_destroy( sgui_widget* super )
 {
     sgui_frame* this = (sgui_frame*)super;
-    sgui_widget* i;
+    sgui_widget* w;
+    unsigned int i;
 
     /* recursive destroy might have already destroyed the scrollbars */
-    if( super->children )
+    for( i=0; i<super->num_children; ++i )
     {
-        for( i=super->children; i!=NULL; i=i->next )
-        {
-            if( i->next == this->v_bar )
-            {
-                i->next = i->next->next;
-                sgui_widget_destroy( this->v_bar );
-                break;
-            }
-        }
+        w = super->children[i];
 
-        for( i=super->children; i!=NULL; i=i->next )
-        {
-            if( i->next == this->h_bar )
-            {
-                i->next = i->next->next;
-                sgui_widget_destroy( this->h_bar );
-                break;
-            }
-        }
+        if( w==this->v_bar || w==this->h_bar )
+            sgui_widget_destroy( w );
     }
 
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void frame_on_state_change( sgui_widget* super, int change )
 {
     sgui_frame* this = (sgui_frame*)super;
-    unsigned int w, ww, wh, width, height, new_height, new_width;
+    unsigned int w, ww, wh, width, height, new_height, new_width, n;
     sgui_skin* skin = sgui_skin_get( );
     sgui_widget* i;
     sgui_rect r;
@@ -167,8 +138,10 @@ static void frame_on_state_change( sgui_widget* super, int change )
         new_width = 0;
 
         /* determine the required frame size */
-        for( i=super->children; i!=NULL; i=i->next )
+        for( n=0; n<super->num_children; ++n )
         {
+            i = super->children[n];
+
             if( i!=this->v_bar && i!=this->h_bar )
             {
                 sgui_widget_get_position( i, &wx, &wy );
@@ -310,7 +283,8 @@ static void frame_on_event( sgui_widget* super, const sgui_event* event )
 sgui_widget* sgui_frame_create( int x, int y, unsigned int width,
                                 unsigned int height )
 {
-    sgui_frame* this = calloc( 1, sizeof(sgui_frame) );
+    sgui_frame* this = sgui_internal_calloc( 1, sizeof(sgui_frame),
+                                             SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
     sgui_skin* skin = sgui_skin_get( );
     unsigned int w, h;
@@ -336,7 +310,7 @@ sgui_widget* sgui_frame_create( int x, int y, unsigned int width,
 
     if( !this->v_bar )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -353,7 +327,7 @@ sgui_widget* sgui_frame_create( int x, int y, unsigned int width,
 
     if( !this->h_bar )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -362,6 +336,8 @@ sgui_widget* sgui_frame_create( int x, int y, unsigned int width,
     sgui_scroll_bar_on_scroll( this->h_bar, frame_on_scroll_h, this );
     sgui_widget_set_visible( this->v_bar, 0 );
     sgui_widget_set_visible( this->h_bar, 0 );
+    this->v_bar->flags |= SGUI_WIDGET_FIXED;
+    this->h_bar->flags |= SGUI_WIDGET_FIXED;
     sgui_widget_add_child( super, this->v_bar );
     sgui_widget_add_child( super, this->h_bar );
 
@@ -57,8 +57,8 @@ static void group_box_destroy( sgui_widget* super )
 {
     sgui_group_box* this = (sgui_group_box*)super;
 
-    free( this->caption );
-    free( this );
+    sgui_internal_free( this->caption, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 
@@ -67,16 +67,19 @@ sgui_widget* sgui_group_box_create( int x, int y,
                                     unsigned int width, unsigned int height,
                                     const char* caption )
 {
-    sgui_group_box* this = calloc( 1, sizeof(sgui_group_box) );
+    sgui_group_box* this = sgui_internal_calloc( 1, sizeof(sgui_group_box),
+                                                 SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
 
     if( !this )
         return NULL;
 
     /* try to store the caption string */
-    if( !(this->caption = sgui_strdup( caption )) )
+    this->caption = sgui_internal_strdup( caption, SGUI_MEMORY_WIDGETS );
+
+    if( !this->caption )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -30,6 +30,7 @@
 #include "sgui_widget.h"
 #include "sgui_event.h"
 #include "sgui_model.h"
+#include "sgui_loop.h"
 #include "sgui_skin.h"
 
 #include <stdlib.h>
@@ -42,6 +43,9 @@
 #define IV_SELECTBOX   0x04
 #define IV_DRAW_BG     0x08
 
+/* number of icons loaded between checks whether to yield to the main loop */
+#define POPULATE_CHUNK 32
+
 
 
 typedef struct
@@ -68,6 +72,15 @@ typedef struct
     int offset;             /* the offset from the border of the view */
 
     const sgui_item* itemlist;
+
+    const sgui_item* next_item; /* next item to load an icon for */
+    unsigned int num_items;     /* number of items in the item list */
+    sgui_idle* populate;        /* idle task loading the icons, if any */
+
+    unsigned int num_placed;    /* number of icons placed in the grid */
+    unsigned int max_w, max_h;  /* size of the largest icon placed */
+    unsigned int next_x, next_y;/* grid position of the next icon */
+    int bottom;                 /* lowest edge of all icons */
 }
 icon_view;
 
@@ -78,7 +91,7 @@ icon_view;
         get_icon_bounding_box( this, &(icon), &r );\
         r.bottom -= offset;\
         r.top -= offset;\
-        sgui_canvas_add_dirty_rect( this->super.canvas, &r )
+        sgui_widget_add_dirty_rect( &this->super, &r )
 
 
 static int compare( icon_view* this, sgui_item_compare_fun fun,
@@ -137,27 +150,30 @@ static void draw_icon( icon_view* this, icon* i, sgui_skin* skin,
                          sgui_item_text(this->model,i->item,this->txt_col) );
 }
 
-static void ideal_grid_size( icon_view* this,
-                             unsigned int* grid_w, unsigned int* grid_h )
+/* grow the largest icon size, returns non-zero if it changed */
+static int measure_icons( icon_view* this, unsigned int start )
 {
-    unsigned int w, h, i;
-
-    *grid_w = 0;
-    *grid_h = 0;
+    unsigned int w, h, i, old_w = this->max_w, old_h = this->max_h;
 
-    for( i=0; i<this->num_icons; ++i )
+    for( i=start; i<this->num_icons; ++i )
     {
         w = SGUI_RECT_WIDTH( this->icons[i].icon_area );
-        *grid_w = MAX(*grid_w, w);
+        this->max_w = MAX(this->max_w, w);
         w = SGUI_RECT_WIDTH( this->icons[i].text_area );
-        *grid_w = MAX(*grid_w, w);
+        this->max_w = MAX(this->max_w, w);
         h = SGUI_RECT_HEIGHT(this->icons[i].icon_area) +
             SGUI_RECT_HEIGHT(this->icons[i].text_area);
-        *grid_h = MAX(*grid_h, h);
+        this->max_h = MAX(this->max_h, h);
     }
 
-    *grid_w += *grid_w/5;
-    *grid_h += *grid_h/10;
+    return this->max_w!=old_w || this->max_h!=old_h;
+}
+
+static void ideal_grid_size( icon_view* this,
+                             unsigned int* grid_w, unsigned int* grid_h )
+{
+    *grid_w = this->max_w + this->max_w/5;
+    *grid_h = this->max_h + this->max_h/10;
 }
 
 static void view_on_scroll_v( void* userptr, int new_offset, int delta )
@@ -170,21 +186,31 @@ static void view_on_scroll_v( void* userptr, int new_offset, int delta )
     if( this->canvas )
     {
         sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
+        sgui_widget_add_dirty_rect( this, &r );
     }
 }
 
-static void gridify( icon_view* this )
+/* place the icons from start on, after the ones placed before */
+static void place_icons( icon_view* this, unsigned int start )
 {
     unsigned int x, y, grid_w, grid_h, total_w, txt_w, txt_h, img_w, img_h, i;
     int dx, dy;
 
     ideal_grid_size( this, &grid_w, &grid_h );
-
-    x = y = this->offset;
     total_w = SGUI_RECT_WIDTH(this->super.area) - 2*this->offset;
 
-    for( i=0; i<this->num_icons; ++i )
+    if( start )
+    {
+        x = this->next_x;
+        y = this->next_y;
+    }
+    else
+    {
+        x = y = this->offset;
+        this->bottom = 0;
+    }
+
+    for( i=start; i<this->num_icons; ++i )
     {
         if( (x + grid_w) >= total_w )
         {
@@ -206,9 +232,21 @@ static void gridify( icon_view* this )
         sgui_rect_set_size( &this->icons[i].text_area, x + dx,
                             this->icons[i].icon_area.bottom, txt_w, txt_h );
 
+        this->bottom = MAX(this->bottom, this->icons[i].icon_area.bottom);
+        this->bottom = MAX(this->bottom, this->icons[i].text_area.bottom);
         x += grid_w;
     }
 
+    this->next_x = x;
+    this->next_y = y;
+    this->num_placed = this->num_icons;
+}
+
+static void gridify( icon_view* this )
+{
+    this->max_w = this->max_h = 0;
+    measure_icons( this, 0 );
+    place_icons( this, 0 );
     view_on_scroll_v( this, 0, 0 );
 }
 
@@ -267,25 +305,13 @@ static void generate_event_for_each_selected( icon_view* this, int type )
     }
 }
 
-static void update_scroll_area( icon_view* this )
+/* resize the scroll bar to the lowest edge of the icons */
+static void set_scroll_length( icon_view* this )
 {
-    unsigned int i, length = 0, displength;
-    sgui_rect r;
+    unsigned int length = 0, displength;
 
     if( this->num_icons )
-    {
-        r = this->icons[0].icon_area;
-        sgui_rect_join( &r, &this->icons[0].text_area, 0 );
-
-        for( i=1; i<this->num_icons; ++i )
-        {
-            sgui_rect_join( &r, &this->icons[i].icon_area, 0 );
-            sgui_rect_join( &r, &this->icons[i].text_area, 0 );
-        }
-
-        r.top = 0;
-        length = SGUI_RECT_HEIGHT( r ) + 10;
-    }
+        length = this->bottom + 1 + 10;
 
     displength = SGUI_RECT_HEIGHT(this->super.area);
     length = MAX(length, displength);
@@ -297,6 +323,32 @@ static void update_scroll_area( icon_view* this )
         sgui_scroll_bar_set_offset( this->v_bar, 0 );
 }
 
+static void update_scroll_area( icon_view* this )
+{
+    unsigned int i;
+
+    for( this->bottom=0, i=0; i<this->num_icons; ++i )
+    {
+        this->bottom = MAX(this->bottom, this->icons[i].icon_area.bottom);
+        this->bottom = MAX(this->bottom, this->icons[i].text_area.bottom);
+    }
+
+    set_scroll_length( this );
+}
+
+/* add the icons loaded since the last call to the grid */
+static void gridify_new( icon_view* this )
+{
+    /* a larger icon changes the grid size for all of them */
+    if( measure_icons( this, this->num_placed ) )
+        place_icons( this, 0 );
+    else
+        place_icons( this, this->num_placed );
+
+    view_on_scroll_v( this, 0, 0 );
+    set_scroll_length( this );
+}
+
 static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
 {
     icon_view* this = (icon_view*)super;
@@ -330,7 +382,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
             get_icon_bounding_box( this, new, &r );
             r.top -= offset;
             r.bottom -= offset;
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
         else if( !(this->flags & IV_MULTISELECT) )
         {
@@ -392,7 +444,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
         sgui_rect_extend( &r1, 1, 1 );
         r1.top -= offset;
         r1.bottom -= offset;
-        sgui_canvas_add_dirty_rect( super->canvas, &r1 );
+        sgui_widget_add_dirty_rect( super, &r1 );
 
         /* get selected icons */
         for( i=0; i<this->num_icons; ++i )
@@ -406,7 +458,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
                 get_icon_bounding_box( this, this->icons+i, &r );
                 r.top -= offset;
                 r.bottom -= offset;
-                sgui_canvas_add_dirty_rect( super->canvas, &r );
+                sgui_widget_add_dirty_rect( super, &r );
             }
         }
     }
@@ -468,7 +520,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
         {
             sgui_widget_get_absolute_position( super, &x, &y );
             sgui_rect_add_offset( &r1, x, y-offset );
-            sgui_canvas_add_dirty_rect( super->canvas, &r1 );
+            sgui_widget_add_dirty_rect( super, &r1 );
         }
 
         update_scroll_area( this );
@@ -566,7 +618,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
         if( this->flags & IV_DRAG )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
         else if( this->flags & IV_SELECTBOX )
         {
@@ -578,7 +630,7 @@ static void icon_view_on_event( sgui_widget* super, const sgui_event* e )
             sgui_widget_get_absolute_position( &(this->super), &x, &y );
             sgui_rect_add_offset( &r, x, y );
             sgui_rect_extend( &r, 1, 1 );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
 
         this->flags &= ~(IV_DRAG|IV_SELECTBOX);
@@ -635,28 +687,95 @@ static void icon_view_draw( sgui_widget* super )
     sgui_canvas_set_scissor_rect( super->canvas, &sc );
 }
 
+/* load up to count icons, returns non-zero if there are icons left */
+static int load_icons( icon_view* this, unsigned int count )
+{
+    const sgui_icon* ic;
+    const char* subtext;
+    icon* i;
+
+    for( ; count && this->next_item && this->num_icons<this->num_items;
+         --count )
+    {
+        i = this->icons + this->num_icons++;
+
+        ic      = sgui_item_icon( this->model, this->next_item,
+                                  this->icon_col );
+        subtext = sgui_item_text( this->model, this->next_item,
+                                  this->txt_col );
+
+        sgui_icon_get_area( ic, &i->icon_area );
+        sgui_skin_get_text_extents( subtext, &i->text_area );
+
+        i->item = this->next_item;
+        this->next_item = this->next_item->next;
+    }
+
+    return this->next_item && this->num_icons<this->num_items;
+}
+
+/* idle task that loads icons in slices, laying out the new ones */
+static int populate_step( sgui_idle* idle, void* user )
+{
+    icon_view* this = user;
+    int more;
+
+    sgui_internal_lock_mutex( );
+
+    /*
+        destroyed together with the view or by a restart while we waited
+        for the mutex, so the view itself might be gone already
+     */
+    if( sgui_idle_is_destroyed( idle ) )
+    {
+        sgui_internal_unlock_mutex( );
+        return 0;
+    }
+
+    while( (more = load_icons( this, POPULATE_CHUNK )) &&
+           !sgui_idle_should_yield( ) );
+
+    gridify_new( this );
+
+    if( !more )
+        this->populate = NULL;
+
+    sgui_internal_unlock_mutex( );
+    return more;
+}
+
+/* load the remaining icons right away, e.g. before sorting them */
+static void finish_populate( icon_view* this )
+{
+    if( this->populate )
+    {
+        sgui_idle_destroy( this->populate );
+        this->populate = NULL;
+        load_icons( this, this->num_items );
+        gridify_new( this );
+    }
+}
+
 static void icon_view_destroy( sgui_widget* super )
 {
     icon_view* this = (icon_view*)super;
-    sgui_widget* i;
+    unsigned int i;
+
+    sgui_idle_destroy( this->populate );
 
     /* recursive destroy might have already destroyed the scrollbar */
-    if( super->children )
+    for( i=0; i<super->num_children; ++i )
     {
-        for( i=super->children; i!=NULL; i=i->next )
+        if( super->children[i]==this->v_bar )
         {
-            if( i->next == this->v_bar )
-            {
-                i->next = i->next->next;
-                sgui_widget_destroy( this->v_bar );
-                break;
-            }
+            sgui_widget_destroy( this->v_bar );
+            break;
         }
     }
 
     sgui_model_free_item_list( this->model, this->itemlist );
-    free( this->icons );
-    free( this );
+    sgui_internal_free( this->icons, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /***************************************************************************/
@@ -677,7 +796,8 @@ sgui_widget* sgui_icon_view_create( int x, int y, unsigned width,
     if( !model )
         return NULL;
 
-    this = calloc( 1, sizeof(icon_view) );
+    this = sgui_internal_calloc( 1, sizeof(icon_view),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
     if( !this )
@@ -705,7 +825,7 @@ sgui_widget* sgui_icon_view_create( int x, int y, unsigned width,
 
     if( !this->v_bar )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -727,46 +847,46 @@ sgui_widget* sgui_icon_view_create( int x, int y, unsigned width,
 void sgui_icon_view_populate( sgui_widget* super, sgui_item* root )
 {
     icon_view* this = (icon_view*)super;
-    const sgui_item* i;
-    const char* subtext;
-    const sgui_icon* ic;
-    unsigned int j;
 
     sgui_internal_lock_mutex( );
+    sgui_idle_destroy( this->populate );
+    this->populate = NULL;
+
     sgui_model_free_item_list( this->model, this->itemlist );
     this->itemlist = sgui_model_query_items( this->model, root, 0, 0 );
 
     if( !this->itemlist )
         goto fail;
 
-    this->num_icons = sgui_model_item_children_count( this->model, root );
-    this->icons = realloc( this->icons, this->num_icons*sizeof(icon) );
+    this->num_items = sgui_model_item_children_count( this->model, root );
+    this->icons = sgui_internal_realloc( this->icons,
+                                         this->num_items*sizeof(icon),
+                                         SGUI_MEM(WIDGETS,BUFFER) );
 
     if( !this->icons )
         goto fail;
 
-    memset( this->icons, 0, this->num_icons*sizeof(icon) );
+    memset( this->icons, 0, this->num_items*sizeof(icon) );
+    this->next_item = this->itemlist;
+    this->num_icons = 0;
 
-    for( i=this->itemlist, j=0; i && j<this->num_icons; i=i->next, ++j )
-    {
-        ic      = sgui_item_icon( this->model, i, this->icon_col );
-        subtext = sgui_item_text( this->model, i, this->txt_col );
+    /* the icons are loaded in slices by the main loop */
+    this->populate = sgui_idle_create( populate_step, this );
 
-        sgui_icon_get_area( ic, &this->icons[j].icon_area );
-        sgui_skin_get_text_extents( subtext, &this->icons[j].text_area );
-
-        this->icons[j].item = i;
-    }
+    if( !this->populate )
+        load_icons( this, this->num_items );
 
     gridify( this );
-    update_scroll_area( this );
+    set_scroll_length( this );
     sgui_internal_unlock_mutex( );
     return;
 fail:
-    free( this->icons );
+    sgui_internal_free( this->icons, SGUI_ALLOC_BUFFER );
     sgui_model_free_item_list( this->model, this->itemlist );
+    this->icons = NULL;
     this->itemlist = NULL;
-    this->num_icons = 0;
+    this->next_item = NULL;
+    this->num_icons = this->num_items = this->num_placed = 0;
     sgui_internal_unlock_mutex( );
 }
 
@@ -778,6 +898,7 @@ void sgui_icon_view_snap_to_grid( sgui_widget* super )
     int dx, dy;
 
     sgui_internal_lock_mutex( );
+    finish_populate( this );
     ideal_grid_size( this, &grid_w, &grid_h );
 
     for( i=0; i<this->num_icons; ++i )
@@ -805,6 +926,8 @@ void sgui_icon_view_sort( sgui_widget* super, sgui_item_compare_fun fun )
         return;
 
     sgui_internal_lock_mutex( );
+    finish_populate( this );
+
     for( k=this->num_icons/2; k>=1; --k )
         sink( this, fun, this->icons, k, this->num_icons );
 
@@ -815,7 +938,7 @@ void sgui_icon_view_sort( sgui_widget* super, sgui_item_compare_fun fun )
     }
 
     gridify( this );
-    update_scroll_area( this );
+    set_scroll_length( this );
     sgui_internal_unlock_mutex( );
 }
 #elif defined(SGUI_NOP_IMPLEMENTATIONS)
@@ -42,6 +42,7 @@ typedef struct
     int format, blend, backend, useptr;
 
     sgui_pixmap* pixmap;
+    int stale;              /* reloaded while the widget had no canvas */
 }
 sgui_image;
 
@@ -63,11 +64,14 @@ static void image_destroy( sgui_widget* super )
     sgui_image* this = (sgui_image*)super;
 
     if( !this->useptr )
-        free( this->data );
+        sgui_internal_free( this->data, SGUI_ALLOC_PIXELS );
 
-    if( this->pixmap )
+    if( this->pixmap && super->canvas )
+        sgui_canvas_release_pixmap( super->canvas, this->pixmap );
+    else if( this->pixmap )
         sgui_pixmap_destroy( this->pixmap );
-    free( this );
+
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 static void image_on_state_change( sgui_widget* super, int change )
@@ -78,26 +82,40 @@ static void image_on_state_change( sgui_widget* super, int change )
     if( change & SGUI_WIDGET_CANVAS_CHANGED )
     {
         sgui_internal_lock_mutex( );
-
-        if( this->pixmap )
+        sgui_widget_get_size( super, &w, &h );
+
+        /*
+            Keep the pixmap while the widget has no canvas, so it can be
+            reused if the next canvas is of the same backend.
+         */
+        if( this->pixmap && super->canvas &&
+            (this->pixmap->width!=w || this->pixmap->height!=h ||
+             !sgui_canvas_adopt_pixmap( super->canvas, this->pixmap )) )
         {
             sgui_pixmap_destroy( this->pixmap );
             this->pixmap = NULL;
         }
 
-        if( super->canvas )
+        if( super->canvas && !this->pixmap )
         {
-            sgui_widget_get_size( super, &w, &h );
             this->pixmap = sgui_canvas_create_pixmap( super->canvas, w, h,
                                                       this->format );
+            this->stale = 1;
+        }
 
-            if( this->pixmap )
-            {
-                sgui_pixmap_load( this->pixmap, 0, 0, this->data, 0, 0, w, h,
-                                  w, this->format );
-            }
+        if( this->pixmap && super->canvas && this->stale )
+        {
+            sgui_pixmap_load( this->pixmap, 0, 0, this->data, 0, 0, w, h,
+                              w, this->format );
+            this->stale = 0;
         }
 
+        /* unblended color images overwrite everything below them */
+        super->flags &= ~SGUI_WIDGET_OPAQUE;
+
+        if( this->pixmap && !this->blend && this->format!=SGUI_A8 )
+            super->flags |= SGUI_WIDGET_OPAQUE;
+
         sgui_internal_unlock_mutex( );
     }
 }
@@ -109,7 +127,8 @@ sgui_widget* sgui_image_create( int x, int y,
                                 const void* data, int format,
                                 int blend, int useptr )
 {
-    sgui_image* this = calloc( 1, sizeof(sgui_image) );
+    sgui_image* this = sgui_internal_calloc( 1, sizeof(sgui_image),
+                                             SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
     unsigned int num_bytes;
 
@@ -122,11 +141,12 @@ sgui_widget* sgui_image_create( int x, int y,
     {
         num_bytes = width*height*(format==SGUI_RGBA8 ? 4 :
                                   (format==SGUI_RGB8 ? 3 : 1));
-        this->data = malloc( num_bytes );
+        this->data = sgui_internal_malloc( num_bytes,
+                                           SGUI_MEM(WIDGETS,PIXELS) );
 
         if( !this->data )
         {
-            free( this );
+            sgui_internal_free( this, SGUI_ALLOC_OBJECT );
             return NULL;
         }
 
@@ -175,6 +195,13 @@ void sgui_image_reload( sgui_widget* super, unsigned int x, unsigned int y,
     if( !width || !height )
         return;
 
+    /* uploading needs a canvas, catch up when the widget gets one */
+    if( !super->canvas )
+    {
+        this->stale = 1;
+        return;
+    }
+
     /* reupload image portion */
     sgui_pixmap_load( this->pixmap, x, y, this->data, x, y, width, height,
                       scan, this->format );
@@ -187,7 +214,7 @@ void sgui_image_reload( sgui_widget* super, unsigned int x, unsigned int y,
         r.top += y;
         r.right = r.left + width - 1;
         r.bottom = r.top + height - 1;
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
     }
 }
 
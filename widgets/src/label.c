@@ -56,8 +56,8 @@ static void label_draw( sgui_widget* super )
 
 static void label_destroy( sgui_widget* this )
 {
-    free( ((sgui_label*)this)->text );
-    free( this );
+    sgui_internal_free( ((sgui_label*)this)->text, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 
@@ -68,12 +68,16 @@ sgui_widget* sgui_label_create( int x, int y, const char* text )
     sgui_widget* super;
 
     /* create widget */
-    this = calloc( 1, sizeof(sgui_label) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_label),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
-    if( !this || !(this->text = sgui_strdup( text )) )
+    if( !this )
+        return NULL;
+
+    if( !(this->text = sgui_internal_strdup( text, SGUI_MEMORY_WIDGETS )) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -281,11 +281,13 @@ static int numeric_edit_init( sgui_numeric_edit* this,
 sgui_widget* sgui_numeric_edit_create( int x, int y, unsigned int width,
                                        int min, int max, int current )
 {
-    sgui_numeric_edit* this = calloc( 1, sizeof(sgui_numeric_edit) );
+    sgui_numeric_edit* this = sgui_internal_calloc( 1,
+                                                    sizeof(sgui_numeric_edit),
+                                                    SGUI_MEM(WIDGETS,OBJECT) );
 
     if( this && !numeric_edit_init( this, x, y, width, min, max, current ) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
     return (sgui_widget*)this;
@@ -295,7 +297,8 @@ sgui_widget* sgui_spin_box_create( int x, int y, unsigned int width,
                                    int min, int max, int current,
                                    unsigned int stepsize, int editable )
 {
-    sgui_spin_box* this = calloc( 1, sizeof(sgui_spin_box) );
+    sgui_spin_box* this = sgui_internal_calloc( 1, sizeof(sgui_spin_box),
+                                                SGUI_MEM(WIDGETS,OBJECT) );
     sgui_numeric_edit* super = (sgui_numeric_edit*)this;
     sgui_skin* skin;
 
@@ -303,7 +306,7 @@ sgui_widget* sgui_spin_box_create( int x, int y, unsigned int width,
     {
         if( !numeric_edit_init( super, x, y, width, min, max, current ) )
         {
-            free( this );
+            sgui_internal_free( this, SGUI_ALLOC_OBJECT );
             return NULL;
         }
 
@@ -347,7 +350,7 @@ void sgui_numeric_edit_set_value( sgui_widget* box, int value )
     if( ((sgui_widget*)this)->canvas )
     {
         sgui_widget_get_absolute_rect( (sgui_widget*)this, &r );
-        sgui_canvas_add_dirty_rect( ((sgui_widget*)this)->canvas, &r );
+        sgui_widget_add_dirty_rect( (sgui_widget*)this, &r );
     }
 }
 
@@ -149,9 +149,9 @@ static void sync_cursors( sgui_edit_box* super )
 
 static void pass_box_destroy( sgui_widget* this )
 {
-    free( ((sgui_pass_box*)this)->shadow );
-    free( ((sgui_edit_box*)this)->buffer );
-    free( this );
+    sgui_internal_free( ((sgui_pass_box*)this)->shadow, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( ((sgui_edit_box*)this)->buffer, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -159,7 +159,8 @@ static void pass_box_destroy( sgui_widget* this )
 sgui_widget* sgui_pass_box_create( int x, int y, unsigned int width,
                                    unsigned int max_chars )
 {
-    sgui_pass_box* this = calloc( 1, sizeof(sgui_pass_box) );
+    sgui_pass_box* this = sgui_internal_calloc( 1, sizeof(sgui_pass_box),
+                                                SGUI_MEM(WIDGETS,OBJECT) );
     sgui_edit_box* super = (sgui_edit_box*)this;
 
     if( !this )
@@ -168,18 +169,19 @@ sgui_widget* sgui_pass_box_create( int x, int y, unsigned int width,
     /* allocate storage for the text buffer */
     if( !sgui_edit_box_init( super, x, y, width, max_chars ) )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
     /* allocate shadow buffer for password edit box */
     this->shadow = super->buffer;
-    super->buffer = malloc( max_chars + 1 );
+    super->buffer = sgui_internal_malloc( max_chars + 1,
+                                          SGUI_MEM(WIDGETS,BUFFER) );
 
     if( !super->buffer )
     {
-        free( this->shadow );
-        free( this );
+        sgui_internal_free( this->shadow, SGUI_ALLOC_BUFFER );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -81,7 +81,8 @@ sgui_widget* sgui_progress_bar_create( int x, int y, int style, int vertical,
         progress = 100;
 
     /* allocate widget structure */
-    this = calloc( 1, sizeof(sgui_progress_bar) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_progress_bar),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
     if( !this )
@@ -114,7 +115,7 @@ void sgui_progress_bar_set_progress(sgui_widget* this, unsigned int progress)
     if( this->canvas )
     {
         sgui_widget_get_absolute_rect( this, &r );
-        sgui_canvas_add_dirty_rect( this->canvas, &r );
+        sgui_widget_add_dirty_rect( this, &r );
     }
 
     ((sgui_progress_bar*)this)->progress = progress>100 ? 100 : progress;
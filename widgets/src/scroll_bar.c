@@ -24,6 +24,7 @@
  */
 #define SGUI_BUILDING_DLL
 #include "sgui_scroll_bar.h"
+#include "sgui_canvas.h"
 #include "sgui_skin.h"
 #include "sgui_event.h"
 #include "sgui_internal.h"
@@ -96,30 +97,35 @@ static void scroll_bar_on_event_h( sgui_widget* super, const sgui_event* e )
                                   this->v_offset-old );
 
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
     }
     else if( e->type==SGUI_MOUSE_RELEASE_EVENT ||
              e->type==SGUI_MOUSE_LEAVE_EVENT )
     {
+        if( super->canvas->capture==super )
+            sgui_canvas_capture_pointer( super->canvas, NULL );
+
         /* buttons return to out state, need redraw */
         if( this->dec_button_state || this->inc_button_state )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
 
         this->dec_button_state = this->inc_button_state = 0;
     }
     else if( e->type==SGUI_MOUSE_PRESS_EVENT )
     {
+        sgui_canvas_capture_pointer( super->canvas, super );
+
         /* update button state, request redraw */
         this->dec_button_state = e->arg.i3.x < (int)this->bw;
         this->inc_button_state = e->arg.i3.x >
                                  ((int)this->length-(int)this->bw);
 
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
 
         /* modify offset accordingly if a button was pressed */
         old = this->v_offset;
@@ -211,30 +217,35 @@ static void scroll_bar_on_event_v( sgui_widget* super, const sgui_event* e )
                                   this->v_offset-old );
 
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
     }
     else if( e->type==SGUI_MOUSE_RELEASE_EVENT ||
              e->type==SGUI_MOUSE_LEAVE_EVENT )
     {
+        if( super->canvas->capture==super )
+            sgui_canvas_capture_pointer( super->canvas, NULL );
+
         /* buttons return to out state, need redraw */
         if( this->dec_button_state || this->inc_button_state )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
 
         this->dec_button_state = this->inc_button_state = 0;
     }
     else if( e->type==SGUI_MOUSE_PRESS_EVENT )
     {
+        sgui_canvas_capture_pointer( super->canvas, super );
+
         /* update button state, request redraw */
         this->dec_button_state = e->arg.i3.y < (int)this->bh;
         this->inc_button_state = e->arg.i3.y >
                                  ((int)this->length-(int)this->bh);
 
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
 
         /* modify offset accordingly if a button was pressed */
         old = this->v_offset;
@@ -297,7 +308,8 @@ sgui_widget* sgui_scroll_bar_create( int x, int y, int horizontal,
                                      unsigned int scroll_area_length,
                                      unsigned int disp_area_length )
 {
-    sgui_scroll_bar* this = calloc( 1, sizeof(sgui_scroll_bar) );
+    sgui_scroll_bar* this = sgui_internal_calloc( 1, sizeof(sgui_scroll_bar),
+                                                  SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
     sgui_skin* skin = sgui_skin_get( );
     unsigned int w=0, h=0;
@@ -375,7 +387,7 @@ void sgui_scroll_bar_set_offset( sgui_widget* super, unsigned int offset )
     if( super->canvas )
     {
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
     }
     sgui_internal_unlock_mutex( );
 }
@@ -405,7 +417,7 @@ void sgui_scroll_bar_set_area( sgui_widget* super,
     if( super->canvas )
     {
         sgui_widget_get_absolute_rect( super, &r );
-        sgui_canvas_add_dirty_rect( super->canvas, &r );
+        sgui_widget_add_dirty_rect( super, &r );
     }
     sgui_internal_unlock_mutex( );
 }
@@ -423,7 +435,7 @@ void sgui_scroll_bar_set_length( sgui_widget* super, unsigned int length )
         if( this->length < length && super->canvas )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
 
         /* update length and pane dimension */
@@ -440,11 +452,13 @@ void sgui_scroll_bar_set_length( sgui_widget* super, unsigned int length )
         else
             super->area.bottom = super->area.top + length;
 
+        sgui_internal_widget_update_index( super );
+
         /* if the bar is enlarged, add new area as dirty rect */
         if( this->length > length && super->canvas )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( super->canvas, &r );
+            sgui_widget_add_dirty_rect( super, &r );
         }
 
         sgui_internal_unlock_mutex( );
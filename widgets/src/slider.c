@@ -129,7 +129,10 @@ static void slider_on_event( sgui_widget* super, const sgui_event* e )
         sgui_rect_add_offset( &r, -super->area.left, -super->area.top );
 
         if( sgui_rect_is_point_inside( &r, e->arg.i3.x, e->arg.i3.y ) )
+        {
             this->dragging = 1;
+            sgui_canvas_capture_pointer( super->canvas, super );
+        }
         else
             new_val = value_from_position( super, e->arg.i3.x, e->arg.i3.y );
         break;
@@ -139,6 +142,9 @@ static void slider_on_event( sgui_widget* super, const sgui_event* e )
         break;
     case SGUI_MOUSE_RELEASE_EVENT:
     case SGUI_MOUSE_LEAVE_EVENT:
+        if( this->dragging && super->canvas->capture==super )
+            sgui_canvas_capture_pointer( super->canvas, NULL );
+
         this->dragging = 0;
         break;
     case SGUI_MOUSE_WHEEL_EVENT:
@@ -194,7 +200,8 @@ sgui_widget* sgui_slider_create( int x, int y, unsigned int length,
         return NULL;
 
     /* create object */
-    this = calloc( 1, sizeof(sgui_slider) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_slider),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
     if( !this )
@@ -258,7 +265,7 @@ void sgui_slider_set_value( sgui_widget* super, int value )
         if( this->super.canvas )
         {
             sgui_widget_get_absolute_rect( super, &r );
-            sgui_canvas_add_dirty_rect( this->super.canvas, &r );
+            sgui_widget_add_dirty_rect( &this->super, &r );
         }
     }
 
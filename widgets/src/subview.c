@@ -117,7 +117,7 @@ static void subview_on_state_change( sgui_widget* super, int change )
 static void subview_destroy( sgui_widget* this )
 {
     sgui_window_destroy( ((sgui_subview*)this)->subwnd );
-    free( this );
+    sgui_internal_free( this, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -132,7 +132,8 @@ sgui_widget* sgui_subview_create( sgui_window* parent, int x, int y,
     sgui_widget* super;
 
     /* allocate storage for the view */
-    this = calloc( 1, sizeof(sgui_subview) );
+    this = sgui_internal_calloc( 1, sizeof(sgui_subview),
+                                 SGUI_MEM(WIDGETS,OBJECT) );
     super = (sgui_widget*)this;
 
     if( !this )
@@ -144,7 +145,8 @@ sgui_widget* sgui_subview_create( sgui_window* parent, int x, int y,
     super->state_change_event = subview_on_state_change;
     super->destroy            = subview_destroy;
     super->flags              = SGUI_FOCUS_ACCEPT|SGUI_FOCUS_DROP_ESC|
-                                SGUI_FOCUS_DROP_TAB|SGUI_WIDGET_VISIBLE;
+                                SGUI_FOCUS_DROP_TAB|SGUI_WIDGET_VISIBLE|
+                                SGUI_WIDGET_TRACK_POSITION;
     this->window_fun          = NULL;
     this->draw_fun            = NULL;
 
@@ -167,7 +169,7 @@ sgui_widget* sgui_subview_create( sgui_window* parent, int x, int y,
 
     if( !this->subwnd )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 
@@ -65,6 +65,7 @@ static void tab_on_state_change( sgui_widget* super, int change )
     sgui_tab* this = (sgui_tab*)super;
     sgui_widget* w;
     sgui_event ev;
+    unsigned int i;
 
     if( change & SGUI_WIDGET_VISIBILLITY_CHANGED )
     {
@@ -74,8 +75,10 @@ static void tab_on_state_change( sgui_widget* super, int change )
             {
                 g->current = this;
 
-                for( w=super->parent->children; w!=NULL; w=w->next )
+                for( i=0; i<super->parent->num_children; ++i )
                 {
+                    w = super->parent->children[i];
+
                     if( w!=super && (w->flags & SGUI_WIDGET_VISIBLE) )
                         sgui_widget_set_visible( w, 0 );
                 }
@@ -97,12 +100,11 @@ static void tab_on_draw( sgui_widget* super )
 {
     sgui_tab* this = ((sgui_tab*)super);
     sgui_skin* skin = sgui_skin_get( );
-    unsigned int gap = 0;
-    sgui_widget* i;
+    unsigned int i, gap = 0;
 
     sgui_internal_lock_mutex( );
-    for( i=super->parent->children; i!=super; i=i->next )
-        gap += ((sgui_tab*)i)->caption_width;
+    for( i=0; i<super->index; ++i )
+        gap += ((sgui_tab*)super->parent->children[i])->caption_width;
 
     skin->draw_tab(skin,super->canvas,&super->area,gap,this->caption_width);
     sgui_internal_unlock_mutex( );
@@ -110,8 +112,8 @@ static void tab_on_draw( sgui_widget* super )
 
 static void tab_destroy( sgui_widget* super )
 {
-    free( ((sgui_tab*)super)->caption );
-    free( super );
+    sgui_internal_free( ((sgui_tab*)super)->caption, SGUI_ALLOC_BUFFER );
+    sgui_internal_free( super, SGUI_ALLOC_OBJECT );
 }
 
 /****************************************************************************/
@@ -119,64 +121,71 @@ static void tab_destroy( sgui_widget* super )
 static void tab_group_on_state_change( sgui_widget* super, int change )
 {
     sgui_tab_group* this = (sgui_tab_group*)super;
-    sgui_widget* i;
+    unsigned int i;
 
-    if( change==SGUI_WIDGET_CHILD_ADDED && !super->children->next )
+    if( (change & SGUI_WIDGET_CHILD_ADDED) && !this->current &&
+        super->num_children )
     {
-        ((sgui_tab_group*)super)->current = (sgui_tab*)super->children;
-        sgui_widget_set_visible( super->children, 1 );
+        ((sgui_tab_group*)super)->current = (sgui_tab*)super->children[0];
+        sgui_widget_set_visible( super->children[0], 1 );
     }
-    else if( change==SGUI_WIDGET_CHILD_REMOVED )
+    else if( change & SGUI_WIDGET_CHILD_REMOVED )
     {
-        for( i=super->children; i!=NULL; i=i->next )
+        for( i=0; i<super->num_children; ++i )
         {
-            if( i==(sgui_widget*)this->current )
+            if( super->children[i]==(sgui_widget*)this->current )
                 return;
         }
 
-        this->current = (sgui_tab*)super->children;
-        sgui_widget_set_visible( super->children, 1 );
+        this->current = NULL;
+
+        if( super->num_children )
+        {
+            this->current = (sgui_tab*)super->children[0];
+            sgui_widget_set_visible( super->children[0], 1 );
+        }
     }
 }
 
 static void tab_group_on_event( sgui_widget* super, const sgui_event* e )
 {
     sgui_tab_group* this = (sgui_tab_group*)super;
-    sgui_widget* i;
+    unsigned int i;
+    sgui_tab* t;
     int x;
 
     if( e->type == SGUI_MOUSE_PRESS_EVENT )
     {
         sgui_internal_lock_mutex( );
 
-        for( x=e->arg.i3.x, i=super->children; i; i=i->next )
+        for( x=e->arg.i3.x, i=0; i<super->num_children; ++i )
         {
-            if( x<(int)(((sgui_tab*)i)->caption_width) )
+            t = (sgui_tab*)super->children[i];
+
+            if( x<(int)t->caption_width )
+            {
+                sgui_widget_set_visible( &t->super, 1 );
                 break;
-            x -= ((sgui_tab*)i)->caption_width;
+            }
+
+            x -= t->caption_width;
         }
 
-        sgui_widget_set_visible( i, 1 );
         sgui_internal_unlock_mutex( );
     }
     else if( e->type==SGUI_KEY_RELEASED_EVENT && this->current &&
              (e->arg.i==SGUI_KC_LEFT || e->arg.i==SGUI_KC_RIGHT) )
     {
         sgui_internal_lock_mutex( );
-        if( e->arg.i==SGUI_KC_LEFT )
+        i = this->current->super.index;
+
+        if( e->arg.i==SGUI_KC_LEFT && i>0 )
         {
-            for( i=super->children; i; i=i->next )
-            {
-                if( i->next==(sgui_widget*)this->current )
-                {
-                    sgui_widget_set_visible( i, 1 );
-                    break;
-                }
-            }
+            sgui_widget_set_visible( super->children[i-1], 1 );
         }
-        else if( this->current->super.next )
+        else if( e->arg.i==SGUI_KC_RIGHT && (i+1)<super->num_children )
         {
-            sgui_widget_set_visible( this->current->super.next, 1 );
+            sgui_widget_set_visible( super->children[i+1], 1 );
         }
         sgui_internal_unlock_mutex( );
     }
@@ -186,16 +195,17 @@ static void tab_group_draw( sgui_widget* super )
 {
     int x = super->area.left, y = super->area.top;
     sgui_skin* skin = sgui_skin_get( );
-    sgui_widget* i;
+    unsigned int i;
+    sgui_tab* t;
 
     sgui_internal_lock_mutex( );
 
-    for( i=super->children; i!=NULL; i=i->next )
+    for( i=0; i<super->num_children; ++i )
     {
+        t = (sgui_tab*)super->children[i];
         skin->draw_tab_caption( skin, super->canvas, x, y,
-                                ((sgui_tab*)i)->caption,
-                                ((sgui_tab*)i)->caption_width );
-        x += ((sgui_tab*)i)->caption_width;
+                                t->caption, t->caption_width );
+        x += t->caption_width;
     }
 
     sgui_internal_unlock_mutex( );
@@ -206,7 +216,8 @@ static void tab_group_draw( sgui_widget* super )
 sgui_widget* sgui_tab_group_create( int x, int y,
                                     unsigned int width, unsigned int height )
 {
-    sgui_tab_group* this = calloc( 1, sizeof(sgui_tab_group) );
+    sgui_tab_group* this = sgui_internal_calloc( 1, sizeof(sgui_tab_group),
+                                                 SGUI_MEM(WIDGETS,OBJECT) );
     sgui_skin* skin = sgui_skin_get( );
     sgui_rect r;
 
@@ -228,16 +239,19 @@ sgui_widget* sgui_tab_group_create( int x, int y,
 
 sgui_widget* sgui_tab_create( sgui_widget* parent, const char* caption )
 {
-    sgui_tab* this = calloc( 1, sizeof(sgui_tab) );
+    sgui_tab* this = sgui_internal_calloc( 1, sizeof(sgui_tab),
+                                           SGUI_MEM(WIDGETS,OBJECT) );
     sgui_widget* super = (sgui_widget*)this;
     sgui_tab_group* g = (sgui_tab_group*)parent;
 
     if( !this )
         return NULL;
 
-    if( !(this->caption = sgui_strdup( caption )) )
+    this->caption = sgui_internal_strdup( caption, SGUI_MEMORY_WIDGETS );
+
+    if( !this->caption )
     {
-        free( this );
+        sgui_internal_free( this, SGUI_ALLOC_OBJECT );
         return NULL;
     }
 